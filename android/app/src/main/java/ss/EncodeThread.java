@@ -8,6 +8,7 @@ import android.media.MediaCodec;
 import android.media.MediaCodecInfo;
 import android.media.MediaFormat;
 import android.media.projection.MediaProjection;
+import android.os.Bundle;
 import android.os.Handler;
 import android.os.Looper;
 import android.os.Message;
@@ -67,6 +68,12 @@ public class EncodeThread {
         mHandler.sendMessage(msg);
     }
 
+    public void notifyRequestKeyFrame() {
+        Message msg = Message.obtain();
+        msg.what = MSG_REQUEST_KEY_FRAME;
+        mHandler.sendMessage(msg);
+    }
+
     public void notifyClose() {
         Message msg = Message.obtain();
         msg.what = MSG_CLOSE;
@@ -121,6 +128,11 @@ public class EncodeThread {
                     Frame frame = (Frame) msg.obj;
                     mEncoder.releaseOutputBuffer(frame.index, false);
                     mFreeFrames.add(frame);
+                } else if (msg.what == MSG_REQUEST_KEY_FRAME) {
+                    Bundle params = new Bundle();
+                    params.putInt(MediaCodec.PARAMETER_KEY_REQUEST_SYNC_FRAME, 0);
+                    mEncoder.setParameters(params);
+                    MainThread.Singleton().notifyLog('I', "request key frame");
                 } else if (msg.what == MSG_CLOSE) {
                     Objects.requireNonNull(Looper.myLooper()).quit();
                 }
@@ -204,6 +216,7 @@ public class EncodeThread {
     private static final int MSG_START_ENCODE = 0;
     private static final int MSG_RECYCLE_FRAME = 1;
     private static final int MSG_CLOSE = 2;
+    private static final int MSG_REQUEST_KEY_FRAME = 3;
 
     /** unit test simulate options. */
     private static final boolean UTSO_FAIL_CODEC_CREATE = MainThread.ENABLE_UTSO && false;
@@ -262,8 +262,9 @@ public class NetThread {
     private void onClientRead() throws TagExit {
         SocketChannel c = (SocketChannel) mClientKey.channel();
         mClientReadBuffer.position(0);
+        int n;
         try {
-            c.read(mClientReadBuffer);
+            n = c.read(mClientReadBuffer);
         } catch (IOException e) {
             throw new TagExit("net client read fail: " + e.getMessage());
         }
@@ -271,6 +272,11 @@ public class NetThread {
         if (UTSO_FAIL_READ) {
             throw new TagExit("unit test simulate: net client read");
         }
+
+        // 'a': keep alive, 'k': client need key frame(e.g. window visible again).
+        if (n == 1 && mClientReadBuffer.get(0) == 'k') {
+            EncodeThread.Singleton().notifyRequestKeyFrame();
+        }
     }
 
     private void onClientWrite() throws TagExit {
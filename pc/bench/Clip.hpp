@@ -0,0 +1,55 @@
+#pragma once
+#include <ss/Common.hpp>
+
+#include <cstdio>
+#include <vector>
+
+/** split h264(annex b) file to access units by parser, caller free packets. */
+inline std::vector<AVPacket*> LoadH264Packets(const char* path) {
+    std::vector<AVPacket*> packets;
+    FILE* f = ::fopen(path, "rb");
+    SS_THROW(f, "open file fail: %s", path);
+    std::vector<uint8_t> data;
+    uint8_t buf[64 * 1024];
+    for (size_t n = 0; (n = ::fread(buf, 1, sizeof(buf), f)) > 0;) {
+        data.insert(data.end(), buf, buf + n);
+    }
+    ::fclose(f);
+
+    const AVCodec* codec = avcodec_find_decoder(AV_CODEC_ID_H264);
+    SS_THROW(codec, "find h264 decoder fail");
+    AVCodecParserContext* parser = av_parser_init(AV_CODEC_ID_H264);
+    SS_THROW(parser, "'av_parser_init' fail");
+    AVCodecContext* ctx = avcodec_alloc_context3(codec);
+    SS_THROW(ctx, "'avcodec_alloc_context3' fail");
+
+    const uint8_t* p = data.data();
+    int remain = (int)data.size();
+    // null input flush last packet.
+    while (true) {
+        uint8_t* out = nullptr;
+        int outSize = 0;
+        int used = av_parser_parse2(
+            parser, ctx, &out, &outSize, p, remain, AV_NOPTS_VALUE, AV_NOPTS_VALUE, 0);
+        ss::check_libav(used, "av_parser_parse2");
+        p += used;
+        remain -= used;
+        if (outSize > 0) {
+            AVPacket* packet = av_packet_alloc();
+            SS_THROW(packet, "av_packet_alloc fail");
+            ss::check_libav(av_new_packet(packet, outSize), "av_new_packet");
+            ::memcpy(packet->data, out, outSize);
+            packets.push_back(packet);
+        }
+        if (!p) {
+            break;
+        }
+        if (remain == 0) {
+            p = nullptr;
+        }
+    }
+
+    avcodec_free_context(&ctx);
+    av_parser_close(parser);
+    return packets;
+}
@@ -0,0 +1,123 @@
+#include <ss/Common.hpp>
+#include <ss/SessionScheduler.hpp>
+
+#include "Clip.hpp"
+
+#include <cstdio>
+#include <vector>
+
+/**
+ * decode scaling benchmark, replay one h264(annex b) file as 1..16 streams through
+ * SessionScheduler, same slice as DecodeThread. usage: ss_decode_bench [file] [threads(0: auto)].
+ */
+namespace {
+struct Stream {
+    AVCodecContext* codecCtx = nullptr;
+    AVFrame* frame = nullptr;
+    std::mutex lock;
+    /** next packet index, guard by lock. */
+    size_t next = 0;
+    size_t decoded = 0;
+};
+
+void Run(const std::vector<AVPacket*>& packets, int streamCount, int threads) {
+    using clock = std::chrono::high_resolution_clock;
+
+    const AVCodec* codec = avcodec_find_decoder(AV_CODEC_ID_H264);
+    std::optional<Stream> streams[ss::MAX_SESSION];
+    for (int i = 0; i < streamCount; ++i) {
+        Stream& s = streams[i].emplace();
+        s.codecCtx = avcodec_alloc_context3(codec);
+        SS_THROW(s.codecCtx, "'avcodec_alloc_context3' fail");
+        ss::check_libav(avcodec_open2(s.codecCtx, codec, NULL), "avcodec_open2");
+        s.frame = av_frame_alloc();
+        SS_THROW(s.frame, "'av_frame_alloc' fail");
+    }
+
+    int workers = threads > 0 ? threads : (int)std::thread::hardware_concurrency();
+    workers = std::clamp(workers, 1, streamCount);
+    std::atomic<int> doneStreams = 0;
+    clock::time_point beginTp = clock::now();
+    {
+        ss::SessionScheduler scheduler(streamCount, workers, [&](int session, int worker) {
+            (void)worker;
+            Stream& s = *streams[session];
+            // same slice size as DecodeThread.
+            for (int i = 0; i < 4; ++i) {
+                size_t index = 0;
+                {
+                    std::lock_guard<std::mutex> lock(s.lock);
+                    if (s.next == packets.size()) {
+                        return false;
+                    }
+                    index = s.next++;
+                }
+                if (avcodec_send_packet(s.codecCtx, packets[index]) == 0) {
+                    while (avcodec_receive_frame(s.codecCtx, s.frame) == 0) {
+                        ++s.decoded;
+                    }
+                }
+                if (index + 1 == packets.size()) {
+                    ++doneStreams;
+                    return false;
+                }
+            }
+            return true;
+        });
+        for (int i = 0; i < streamCount; ++i) {
+            scheduler.notifyRunnable(i);
+        }
+        while (doneStreams < streamCount) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        scheduler.stop();
+        scheduler.join();
+
+        double seconds = std::chrono::duration<double>(clock::now() - beginTp).count();
+        size_t decoded = 0;
+        for (int i = 0; i < streamCount; ++i) {
+            decoded += streams[i]->decoded;
+        }
+        uint64_t steals = 0;
+        for (int i = 0; i < workers; ++i) {
+            steals += scheduler.workerStats(i).steals;
+        }
+        ss::Log::I(
+            "streams: %2d, threads: %2d, total: %8.1f fps, per stream: %7.1f fps, steals: %llu",
+            streamCount,
+            workers,
+            decoded / seconds,
+            decoded / seconds / streamCount,
+            (unsigned long long)steals);
+    }
+
+    for (int i = 0; i < streamCount; ++i) {
+        avcodec_free_context(&streams[i]->codecCtx);
+        av_frame_free(&streams[i]->frame);
+    }
+}
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    auto log = std::make_unique<ss::Log>();
+    if (argc < 2) {
+        ss::Log::I_STR("usage: ss_decode_bench [h264 file] [threads(0: auto)]");
+        return 0;
+    }
+
+    try {
+        int threads = argc > 2 ? ::atoi(argv[2]) : 0;
+        std::vector<AVPacket*> packets = LoadH264Packets(argv[1]);
+        SS_THROW(!packets.empty(), "no packet in file: %s", argv[1]);
+        ss::Log::I("packets: %d", (int)packets.size());
+        for (int n : {1, 2, 4, 8, 16}) {
+            Run(packets, n, threads);
+        }
+        for (AVPacket* i : packets) {
+            av_packet_free(&i);
+        }
+    } catch (const ss::Error& e) {
+        ss::Log::PrintError(e);
+    }
+    return 0;
+}
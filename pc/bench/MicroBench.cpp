@@ -0,0 +1,556 @@
+#include <ss/Common.hpp>
+#include <ss/BlockingQueue.hpp>
+#include <ss/DirtyTiles.hpp>
+#include <ss/HugePageAlloc.hpp>
+#include <ss/YuvToBgra.hpp>
+#include <xm/StringStream.hpp>
+
+#include "Clip.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <thread>
+#include <vector>
+
+#if defined(XM_OS_LINUX)
+    #include <linux/perf_event.h>
+    #include <sys/ioctl.h>
+    #include <sys/syscall.h>
+#endif
+
+/**
+ * micro benchmarks of hot paths, google benchmark flags apply. results also written as json to
+ * ss_bench.json unless `--benchmark_out` given, compare versions by benchmark's compare.py.
+ * decode benchmark use h264(annex b) clip of env SS_BENCH_CLIP, skipped if not set.
+ */
+namespace {
+struct Item {
+    int64_t pts;
+    uint32_t size;
+    uint32_t flags;
+};
+
+/** 1080p yuv420 planes of noise, deterministic. */
+struct Yuv1080 {
+    static constexpr int W = 1920;
+    static constexpr int H = 1080;
+
+    Yuv1080() : y((size_t)W * H), u((size_t)W / 2 * H / 2), v((size_t)W / 2 * H / 2) {
+        uint32_t seed = 1314;
+        for (std::vector<uint8_t>* plane : {&y, &u, &v}) {
+            for (uint8_t& i : *plane) {
+                seed = seed * 1103515245u + 12345u;
+                i = (uint8_t)(seed >> 16);
+            }
+        }
+    }
+
+    std::vector<uint8_t> y;
+    std::vector<uint8_t> u;
+    std::vector<uint8_t> v;
+};
+
+// ---- BlockingQueue
+
+/** one item round trip between two threads, same handoff as net -> decode -> pts. */
+void BM_BlockingQueue_PingPong(benchmark::State& state) {
+    ss::BlockingQueue<int> request;
+    ss::BlockingQueue<int> response;
+    std::thread peer([&]() {
+        while (true) {
+            int v = *request.pop_front(chrono::milliseconds(-1));
+            response.push_back(v);
+            if (v < 0) {
+                break;
+            }
+        }
+    });
+    for (auto _ : state) {
+        request.push_back(1);
+        benchmark::DoNotOptimize(response.pop_front(chrono::milliseconds(-1)));
+    }
+    request.push_back(-1);
+    response.pop_front(chrono::milliseconds(-1));
+    peer.join();
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_BlockingQueue_PingPong)->UseRealTime();
+
+/** producer push batch, consumer pop all. */
+void BM_BlockingQueue_Stream(benchmark::State& state) {
+    const int batch = (int)state.range(0);
+    ss::BlockingQueue<int> queue;
+    ss::BlockingQueue<int> done;
+    std::thread consumer([&]() {
+        while (true) {
+            int v = *queue.pop_front(chrono::milliseconds(-1));
+            if (v < 0) {
+                break;
+            }
+            if (v == batch - 1) {
+                done.push_back(v);
+            }
+        }
+    });
+    for (auto _ : state) {
+        for (int i = 0; i < batch; ++i) {
+            queue.push_back(i);
+        }
+        done.pop_front(chrono::milliseconds(-1));
+    }
+    queue.push_back(-1);
+    consumer.join();
+    state.SetItemsProcessed(state.iterations() * batch);
+}
+BENCHMARK(BM_BlockingQueue_Stream)->Arg(64)->Arg(1024)->UseRealTime();
+
+// ---- xm::Array vs std::vector
+
+template <typename C>
+void BM_PushBack(benchmark::State& state) {
+    const int n = (int)state.range(0);
+    for (auto _ : state) {
+        C c;
+        for (int i = 0; i < n; ++i) {
+            c.push_back(i);
+        }
+        benchmark::DoNotOptimize(c.data());
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK_TEMPLATE(BM_PushBack, xm::Array<int>)->Arg(16)->Arg(1024);
+BENCHMARK_TEMPLATE(BM_PushBack, xm::Array<int, 16>)->Arg(16)->Arg(1024);
+BENCHMARK_TEMPLATE(BM_PushBack, std::vector<int>)->Arg(16)->Arg(1024);
+
+template <typename C>
+void BM_EmplaceBack(benchmark::State& state) {
+    const int n = (int)state.range(0);
+    for (auto _ : state) {
+        C c;
+        for (int i = 0; i < n; ++i) {
+            c.emplace_back(Item {i, (uint32_t)i, 0});
+        }
+        benchmark::DoNotOptimize(c.data());
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK_TEMPLATE(BM_EmplaceBack, xm::Array<Item>)->Arg(16)->Arg(1024);
+BENCHMARK_TEMPLATE(BM_EmplaceBack, std::vector<Item>)->Arg(16)->Arg(1024);
+
+/** insert at front, worst case move. */
+template <typename C>
+void BM_InsertFront(benchmark::State& state) {
+    const int n = (int)state.range(0);
+    for (auto _ : state) {
+        C c;
+        for (int i = 0; i < n; ++i) {
+            c.insert(c.begin(), i);
+        }
+        benchmark::DoNotOptimize(c.data());
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK_TEMPLATE(BM_InsertFront, xm::Array<int>)->Arg(16)->Arg(256);
+BENCHMARK_TEMPLATE(BM_InsertFront, std::vector<int>)->Arg(16)->Arg(256);
+
+// ---- StringStream vs snprintf
+
+void BM_StringStream_AppendFormat(benchmark::State& state) {
+    xm::StringStream ss;
+    for (auto _ : state) {
+        ss.clear();
+        ss.appendFormat("session %d, fps: %u, latency: %.2fms, %s", 3, 60u, 12.34, "nv12");
+        benchmark::DoNotOptimize(ss.data());
+    }
+}
+BENCHMARK(BM_StringStream_AppendFormat);
+
+void BM_Snprintf(benchmark::State& state) {
+    char buf[120];
+    for (auto _ : state) {
+        snprintf(
+            buf, sizeof(buf), "session %d, fps: %u, latency: %.2fms, %s", 3, 60u, 12.34, "nv12");
+        benchmark::DoNotOptimize(buf);
+    }
+}
+BENCHMARK(BM_Snprintf);
+
+// ---- net-frame header
+
+/** 12 bytes header: body size(uint32) and pts(int64), big endian. */
+void BM_GetJavaData_Header(benchmark::State& state) {
+    constexpr int COUNT = 1024;
+    std::vector<char> headers((size_t)COUNT * 12);
+    for (size_t i = 0; i < headers.size(); ++i) {
+        headers[i] = (char)(i * 7);
+    }
+    for (auto _ : state) {
+        uint64_t sum = 0;
+        for (int i = 0; i < COUNT; ++i) {
+            const char* h = headers.data() + (size_t)i * 12;
+            sum += ss::GetJavaData<uint32_t>(h);
+            sum += (uint64_t)ss::GetJavaData<int64_t>(h + 4);
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * COUNT);
+}
+BENCHMARK(BM_GetJavaData_Header);
+
+// ---- yuv upload path(cpu side)
+
+/** dirty tile hash of 1080p y plane before gl upload, arg: 0 unchanged, 1 all changed. */
+void BM_DirtyTiles_Y1080(benchmark::State& state) {
+    Yuv1080 a;
+    Yuv1080 b;
+    for (uint8_t& i : b.y) {
+        i ^= 0xff;
+    }
+    ss::DirtyTiles tiles;
+    bool changing = state.range(0) != 0;
+    bool flip = false;
+    for (auto _ : state) {
+        const std::vector<uint8_t>& y = changing && flip ? b.y : a.y;
+        flip = !flip;
+        benchmark::DoNotOptimize(tiles.update(y.data(), Yuv1080::W, Yuv1080::W, Yuv1080::H, 1));
+    }
+    state.SetBytesProcessed(state.iterations() * (int64_t)a.y.size());
+}
+BENCHMARK(BM_DirtyTiles_Y1080)->Arg(0)->Arg(1);
+
+/** 1080p frame planes of GlRender's formats, plane `i` of frame `k` in `data[k][i]`. */
+struct UploadFrame {
+    struct Plane {
+        int w;
+        int h;
+        int bytesPerPixel;
+    };
+
+    /** plane kinds as GlRender's FORMATS, 10 bits in 16 bits samples. */
+    static constexpr const char* NAMES[] = {"yuv420p", "nv12", "p010", "yuv420p10"};
+    static constexpr int W = 1920;
+    static constexpr int H = 1080;
+
+    /** `change`: 0 frames equal, 1 all rows differ, 2 top half rows differ. */
+    UploadFrame(int format, int change) {
+        switch (format) {
+        case 0:
+            planes = {{W, H, 1}, {W / 2, H / 2, 1}, {W / 2, H / 2, 1}};
+            break;
+        case 1:
+            planes = {{W, H, 1}, {W / 2, H / 2, 2}};
+            break;
+        case 2:
+            planes = {{W, H, 2}, {W / 2, H / 2, 4}};
+            break;
+        default:
+            planes = {{W, H, 2}, {W / 2, H / 2, 2}, {W / 2, H / 2, 2}};
+            break;
+        }
+        uint32_t seed = 1314;
+        for (const Plane& p : planes) {
+            size_t linesize = (size_t)p.w * p.bytesPerPixel;
+            std::vector<uint8_t> a(linesize * p.h);
+            for (uint8_t& i : a) {
+                seed = seed * 1103515245u + 12345u;
+                i = (uint8_t)(seed >> 16);
+            }
+            std::vector<uint8_t> b = a;
+            int changedRows = change == 0 ? 0 : (change == 1 ? p.h : p.h / 2);
+            for (size_t i = 0; i < linesize * changedRows; ++i) {
+                b[i] ^= 0xff;
+            }
+            data[0].push_back(std::move(a));
+            data[1].push_back(std::move(b));
+        }
+    }
+
+    std::vector<Plane> planes;
+    std::vector<std::vector<uint8_t>> data[2];
+};
+
+/**
+ * cpu side of GlRender::uploadPlane for all planes of 1080p frame: tile hash, then merge dirty
+ * tiles of row to sub image rects. args: format(UploadFrame::NAMES), change(UploadFrame).
+ */
+void BM_UploadTiles_1080(benchmark::State& state) {
+    UploadFrame f((int)state.range(0), (int)state.range(1));
+    ss::DirtyTiles tiles[3];
+    int64_t frameBytes = 0;
+    for (size_t i = 0; i < f.planes.size(); ++i) {
+        const UploadFrame::Plane& p = f.planes[i];
+        frameBytes += (int64_t)p.w * p.h * p.bytesPerPixel;
+        // first frame of image set is all dirty, not the case measured.
+        tiles[i].update(f.data[1][i].data(), p.w * p.bytesPerPixel, p.w, p.h, p.bytesPerPixel);
+    }
+    uint64_t uploadBytes = 0;
+    uint64_t rects = 0;
+    int k = 0;
+    for (auto _ : state) {
+        for (size_t i = 0; i < f.planes.size(); ++i) {
+            const UploadFrame::Plane& p = f.planes[i];
+            const uint8_t* data = f.data[k][i].data();
+            int linesize = p.w * p.bytesPerPixel;
+            uint32_t dirtyCount = tiles[i].update(data, linesize, p.w, p.h, p.bytesPerPixel);
+            if (dirtyCount == 0) {
+                continue;
+            }
+            if (dirtyCount == tiles[i].count()) {
+                uploadBytes += (uint64_t)p.w * p.h * p.bytesPerPixel;
+                ++rects;
+                continue;
+            }
+            for (uint32_t r = 0; r < tiles[i].rows(); ++r) {
+                int y0 = (int)(r * ss::DirtyTiles::TILE_SIZE);
+                int y1 = std::min(p.h, y0 + (int)ss::DirtyTiles::TILE_SIZE);
+                for (uint32_t c = 0; c < tiles[i].cols();) {
+                    if (!tiles[i].dirty(c, r)) {
+                        ++c;
+                        continue;
+                    }
+                    uint32_t c1 = c + 1;
+                    while (c1 < tiles[i].cols() && tiles[i].dirty(c1, r)) {
+                        ++c1;
+                    }
+                    int x0 = (int)(c * ss::DirtyTiles::TILE_SIZE);
+                    int x1 = std::min(p.w, (int)(c1 * ss::DirtyTiles::TILE_SIZE));
+                    benchmark::DoNotOptimize(
+                        data + (size_t)y0 * linesize + (size_t)x0 * p.bytesPerPixel);
+                    uploadBytes += (uint64_t)(x1 - x0) * (y1 - y0) * p.bytesPerPixel;
+                    ++rects;
+                    c = c1;
+                }
+            }
+        }
+        k ^= 1;
+    }
+    state.SetBytesProcessed(state.iterations() * frameBytes);
+    state.counters["upload"] = benchmark::Counter(
+        (double)uploadBytes / (double)(state.iterations() * frameBytes));
+    state.counters["rects"] = benchmark::Counter((double)rects / (double)state.iterations());
+    state.SetLabel(UploadFrame::NAMES[state.range(0)]);
+}
+BENCHMARK(BM_UploadTiles_1080)
+    ->ArgsProduct({{0, 1, 2, 3}, {0, 1, 2}})
+    ->ArgNames({"format", "change"})
+    ->Unit(benchmark::kMicrosecond);
+
+/** software render convert of 1080p frame, best kernel of cpu. */
+void BM_YuvToBgra_1080(benchmark::State& state) {
+    Yuv1080 f;
+    std::vector<uint32_t> dst((size_t)Yuv1080::W * Yuv1080::H);
+    ss::YuvToBgra::Coeffs c = ss::YuvToBgra::MakeCoeffs(0.2126f, 0.0722f, false);
+    for (auto _ : state) {
+        for (int y = 0; y < Yuv1080::H; ++y) {
+            ss::YuvToBgra::ConvertRow(
+                c,
+                f.y.data() + (size_t)y * Yuv1080::W,
+                f.u.data() + (size_t)(y / 2) * (Yuv1080::W / 2),
+                f.v.data() + (size_t)(y / 2) * (Yuv1080::W / 2),
+                dst.data() + (size_t)y * Yuv1080::W,
+                Yuv1080::W);
+        }
+        benchmark::DoNotOptimize(dst.data());
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.SetLabel(ss::YuvToBgra::BestKernelName());
+}
+BENCHMARK(BM_YuvToBgra_1080)->Unit(benchmark::kMillisecond);
+
+// ---- huge pages
+
+/** dtlb load misses of calling thread, unavailable without pmu(vm) or by perf_event_paranoid. */
+class DtlbMisses {
+public:
+    DtlbMisses() {
+#if defined(XM_OS_LINUX)
+        perf_event_attr attr = {};
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HW_CACHE;
+        attr.config = PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                      (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        mFd = (int)::syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+#endif
+    }
+
+    ~DtlbMisses() {
+#if defined(XM_OS_LINUX)
+        if (mFd >= 0) {
+            ::close(mFd);
+        }
+#endif
+    }
+
+    bool available() const {
+        return mFd >= 0;
+    }
+
+    void start() {
+#if defined(XM_OS_LINUX)
+        ::ioctl(mFd, PERF_EVENT_IOC_RESET, 0);
+        ::ioctl(mFd, PERF_EVENT_IOC_ENABLE, 0);
+#endif
+    }
+
+    uint64_t stop() {
+        uint64_t count = 0;
+#if defined(XM_OS_LINUX)
+        ::ioctl(mFd, PERF_EVENT_IOC_DISABLE, 0);
+        if (::read(mFd, &count, sizeof(count)) != (ssize_t)sizeof(count)) {
+            count = 0;
+        }
+#endif
+        return count;
+    }
+
+private:
+    int mFd = -1;
+};
+
+/** 4k yuv420 frame, arg: 0 av_malloc(4KB pages), 1 HugePageAlloc(-huge-pages). */
+struct Frame4K {
+    static constexpr int W = 3840;
+    static constexpr int H = 2160;
+    static constexpr size_t SIZE = (size_t)W * H * 3 / 2;
+
+    explicit Frame4K(bool huge) {
+        buf = huge ? ss::HugePageAlloc::Alloc(ss::HugePageAlloc::PAINT, SIZE) : nullptr;
+        if (!buf) {
+            buf = av_buffer_allocz(SIZE);
+        }
+        for (size_t i = 0; i < SIZE; i += 61) {
+            buf->data[i] = (uint8_t)i;
+        }
+    }
+
+    ~Frame4K() {
+        av_buffer_unref(&buf);
+    }
+
+    AVBufferRef* buf = nullptr;
+};
+
+/** report dtlb misses per iteration, or label why not. */
+template <typename Fn>
+void RunCountingTlb(benchmark::State& state, Fn&& fn) {
+    DtlbMisses tlb;
+    if (tlb.available()) {
+        tlb.start();
+    }
+    for (auto _ : state) {
+        fn();
+    }
+    if (tlb.available()) {
+        state.counters["dtlb_misses"] =
+            benchmark::Counter((double)tlb.stop(), benchmark::Counter::kAvgIterations);
+    } else {
+        state.SetLabel("dtlb counter unavailable(perf_event_open)");
+    }
+}
+
+/** dirty tile hash walk 64 rows per tile, one 4KB page per row at 4k stride. */
+void BM_HugePages_DirtyTiles_Y4K(benchmark::State& state) {
+    ss::HugePageAlloc alloc;
+    Frame4K f(state.range(0) != 0);
+    ss::DirtyTiles tiles;
+    RunCountingTlb(state, [&]() {
+        benchmark::DoNotOptimize(tiles.update(f.buf->data, Frame4K::W, Frame4K::W, Frame4K::H, 1));
+    });
+    state.SetBytesProcessed(state.iterations() * (int64_t)Frame4K::W * Frame4K::H);
+}
+BENCHMARK(BM_HugePages_DirtyTiles_Y4K)->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
+
+/** whole frame copy, as upload staging and software render. */
+void BM_HugePages_Copy4K(benchmark::State& state) {
+    ss::HugePageAlloc alloc;
+    Frame4K src(state.range(0) != 0);
+    Frame4K dst(state.range(0) != 0);
+    RunCountingTlb(state, [&]() {
+        ::memcpy(dst.buf->data, src.buf->data, Frame4K::SIZE);
+        benchmark::ClobberMemory();
+    });
+    state.SetBytesProcessed(state.iterations() * (int64_t)Frame4K::SIZE);
+}
+BENCHMARK(BM_HugePages_Copy4K)->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
+
+// ---- decode
+
+/** decode whole clip per iteration on one context(same as DecodeThread), items: frames. */
+void BM_DecodeClip(benchmark::State& state) {
+    const char* path = ::getenv("SS_BENCH_CLIP");
+    if (!path || !*path) {
+        state.SkipWithError("env SS_BENCH_CLIP(h264 annex b file) not set");
+        return;
+    }
+    std::vector<AVPacket*> packets;
+    AVCodecContext* ctx = nullptr;
+    AVFrame* frame = av_frame_alloc();
+    try {
+        packets = LoadH264Packets(path);
+        const AVCodec* codec = avcodec_find_decoder(AV_CODEC_ID_H264);
+        SS_THROW(codec, "find h264 decoder fail");
+        ctx = avcodec_alloc_context3(codec);
+        SS_THROW(ctx, "'avcodec_alloc_context3' fail");
+        ss::check_libav(avcodec_open2(ctx, codec, NULL), "avcodec_open2");
+    } catch (const ss::Error& e) {
+        state.SkipWithError(e.what());
+    }
+
+    int64_t frames = 0;
+    for (auto _ : state) {
+        if (!ctx || !frame) {
+            break;
+        }
+        for (AVPacket* p : packets) {
+            if (avcodec_send_packet(ctx, p) == 0) {
+                while (avcodec_receive_frame(ctx, frame) == 0) {
+                    ++frames;
+                }
+            }
+        }
+        // drain delayed frames, then restart for next iteration.
+        avcodec_send_packet(ctx, nullptr);
+        while (avcodec_receive_frame(ctx, frame) == 0) {
+            ++frames;
+        }
+        avcodec_flush_buffers(ctx);
+    }
+    state.SetItemsProcessed(frames);
+    state.counters["packets"] = (double)packets.size();
+
+    avcodec_free_context(&ctx);
+    av_frame_free(&frame);
+    for (AVPacket* i : packets) {
+        av_packet_free(&i);
+    }
+}
+BENCHMARK(BM_DecodeClip)->Unit(benchmark::kMillisecond)->UseRealTime();
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    auto log = std::make_unique<ss::Log>();
+
+    // default json output for regression tracking between versions.
+    std::vector<char*> args(argv, argv + argc);
+    bool hasOut = false;
+    for (int i = 1; i < argc; ++i) {
+        hasOut = hasOut || ::strncmp(argv[i], "--benchmark_out=", 16) == 0;
+    }
+    char outArg[] = "--benchmark_out=ss_bench.json";
+    char formatArg[] = "--benchmark_out_format=json";
+    if (!hasOut) {
+        args.push_back(outArg);
+        args.push_back(formatArg);
+    }
+    int n = (int)args.size();
+    benchmark::Initialize(&n, args.data());
+    if (benchmark::ReportUnrecognizedArguments(n, args.data())) {
+        return 1;
+    }
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
@@ -0,0 +1,356 @@
+#include <ss/Bench.hpp>
+#include <ss/Trace.hpp>
+
+extern "C" {
+#include <libavcodec/bsf.h>
+#include <libavformat/avformat.h>
+}
+
+#if defined(XM_OS_LINUX)
+    #include <pthread.h>
+    #include <time.h>
+#endif
+
+namespace ss {
+namespace {
+/** no frame rate in container, same as common sender. */
+constexpr int DEFAULT_FPS = 60;
+
+#if defined(XM_OS_LINUX)
+double CpuMs(clockid_t clockId) {
+    timespec ts = {};
+    if (::clock_gettime(clockId, &ts) != 0) {
+        return -1.0;
+    }
+    return (double)ts.tv_sec * 1000.0 + (double)ts.tv_nsec / 1000000.0;
+}
+#endif
+}  // namespace
+
+Bench::Bench(const std::string& clipPath, bool paced) {
+    mStartTp = clock::now();
+    mPaced = paced;
+    loadClip(clipPath);
+
+    mLoop.emplace();
+    check_libuv(uv_tcp_init(&*mLoop, &mServer), "uv_tcp_init");
+    mServer.data = this;
+    sockaddr_in localAddr = {};
+    uv_ip4_addr("127.0.0.1", 0, &localAddr);
+    check_libuv(uv_tcp_bind(&mServer, (const sockaddr*)&localAddr, 0), "uv_tcp_bind");
+    check_libuv(
+        uv_listen(
+            (uv_stream_t*)&mServer,
+            1,
+            [](uv_stream_t* server, int status) { ((Bench*)server->data)->onConnection(status); }),
+        "uv_listen");
+
+    // port chosen by system, no conflict with running instance.
+    sockaddr_in boundAddr = {};
+    int addrLen = (int)sizeof(boundAddr);
+    check_libuv(
+        uv_tcp_getsockname(&mServer, (sockaddr*)&boundAddr, &addrLen), "uv_tcp_getsockname");
+    mPort = ntohs(boundAddr.sin_port);
+
+    check_libuv(
+        uv_async_init(
+            &*mLoop, &mAsyncStop, [](uv_async_t* handle) { uv_stop(handle->loop); }),
+        "uv_async_init");
+    check_libuv(uv_timer_init(&*mLoop, &mPaceTimer), "uv_timer_init");
+    mPaceTimer.data = this;
+
+    try {
+        mThread.emplace([this]() { run(); });
+    } catch (std::exception& e) {
+        SS_THROW(0, "create thread fail: %s", e.what());
+    }
+    Log::I(
+        "bench sender listen on: 127.0.0.1:%d, clip: %s, packets: %d, fps: %.2f, send: %s",
+        mPort,
+        clipPath.c_str(),
+        (int)mPackets.size(),
+        1000000.0 / (double)mFrameDurationUs,
+        mPaced ? "paced" : "saturated");
+}
+
+Bench::~Bench() {
+    if (mThread) {
+        uv_async_send(&mAsyncStop);
+        mThread->join();
+    }
+    // handles closed by loop.
+    mLoop.reset();
+    for (AVPacket*& i : mPackets) {
+        av_packet_free(&i);
+    }
+}
+
+void Bench::registerThread(const char* name) {
+#if defined(XM_OS_LINUX)
+    clockid_t clockId = {};
+    int r = ::pthread_getcpuclockid(::pthread_self(), &clockId);
+    if (r != 0) {
+        Log::W("'pthread_getcpuclockid' fail: %s, thread: %s", ::strerror(r), name);
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mThreadsLock);
+    mThreads.push_back(ThreadCpu {name, clockId});
+#else
+    std::lock_guard<std::mutex> lock(mThreadsLock);
+    mThreads.push_back(ThreadCpu {name});
+#endif
+}
+
+void Bench::report() {
+    using ms = chrono::duration<double, std::milli>;
+    clock::time_point nowTp = clock::now();
+    double wallMs = chrono::duration_cast<ms>(nowTp - mStartTp).count();
+    double presentMs = chrono::duration_cast<ms>(mLastPresentTp - mFirstPresentTp).count();
+    uint64_t sentFrames = mSentFrames.load(std::memory_order_relaxed);
+    uint64_t sentBytes = mSentBytes.load(std::memory_order_relaxed);
+
+    xm::StringStream ss;
+    ss.appendFormat(
+        "bench result:\n"
+        "- pipeline: %s, send: %s\n"
+        "- wall: %.0fms\n"
+        "- sent: %llu frames, %.2fmbps\n"
+        "- presented: %llu frames, throughput: %.2ffps\n",
+        Config::Singleton()->pipeline == PipelineMode::INLINE ? "inline" : "threaded",
+        mPaced ? "paced" : "saturated",
+        wallMs,
+        (unsigned long long)sentFrames,
+        wallMs > 0.0 ? (double)sentBytes * 8.0 / 1000.0 / wallMs : 0.0,
+        (unsigned long long)mPresentFrames,
+        // intervals between first and last present, startup excluded.
+        mPresentFrames > 1 && presentMs > 0.0 ? (mPresentFrames - 1) * 1000.0 / presentMs : 0.0);
+
+#if defined(XM_OS_LINUX)
+    // read before threads joined, clock id invalid after thread exit.
+    std::lock_guard<std::mutex> lock(mThreadsLock);
+    for (const ThreadCpu& i : mThreads) {
+        double cpuMs = CpuMs(i.clockId);
+        ss.appendFormat(
+            "- cpu %s: %.0fms(%.1f%%)\n", i.name, cpuMs, wallMs > 0.0 ? cpuMs * 100 / wallMs : 0.0);
+    }
+    double processMs = CpuMs(CLOCK_PROCESS_CPUTIME_ID);
+    ss.appendFormat(
+        "- cpu process: %.0fms(%.1f%%)", processMs, wallMs > 0.0 ? processMs * 100 / wallMs : 0.0);
+#else
+    ss.appendFormat("- cpu time per thread only support linux");
+#endif
+    Log::I(ss);
+}
+
+void Bench::loadClip(const std::string& path) {
+    AVFormatContext* formatCtx = nullptr;
+    AVBSFContext* bsfCtx = nullptr;
+    AVPacket* packet = av_packet_alloc();
+    try {
+        SS_THROW(packet, "'av_packet_alloc' fail");
+        check_libav(
+            avformat_open_input(&formatCtx, path.c_str(), nullptr, nullptr), "avformat_open_input");
+        SS_THROW(
+            avformat_find_stream_info(formatCtx, nullptr) >= 0,
+            "'avformat_find_stream_info' fail: %s",
+            path.c_str());
+        int streamIndex = av_find_best_stream(formatCtx, AVMEDIA_TYPE_VIDEO, -1, -1, nullptr, 0);
+        SS_THROW(streamIndex >= 0, "no video stream in clip: %s", path.c_str());
+        AVStream* stream = formatCtx->streams[streamIndex];
+        SS_THROW(
+            stream->codecpar->codec_id == AV_CODEC_ID_H264, "clip not h264: %s", path.c_str());
+        // decoder output one frame per packet, as sender(no b frames).
+        SS_THROW(
+            stream->codecpar->video_delay == 0,
+            "clip has b frames, re-encode without b frames(e.g. -bf 0): %s",
+            path.c_str());
+
+        AVRational fps = stream->avg_frame_rate;
+        mFrameDurationUs = fps.num > 0 && fps.den > 0 ? (int64_t)fps.den * 1000000 / fps.num
+                                                      : 1000000 / DEFAULT_FPS;
+
+        // mp4/mkv store avcc, sender stream annex b. pass through if annex b already.
+        const AVBitStreamFilter* filter = av_bsf_get_by_name("h264_mp4toannexb");
+        SS_THROW(filter, "bitstream filter h264_mp4toannexb not found");
+        check_libav(av_bsf_alloc(filter, &bsfCtx), "av_bsf_alloc");
+        check_libav(
+            avcodec_parameters_copy(bsfCtx->par_in, stream->codecpar), "avcodec_parameters_copy");
+        bsfCtx->time_base_in = stream->time_base;
+        check_libav(av_bsf_init(bsfCtx), "av_bsf_init");
+
+        bool eof = false;
+        while (!eof) {
+            int r = av_read_frame(formatCtx, packet);
+            if (r == AVERROR_EOF) {
+                eof = true;
+                check_libav(av_bsf_send_packet(bsfCtx, nullptr), "av_bsf_send_packet");
+            } else {
+                check_libav(r, "av_read_frame");
+                if (packet->stream_index != streamIndex) {
+                    av_packet_unref(packet);
+                    continue;
+                }
+                check_libav(av_bsf_send_packet(bsfCtx, packet), "av_bsf_send_packet");
+            }
+            while ((r = av_bsf_receive_packet(bsfCtx, packet)) == 0) {
+                AVPacket* out = av_packet_alloc();
+                SS_THROW(out, "'av_packet_alloc' fail");
+                av_packet_move_ref(out, packet);
+                mPackets.push_back(out);
+            }
+            SS_THROW(
+                r == AVERROR(EAGAIN) || r == AVERROR_EOF,
+                "'av_bsf_receive_packet' fail: %s",
+                averror_tostring(r).c_str());
+        }
+        SS_THROW(!mPackets.empty(), "no packet in clip: %s", path.c_str());
+    } catch (...) {
+        av_bsf_free(&bsfCtx);
+        avformat_close_input(&formatCtx);
+        av_packet_free(&packet);
+        for (AVPacket*& i : mPackets) {
+            av_packet_free(&i);
+        }
+        throw;
+    }
+    av_bsf_free(&bsfCtx);
+    avformat_close_input(&formatCtx);
+    av_packet_free(&packet);
+}
+
+void Bench::run() {
+    Trace::SetThreadName("bench sender");
+    RegisterThread("bench sender");
+    Log::I_STR("bench sender thread run");
+    uv_run(&*mLoop, UV_RUN_DEFAULT);
+    Log::I_STR("bench sender thread exit");
+}
+
+void Bench::onConnection(int status) {
+    if (status != 0) {
+        Log::E("bench accept fail: %s", uverror_tostring(status).c_str());
+        return;
+    }
+    // one receiver, reject others(e.g. reconnect before old closed).
+    if (mClientOpen) {
+        uv_tcp_t* reject = new uv_tcp_t;
+        if (uv_tcp_init(&*mLoop, reject) != 0) {
+            delete reject;
+            return;
+        }
+        uv_accept((uv_stream_t*)&mServer, (uv_stream_t*)reject);
+        uv_close((uv_handle_t*)reject, [](uv_handle_t* handle) { delete (uv_tcp_t*)handle; });
+        return;
+    }
+
+    int r = uv_tcp_init(&*mLoop, &mClient);
+    if (r != 0) {
+        Log::E("'uv_tcp_init' fail: %s", uverror_tostring(r).c_str());
+        return;
+    }
+    mClient.data = this;
+    mClientOpen = true;
+    r = uv_accept((uv_stream_t*)&mServer, (uv_stream_t*)&mClient);
+    if (r != 0) {
+        Log::E("bench accept fail: %s", uverror_tostring(r).c_str());
+        closeClient();
+        return;
+    }
+    uv_tcp_nodelay(&mClient, 1);
+
+    // receiver writes(e.g. key frame request) ignored, read to detect close.
+    r = uv_read_start(
+        (uv_stream_t*)&mClient,
+        [](uv_handle_t* handle, size_t suggestedSize, uv_buf_t* buf) {
+            (void)suggestedSize;
+            Bench* self = (Bench*)handle->data;
+            buf->base = self->mReadBuf;
+            buf->len = sizeof(self->mReadBuf);
+        },
+        [](uv_stream_t* stream, ssize_t nread, const uv_buf_t* buf) {
+            (void)buf;
+            if (nread < 0) {
+                ((Bench*)stream->data)->closeClient();
+            }
+        });
+    if (r != 0) {
+        Log::E("'uv_read_start' fail: %s", uverror_tostring(r).c_str());
+        closeClient();
+        return;
+    }
+    Log::I_STR("bench receiver connected");
+    mPaceStartTp = clock::now();
+    mPaceStartIndex = mSendIndex;
+    writeNext();
+}
+
+void Bench::writeNext() {
+    const AVPacket* packet = mPackets[mSendIndex % mPackets.size()];
+    PutJavaData<uint32_t>(mHeader, (uint32_t)packet->size);
+    PutJavaData<int64_t>(mHeader + 4, (int64_t)mSendIndex * mFrameDurationUs);
+    uv_buf_t bufs[2] = {
+        uv_buf_init(mHeader, sizeof(mHeader)),
+        uv_buf_init((char*)packet->data, (unsigned)packet->size),
+    };
+    mWriteReq.data = this;
+    int r = uv_write(&mWriteReq, (uv_stream_t*)&mClient, bufs, 2, [](uv_write_t* req, int status) {
+        ((Bench*)req->data)->onWrite(status);
+    });
+    if (r != 0) {
+        Log::E("'uv_write' fail: %s", uverror_tostring(r).c_str());
+        closeClient();
+    }
+}
+
+void Bench::onWrite(int status) {
+    if (status != 0) {
+        // canceled by close, or receiver gone.
+        closeClient();
+        return;
+    }
+    const AVPacket* packet = mPackets[mSendIndex % mPackets.size()];
+    mSentFrames.fetch_add(1, std::memory_order_relaxed);
+    mSentBytes.fetch_add(sizeof(mHeader) + (uint64_t)packet->size, std::memory_order_relaxed);
+    ++mSendIndex;
+    if (!mPaced) {
+        writeNext();
+        return;
+    }
+
+    // as real sender, next frame at its time, not after previous frame read.
+    int64_t dueUs = (int64_t)(mSendIndex - mPaceStartIndex) * mFrameDurationUs;
+    clock::time_point dueTp = mPaceStartTp + chrono::microseconds(dueUs);
+    int64_t delayMs = chrono::ceil<chrono::milliseconds>(dueTp - clock::now()).count();
+    if (delayMs <= 0) {
+        writeNext();
+        return;
+    }
+    int r = uv_timer_start(
+        &mPaceTimer,
+        [](uv_timer_t* handle) { ((Bench*)handle->data)->onPaceTimer(); },
+        (uint64_t)delayMs,
+        0);
+    if (r != 0) {
+        Log::E("'uv_timer_start' fail: %s", uverror_tostring(r).c_str());
+        closeClient();
+    }
+}
+
+void Bench::onPaceTimer() {
+    if (mClientOpen && !uv_is_closing((uv_handle_t*)&mClient)) {
+        writeNext();
+    }
+}
+
+void Bench::closeClient() {
+    if (!mClientOpen || uv_is_closing((uv_handle_t*)&mClient)) {
+        return;
+    }
+    uv_timer_stop(&mPaceTimer);
+    uv_close((uv_handle_t*)&mClient, [](uv_handle_t* handle) {
+        Bench* self = (Bench*)handle->data;
+        self->mClientOpen = false;
+        Log::I_STR("bench receiver closed");
+    });
+}
+}  // namespace ss
@@ -0,0 +1,132 @@
+#pragma once
+#include <ss/Common.hpp>
+
+namespace ss {
+/**
+ * loopback benchmark(-bench=[clip]), fake sender serve h264 stream of clip on 127.0.0.1 from
+ * own loop thread, repeat clip as fast as pipeline read(tcp back pressure), or at frame rate of
+ * clip if paced(-bench-paced, latency of threaded/inline pipeline compared this way). at exit
+ * report throughput of presented frames and cpu time of pipeline threads(linux only), stage
+ * percentiles by -debug-stage.
+ */
+class Bench : public xm::SingletonBase<Bench> {
+public:
+    using clock = chrono::high_resolution_clock;
+
+    /** load clip(any container of h264) and listen, create before NetThread. */
+    Bench(const std::string& clipPath, bool paced);
+
+    /** stop sender, call after NetThread joined. */
+    ~Bench();
+
+    /** listen port on 127.0.0.1. */
+    int port() const {
+        return mPort;
+    }
+
+    /** track cpu time of calling thread, once per thread, `name` must be string literal. */
+    static void RegisterThread(const char* name) {
+        if (Bench* self = Singleton()) {
+            thread_local bool registered = false;
+            if (!registered) {
+                registered = true;
+                self->registerThread(name);
+            }
+        }
+    }
+
+    /** presented frame(s) at `tp`, call on main thread. */
+    static void Present(clock::time_point tp, uint32_t frames = 1) {
+        if (Bench* self = Singleton()) {
+            if (self->mPresentFrames == 0) {
+                self->mFirstPresentTp = tp;
+            }
+            self->mPresentFrames += frames;
+            self->mLastPresentTp = tp;
+        }
+    }
+
+    /** log throughput and cpu time of threads, call before pipeline threads joined. */
+    void report();
+
+private:
+    struct RaiiUvLoop : xm::NonCopyable, uv_loop_t {
+        RaiiUvLoop() {
+            check_libuv(uv_loop_init(this), "uv_loop_init");
+        }
+
+        ~RaiiUvLoop() {
+            uv_walk(
+                this,  //
+                [](uv_handle_t* handle, void* arg) {
+                    (void)arg;
+                    if (uv_is_closing(handle) == 0) {
+                        uv_close(handle, nullptr);
+                    }
+                },
+                nullptr);
+            uv_run(this, UV_RUN_DEFAULT);
+            uv_loop_close(this);
+        }
+    };
+
+    struct ThreadCpu {
+        const char* name;
+#if defined(XM_OS_LINUX)
+        clockid_t clockId;
+#endif
+    };
+
+    void registerThread(const char* name);
+
+    void loadClip(const std::string& path);
+
+    void run();
+
+    void onConnection(int status);
+
+    void writeNext();
+
+    void onWrite(int status);
+
+    void onPaceTimer();
+
+    void closeClient();
+
+    // ----
+
+    /** annex b packets of clip in decode order, sps/pps in band. */
+    xm::Array<AVPacket*> mPackets;
+    int64_t mFrameDurationUs = 0;
+
+    std::optional<RaiiUvLoop> mLoop;
+    uv_tcp_t mServer = {};
+    uv_tcp_t mClient = {};
+    uv_async_t mAsyncStop = {};
+    /** paced only, send next packet at its time. */
+    uv_timer_t mPaceTimer = {};
+    uv_write_t mWriteReq = {};
+    char mHeader[12] = {};
+    char mReadBuf[64] = {};
+    bool mClientOpen = false;
+    int mPort = 0;
+    /** index of next packet in whole stream, clip repeated. */
+    uint64_t mSendIndex = 0;
+    bool mPaced = false;
+    /** paced only, send time of packet 0 of connection. */
+    clock::time_point mPaceStartTp;
+    /** mSendIndex of packet 0 of connection. */
+    uint64_t mPaceStartIndex = 0;
+    std::atomic<uint64_t> mSentFrames = 0;
+    std::atomic<uint64_t> mSentBytes = 0;
+    std::optional<std::thread> mThread;
+
+    clock::time_point mStartTp;
+    clock::time_point mFirstPresentTp;
+    clock::time_point mLastPresentTp;
+    uint64_t mPresentFrames = 0;
+
+    std::mutex mThreadsLock;
+    xm::Array<ThreadCpu> mThreads;  // guard by mThreadsLock.
+};
+}  // namespace ss
@@ -14,6 +14,8 @@
 
 #include <ss/BlockingQueue.hpp>
 
+#include <atomic>
+#include <condition_variable>
 #include <cstdint>
 #include <cstddef>
 #include <initializer_list>
@@ -22,6 +24,8 @@
 #include <memory>
 #include <string>
 #include <optional>
+#include <type_traits>
+#include <utility>
 
 #include <uv.h>
 
@@ -34,6 +38,8 @@ extern "C" {
 #if defined(XM_OS_LINUX)
     #include <unistd.h>
     #include <X11/Xlib.h>
+    #include <X11/Xutil.h>
+    #include <X11/extensions/XShm.h>
     #include <poll.h>
     #include <sys/eventfd.h>
     #include <glad/glx.h>
@@ -131,6 +137,25 @@ public:
 
     static inline void E(const char* fmt, ...) XM_PRINTF_FORMAT_CHECK(1, 2);
 
+    /**
+     * deferred format info line, only `fmt` and raw args copied, formatted by writer thread.
+     * for per frame debug lines, call by `SS_LOG_I_DEFER` to check format. `fmt` and string
+     * args must be string literals, other args arithmetic.
+     */
+    template <typename... Args>
+    static void I_DEFER(const char* fmt, Args... args) {
+        static_assert(sizeof...(Args) > 0, "use I_STR without args");
+        static_assert(
+            ((std::is_arithmetic_v<Args> || std::is_same_v<Args, const char*>)&&...),
+            "only arithmetic or string literal args");
+        static_assert(((sizeof(Args) <= ARG_SLOT) && ...), "arg too big");
+        char payload[sizeof(fmt) + ARG_SLOT * sizeof...(Args)];
+        ::memcpy(payload, &fmt, sizeof(fmt));
+        char* p = payload + sizeof(fmt);
+        ((::memcpy(p, &args, sizeof(args)), p += ARG_SLOT), ...);
+        Singleton()->append(LogTag::INFO, &FormatDeferred<Args...>, payload, sizeof(payload));
+    }
+
     static void PrintError(const Error& e) {
         xm::StringStream ss;
         ss.appendFormat("catch ss::Error: %s", e.what());
@@ -144,46 +169,105 @@ public:
         E(ss);
     }
 
-    /** av log callback, we need sync, because stdout shared by multi-thread. */
-    static void AvLogCallback(void* avcl, int level, const char* fmt, va_list vl) {
-        std::lock_guard<std::mutex> lock(Singleton()->mMutex);
-        av_log_default_callback(avcl, level, fmt, vl);
-        ::fflush(stdout);
-    }
+    /** av log callback, formatted then queued like other lines. */
+    static void AvLogCallback(void* avcl, int level, const char* fmt, va_list vl);
 
-    Log() {
-        I("share screen, version: %d.%d.%d, code: %d, build type: %s",
-          SS_VERSION_MAJOR,
-          SS_VERSION_MINOR,
-          SS_VERSION_PATCH,
-          SS_VERSION_CODE,
-          SS_BUILD_TYPE_NAME);
-    }
+    /** start writer thread, output to stdout. */
+    Log();
 
-    ~Log() {}
+    /** write all queued lines, then stop writer thread. */
+    ~Log();
 
+    /** output to file(append) instead of stdout, throw if open fail. */
+    void setOutputFile(const std::string& path);
+
+    /**
+     * queue line to ring of calling thread, never block(except first call of thread). line
+     * dropped and counted if ring full, order kept per thread.
+     */
     void write(LogTag tag, const char* str) {
-        std::lock_guard<std::mutex> lock(mMutex);
-        switch (tag) {
-            case LogTag::INFO:
-                ::printf("[I] %s\n", str);
-                ::fflush(stdout);
-                break;
-            case LogTag::WARNING:
-                ::printf("[W] %s\n", str);
-                ::fflush(stdout);
-                break;
-            case LogTag::ERR:
-                ::printf("[E] %s\n", str);
-                ::fflush(stdout);
-                break;
-            default:
-                break;
-        }
+        append(tag, nullptr, str, (uint32_t)::strlen(str));
     }
 
 private:
-    std::mutex mMutex;
+    /** format deferred payload to `buf`, return snprintf result. */
+    using FormatFn = int (*)(char* buf, size_t size, const char* payload);
+
+    enum : uint32_t {
+        /** deferred arg stored in 8 bytes. */
+        ARG_SLOT = 8,
+        /** bytes per thread, power of 2, long lines truncated to half of it. */
+        RING_CAPACITY = 1 << 16,
+        /** writer wakeup may be lost without lock, bound the delay. */
+        WRITER_WAIT_MS = 50,
+    };
+
+    /** single producer(owner thread) single consumer(writer thread) byte ring. */
+    struct Ring {
+        /** owner thread exited, reused by next registered thread. */
+        std::atomic<bool> owned = true;
+        std::atomic<uint64_t> head = 0;
+        std::atomic<uint64_t> tail = 0;
+        char data[RING_CAPACITY];
+    };
+
+    /** record in ring, text or deferred payload follow, size aligned to 8. */
+    struct RecordHeader {
+        /** `PADDING` skip to ring begin. */
+        uint32_t size;
+        LogTag tag;
+        /** nullptr if payload is text. */
+        FormatFn format;
+    };
+
+    template <typename T>
+    static T LoadArg(const char* p) {
+        T v;
+        ::memcpy(&v, p, sizeof(v));
+        return v;
+    }
+
+    template <typename... Args, size_t... I>
+    static int FormatDeferred(
+        char* buf, size_t size, const char* payload, std::index_sequence<I...>) {
+        const char* fmt = LoadArg<const char*>(payload);
+        payload += sizeof(fmt);
+        return snprintf(buf, size, fmt, LoadArg<Args>(payload + I * ARG_SLOT)...);
+    }
+
+    template <typename... Args>
+    static int FormatDeferred(char* buf, size_t size, const char* payload) {
+        return FormatDeferred<Args...>(buf, size, payload, std::index_sequence_for<Args...> {});
+    }
+
+    /** queue record, never block(except first call of thread), dropped if ring full. */
+    void append(LogTag tag, FormatFn format, const char* payload, uint32_t size);
+
+    static constexpr uint32_t PADDING = UINT32_MAX;
+
+    /** ring of calling thread, register on first call. */
+    Ring* ringOfThread();
+
+    /** move queued lines to `mBatch`, return false if nothing queued. */
+    bool drain();
+
+    void runWriter();
+
+    // ----
+
+    std::mutex mRingsLock;
+    xm::Array<std::unique_ptr<Ring>> mRings;  // guard by mRingsLock.
+    std::atomic<uint64_t> mDropLines = 0;
+    std::atomic<bool> mWakeup = false;
+    std::atomic<bool> mStop = false;
+    std::mutex mWakeupLock;
+    std::condition_variable mWakeupCond;
+    /** writer thread only. */
+    xm::Array<char> mBatch;
+    uint64_t mReportedDropLines = 0;
+    std::mutex mOutputLock;
+    FILE* mOutput = stdout;  // guard by mOutputLock.
+    std::optional<std::thread> mWriter;
 };
 
 inline void Log::I(const char* fmt, ...) {
@@ -213,6 +297,19 @@ inline void Log::E(const char* fmt, ...) {
     E(ss);
 }
 
+/**
+ * deferred format info line, see `Log::I_DEFER`, printf never called but format checked.
+ * usage:
+ * SS_LOG_I_DEFER("session %d read body, pts: %lld", 0, (long long)pts).
+ */
+#define SS_LOG_I_DEFER(FMT, ...)                  \
+    do {                                          \
+        if (false) {                              \
+            ::printf(FMT, __VA_ARGS__);           \
+        }                                         \
+        ss::Log::I_DEFER(FMT, __VA_ARGS__);       \
+    } while (0)
+
 ////////////////////////////////////////////////////////////////////////////////
 
 /** libavcodec error to string. */
@@ -263,6 +360,33 @@ XM_FORCE_INLINE void check_errno(bool check_true, const char* api_name) {
 }
 #endif
 
+/** java data is big endian, we need check and convert. */
+template <typename T>
+T GetJavaData(const char* p) {
+#if defined(SS_IS_LITTLE)
+    alignas(T) char tmp[sizeof(T)];
+    for (int i = 0, e = sizeof(T); i < e; ++i) {
+        tmp[i] = p[e - i - 1];
+    }
+    return *(const T*)tmp;
+#else
+    return *(const T*)p;
+#endif
+}
+
+/** write as java data(big endian), same as sender. */
+template <typename T>
+void PutJavaData(char* p, T v) {
+    const char* src = (const char*)&v;
+#if defined(SS_IS_LITTLE)
+    for (int i = 0, e = sizeof(T); i < e; ++i) {
+        p[i] = src[e - i - 1];
+    }
+#else
+    ::memcpy(p, src, sizeof(T));
+#endif
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 
 struct PaintFrame : xm::NonCopyable {
@@ -275,7 +399,23 @@ struct PaintFrame : xm::NonCopyable {
         av_frame_free(&decodeFrame);
     }
 
+    /** index of session the frame belongs to, fixed when pool created. */
+    int session = 0;
+    /** epoch of net-frame, pts sync restart when it changed. */
+    uint32_t epoch = 0;
     int64_t pts = 0;
+    /** time points of net-frame header and body receive complete, use for latency measure. */
+    chrono::high_resolution_clock::time_point headerTp;
+    chrono::high_resolution_clock::time_point recvTp;
+    /** time points of decode, use for stage measure. */
+    chrono::high_resolution_clock::time_point decodeBeginTp;
+    chrono::high_resolution_clock::time_point decodeEndTp;
+    /** time point of pts sync release to paint, decode end if no pts sync. */
+    chrono::high_resolution_clock::time_point releaseTp;
+    /** bytes of net-frame body, use for bitrate measure. */
+    int bodySize = 0;
+    /** image buffer bytes referenced by decodeFrame, 0 when recycled(unref). */
+    int64_t residentBytes = 0;
     AVFrame* decodeFrame;
 };
 
@@ -289,16 +429,99 @@ struct NetFrame : xm::NonCopyable {
         av_packet_free(&body);
     }
 
+    /** true if first slice of body(h264 annex b) is idr, stop at first slice. */
+    bool scanKeyFrame() const {
+        // nal header follow start code 00 00 01(or 00 00 00 01).
+        const uint8_t* data = body->data;
+        for (int i = 0; i + 3 < body->size; ++i) {
+            if (data[i] == 0 && data[i + 1] == 0 && data[i + 2] == 1) {
+                int type = data[i + 3] & 0x1f;
+                // vcl nal, slices of one picture share type, sei/sps/pps come before.
+                if (type >= 1 && type <= 5) {
+                    return type == 5;
+                }
+                i += 2;
+            }
+        }
+        return false;
+    }
+
+    /** index of session the frame belongs to, fixed when pool created. */
+    int session = 0;
+    /** connection generation of session, changed by reconnect. */
+    uint32_t epoch = 0;
     int64_t pts = 0;
+    /** body is idr, scanned once by net thread, only if relay or record enabled. */
+    bool keyFrame = false;
+    /** time points of header and body receive complete, use for latency measure. */
+    chrono::high_resolution_clock::time_point headerTp;
+    chrono::high_resolution_clock::time_point recvTp;
     AVPacket* body;
 };
 
 ////////////////////////////////////////////////////////////////////////////////
 
+/** max sessions(streams) served by one process. */
+constexpr int MAX_SESSION = 16;
+
+/** frame pipeline mode. */
+enum class PipelineMode : uint32_t {
+    /** net/decode/pts/main run on their own thread, hand over frames by queue. */
+    THREADED = 0,
+    /** net read/decode/pts/paint run on main thread, only for linux. */
+    INLINE,
+};
+
+/** where frames render to. */
+enum class RenderBackend : uint32_t {
+    /** gl window. */
+    WINDOW = 0,
+    /** gl context on egl pbuffer(surfaceless platform if possible), no display needed. */
+    HEADLESS_EGL,
+    /** no gl, copy frame planes to memory only. */
+    HEADLESS_CPU,
+    /** no gl, software render(SwRender) to memory. */
+    HEADLESS_SW,
+};
+
+/** decode while window hidden(minimized or fully obscured). */
+enum class HiddenDecode : uint32_t {
+    /** decode all frames, only skip paint. */
+    ALL = 0,
+    /** decode reference frames only. */
+    NONREF,
+    /** no decode, request key frame when visible again. */
+    NONE,
+};
+
+/** pipeline thread, for placement and priority. */
+enum class ThreadRole : uint32_t {
+    NET = 0,
+    /** all decode workers. */
+    DECODE,
+    /** pacing by pts. */
+    PTS,
+    /** paint and swap. */
+    MAIN,
+    RECORD,
+    COUNT,
+};
+
+/** scheduling of pacing(pts) and main thread, fallback to lower one without privilege. */
+enum class ThreadPriority : uint32_t {
+    NORMAL = 0,
+    /** nice -10. */
+    NICE,
+    /** SCHED_FIFO, preempt any normal thread. */
+    FIFO,
+};
+
 /** app config. */
 struct Config : xm::SingletonBase<Config> {
-    /** direct connect ip instead of connect by broadcast. */
-    std::string ip;
+    /** direct connect ip of each session, empty: one session connect by broadcast. */
+    xm::Array<std::string> ips;
+    /** decode worker threads shared by sessions, 0 means auto. */
+    int decodeThreads = 0;
     /** connect port. */
     int port = 1314;
     /** broadcast port. */
@@ -311,5 +534,72 @@ struct Config : xm::SingletonBase<Config> {
     bool debugPts = false;
     /** print decode info. */
     bool debugDecode = false;
+    /** print latency(net receive -> swap buffers) info. */
+    bool debugLatency = false;
+    /** print texture upload info. */
+    bool debugUpload = false;
+    /** print per stage(queue/decode/wait/paint/swap) time info. */
+    bool debugStage = false;
+    /** only upload changed 64x64 tiles of frame image. */
+    bool dirtyTile = true;
+    /** force opengl 2.1 path, skip core context and vao/vbo/immutable texture. */
+    bool glLegacy = false;
+    /** pack y/u/v planes to one texture, 3 planes format only. */
+    bool glPackedPlanes = false;
+    /** software render(no gl) presented by MIT-SHM, only for linux, also fallback if no gl. */
+    bool swRender = false;
+    /** software render convert threads(include main thread), 0 means auto. */
+    int swRenderThreads = 0;
+    /** render backend, headless only for linux. */
+    RenderBackend render = RenderBackend::WINDOW;
+    /** headless only, render target size. */
+    int headlessWidth = 1920;
+    int headlessHeight = 1080;
+    /** headless or bench only, exit after present frames, 0 means never. */
+    uint64_t headlessFrames = 0;
+    /** decode while window hidden. */
+    HiddenDecode hiddenDecode = HiddenDecode::NONREF;
+    /** frame pipeline mode. */
+    PipelineMode pipeline = PipelineMode::THREADED;
+    /** inline pipeline only, offload decode to decode thread if decode time exceed it(ms). */
+    int inlineDecodeBudget = 8;
+    /** re-serve received stream to downstream viewers on relayPort, one session only. */
+    bool relay = false;
+    int relayPort = 1315;
+    /** print startup phases time after first frame presented. */
+    bool startupReport = false;
+    /** reconnect and keep window/decoder on net error after connected, instead of exit. */
+    bool reconnect = true;
+    /** remux received stream to file(mp4/mkv by extension), empty means no record. */
+    std::string recordPath;
+    /** last sender found by broadcast, tried directly on next start. empty means disable. */
+    std::string senderCachePath;
+    /** localhost port of prometheus metrics http endpoint, 0 means disable. */
+    int metricsPort = 0;
+    /** chrome trace json of thread activity, empty means no trace. */
+    std::string tracePath;
+    /** show stats overlay at start, toggle by key 'o'. */
+    bool overlay = false;
+    /** h264 clip served by loopback fake sender, empty means no bench. */
+    std::string benchClip;
+    /** bench sender send at frame rate of clip, not as fast as read. */
+    bool benchPaced = false;
+    /** cpu mask(bit i: cpu i) of each ThreadRole, 0 means not pinned, only for linux. */
+    uint64_t threadCpus[(int)ThreadRole::COUNT] = {};
+    /** only for linux. */
+    ThreadPriority threadPriority = ThreadPriority::NORMAL;
+    /**
+     * paint-frame pool size per session, 0 means auto: 3 if immediately paint, else start from 4
+     * and grow when decode blocked by frames waiting pts.
+     */
+    int paintFrames = 0;
+    /** ceiling of decoded image bytes held by paint frames of all sessions, 0 means no limit. */
+    int64_t frameMemoryBudget = 0;
+    /** large frame and packet buffers on huge pages, only for linux. */
+    bool hugePages = false;
+
+    int sessionCount() const {
+        return ips.empty() ? 1 : (int)ips.size();
+    }
 };
 }  // namespace ss
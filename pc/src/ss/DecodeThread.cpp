@@ -2,137 +2,328 @@
 #include <ss/MainThread.hpp>
 #include <ss/PtsThread.hpp>
 #include <ss/NetThread.hpp>
+#include <ss/StartupReport.hpp>
+#include <ss/Trace.hpp>
+#include <ss/Bench.hpp>
+#include <ss/ThreadPolicy.hpp>
 
 namespace ss {
+namespace {
+/** skip frame once key frame decoded, by visibility applied to decoder. */
+AVDiscard SteadySkipFrame(bool hidden) {
+    if (!hidden) {
+        return AVDISCARD_DEFAULT;
+    }
+    // nonref: reference chain kept, resume without key frame.
+    // none: only parse, resume from next key frame(requested by main thread).
+    HiddenDecode mode = Config::Singleton()->hiddenDecode;
+    return mode == HiddenDecode::NONREF ? AVDISCARD_NONREF
+           : mode == HiddenDecode::NONE ? AVDISCARD_ALL
+                                        : AVDISCARD_DEFAULT;
+}
+
+/** skip frame until key frame decoded, e.g. after reconnect. */
+AVDiscard WaitKeySkipFrame(bool hidden) {
+    // hidden and decode none, still skip all, key frame requested when visible.
+    return SteadySkipFrame(hidden) == AVDISCARD_ALL ? AVDISCARD_ALL : AVDISCARD_NONKEY;
+}
+}  // namespace
+
 DecodeThread::DecodeThread() {
+    StartupReport::Begin(StartupReport::DECODER_OPEN);
     av_log_set_callback(&Log::AvLogCallback);
 
+    Config* cfg = Config::Singleton();
+    mSessionCount = cfg->sessionCount();
+    // session decode by one worker at a time, more workers than sessions are idle.
+    int hwThreads = std::max((int)std::thread::hardware_concurrency(), 1);
+    mWorkerCount = cfg->decodeThreads > 0 ? cfg->decodeThreads : hwThreads;
+    mWorkerCount = std::clamp(mWorkerCount, 1, mSessionCount);
+
+    int poolSize = cfg->paintFrames > 0  ? cfg->paintFrames
+                   : cfg->immediatelyPaint ? PAINT_FRAME_POOL_IMMEDIATELY
+                                           : PAINT_FRAME_POOL_SYNC;
+    mPoolGrow = cfg->paintFrames == 0 && !cfg->immediatelyPaint;
+    mMemoryBudget = cfg->frameMemoryBudget;
+
+    mCodec = avcodec_find_decoder(AV_CODEC_ID_H264);
+    SS_THROW(mCodec, "find h264 decoder fail");
+
+    for (int i = 0; i < mSessionCount; ++i) {
+        Decoder& d = mDecoders[i].emplace();
+        d.codecCtx.reset(avcodec_alloc_context3(mCodec));
+        SS_THROW(d.codecCtx, "'avcodec_alloc_context3' fail");
+        if (HugePageAlloc::Singleton()) {
+            d.framePool.emplace().attach(d.codecCtx.get());
+        }
+        check_libav(avcodec_open2(d.codecCtx.get(), mCodec, NULL), "avcodec_open2");
+
+        d.cachePacket.reset(av_packet_alloc());
+        SS_THROW(d.cachePacket, "av_packet_alloc fail");
+
+        // decoded frames held by pool, not by decoder, keep it small.
+        std::lock_guard<std::mutex> lock(d.lock);
+        while (d.poolSize < poolSize) {
+            growPool(d, i);
+        }
+    }
+    Log::I(
+        "paint frame pool: %d%s, memory budget: %s",
+        poolSize,
+        mPoolGrow ? "(grow on demand)" : "",
+        mMemoryBudget > 0 ? (std::to_string(mMemoryBudget >> 20) + "MB").c_str() : "no limit");
+    StartupReport::End(StartupReport::DECODER_OPEN);
+
+    // inline pipeline decode on main thread, thread start until `offload`.
+    if (cfg->pipeline == PipelineMode::INLINE) {
+        return;
+    }
+
+    startWorkers();
+}
+
+void DecodeThread::startWorkers() {
+    Log::I("decode sessions: %d, threads: %d", mSessionCount, mWorkerCount);
     try {
-        mThread.emplace([this]() { run(); });
+        mScheduler.emplace(mSessionCount, mWorkerCount, [this](int session, int worker) {
+            (void)worker;
+            return decodeSlice(session);
+        });
     } catch (const std::exception& e) {
         SS_THROW(0, "create thread fail: %s", e.what());
     }
+    for (int i = 0; i < mSessionCount; ++i) {
+        mScheduler->setPriority(i, mPriorities[i]);
+        // inline pipeline may offload with frames pending.
+        mScheduler->notifyRunnable(i);
+    }
 }
 
-void DecodeThread::run() {
-    struct TagExit {};
+bool DecodeThread::decode(NetFrame* src, PaintFrame* dst) {
     using clock = chrono::high_resolution_clock;
 
-    Log::I_STR("decode thread run");
+    Decoder& d = *mDecoders[src->session];
+    dst->pts = src->pts;
+    dst->epoch = src->epoch;
+    dst->headerTp = src->headerTp;
+    dst->recvTp = src->recvTp;
+    dst->bodySize = src->body->size;
 
-    try {
-        mCodec = avcodec_find_decoder(AV_CODEC_ID_H264);
-        SS_THROW(mCodec, "find h264 decoder fail");
-        mCodecCtx.reset(avcodec_alloc_context3(mCodec));
-        SS_THROW(mCodecCtx, "'avcodec_alloc_context3' fail");
-        check_libav(avcodec_open2(mCodecCtx.get(), mCodec, NULL), "avcodec_open2");
-
-        for (int i = 0; i < PAINT_FRAME_POOL_CAPACITY; ++i) {
-            mPaintFramePool[i].emplace();
-            mFreePaintFrames.push_back(&*mPaintFramePool[i]);
+    if (src->epoch != d.epoch) {
+        // reconnected, new stream start from config and key frame, last frame keep showing.
+        d.epoch = src->epoch;
+        avcodec_flush_buffers(d.codecCtx.get());
+        av_packet_unref(d.cachePacket.get());
+        d.codecCtx->skip_frame = WaitKeySkipFrame(d.hiddenApplied);
+        d.waitKeyFrame = true;
+        Log::I("session %d reconnected, decode from next key frame", src->session);
+    }
+
+    AVPacket* packet = nullptr;
+    // check whether need merge to cache packet.
+    if (d.cachePacket->size || dst->pts == -1) {
+        int offset = d.cachePacket->size;
+        int growSize = src->body->size;
+        uint8_t* growData = src->body->data;
+        av_grow_packet(d.cachePacket.get(), growSize);
+        ::memcpy(d.cachePacket->data + offset, growData, growSize);
+        packet = d.cachePacket.get();
+    } else {
+        packet = src->body;
+    }
+
+    if (dst->pts == -1) {
+        return false;
+    }
+
+    dst->decodeBeginTp = clock::now();
+
+    updateSkipFrame(d);
+    check_libav(avcodec_send_packet(d.codecCtx.get(), packet), "avcodec_send_packet");
+    int r = avcodec_receive_frame(d.codecCtx.get(), dst->decodeFrame);
+    if (r == AVERROR(EAGAIN) && d.codecCtx->skip_frame != AVDISCARD_DEFAULT) {
+        // frame discarded by skip frame.
+        av_packet_unref(d.cachePacket.get());
+        Metrics::Add(Metrics::DECODE_DROPPED_FRAMES, src->session);
+        mDroppedFrames.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    check_libav(r, "avcodec_receive_frame");
+
+    SS_THROW(!UTSO_FAIL_DECODE, "unit test simulate");
+
+    if (d.waitKeyFrame && dst->decodeFrame->key_frame) {
+        d.waitKeyFrame = false;
+        // reconnected while hidden keep hidden skip mode.
+        d.codecCtx->skip_frame = SteadySkipFrame(d.hiddenApplied);
+        Log::I(
+            "session %d key frame decoded, decode skip frame: %d",
+            src->session,
+            (int)d.codecCtx->skip_frame);
+    }
+
+    // usually one buffer(pool of decoder) per plane, refcounted until recycle.
+    int64_t bytes = 0;
+    for (AVBufferRef* buf : dst->decodeFrame->buf) {
+        bytes += buf ? (int64_t)buf->size : 0;
+    }
+    d.frameBytes = bytes;
+    dst->residentBytes = bytes;
+    int64_t resident = mResidentBytes.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+    int64_t peak = mPeakResidentBytes.load(std::memory_order_relaxed);
+    while (resident > peak &&
+           !mPeakResidentBytes.compare_exchange_weak(peak, resident, std::memory_order_relaxed)) {
+    }
+    Metrics::Add(Metrics::PAINT_FRAME_BYTES, src->session, bytes);
+
+    dst->decodeEndTp = clock::now();
+    dst->releaseTp = dst->decodeEndTp;
+    Metrics::Add(Metrics::DECODED_FRAMES, src->session);
+    Metrics::Observe(Metrics::DECODE_TIME, src->session, dst->decodeEndTp - dst->decodeBeginTp);
+    StartupReport::Begin(StartupReport::FIRST_DECODE, dst->decodeBeginTp);
+    StartupReport::End(StartupReport::FIRST_DECODE, dst->decodeEndTp);
+    if (Config::Singleton()->debugDecode) {
+        SS_LOG_I_DEFER(
+            "decode time: %lldms, pts: %lld, key frame: %s",
+            (long long)chrono::duration_cast<chrono::milliseconds>(
+                dst->decodeEndTp - dst->decodeBeginTp)
+                .count(),
+            (long long)dst->pts,
+            dst->decodeFrame->key_frame ? "true" : "false");
+    }
+    av_packet_unref(d.cachePacket.get());
+    return true;
+}
+
+void DecodeThread::updateSkipFrame(Decoder& d) {
+    bool hidden = mHidden;
+    if (hidden == d.hiddenApplied) {
+        return;
+    }
+    d.hiddenApplied = hidden;
+
+    if (!hidden && Config::Singleton()->hiddenDecode == HiddenDecode::NONE) {
+        d.codecCtx->skip_frame = AVDISCARD_NONKEY;
+        d.waitKeyFrame = true;
+    } else if (d.waitKeyFrame) {
+        d.codecCtx->skip_frame = WaitKeySkipFrame(hidden);
+    } else {
+        d.codecCtx->skip_frame = SteadySkipFrame(hidden);
+    }
+    Log::I(
+        "window %s, decode skip frame: %d",
+        hidden ? "hidden" : "visible",
+        (int)d.codecCtx->skip_frame);
+}
+
+void DecodeThread::join() {
+    if (mScheduler) {
+        mScheduler->join();
+    }
+    for (int i = 0; i < mSessionCount; ++i) {
+        Decoder& d = *mDecoders[i];
+        std::lock_guard<std::mutex> lock(d.lock);
+        Log::I(
+            "session %d paint frame pool: %d, frame: %.1fMB",
+            i,
+            d.poolSize,
+            (double)d.frameBytes / (1 << 20));
+    }
+    Log::I(
+        "paint frames peak resident: %.1fMB",
+        (double)mPeakResidentBytes.load(std::memory_order_relaxed) / (1 << 20));
+}
+
+bool DecodeThread::growPool(Decoder& d, int session) {
+    if (d.poolSize >= PAINT_FRAME_POOL_CAPACITY) {
+        return false;
+    }
+    PaintFrame& f = d.paintFramePool[d.poolSize].emplace();
+    f.session = session;
+    d.freePaintFrames.push_back(&f);
+    ++d.poolSize;
+    return true;
+}
+
+PaintFrame* DecodeThread::obtainPaintFrame(Decoder& d, int session) {
+    int held = d.poolSize - (int)d.freePaintFrames.size();
+    // one frame in flight always allowed, or never decode if budget less than a frame.
+    if (mMemoryBudget > 0 && held > 0 &&
+        mResidentBytes.load(std::memory_order_relaxed) + d.frameBytes > mMemoryBudget) {
+        return nullptr;
+    }
+    if (d.freePaintFrames.empty()) {
+        // all held by pts sync/paint, more frames absorb sender jitter instead of block decode.
+        if (!mPoolGrow || !growPool(d, session)) {
+            return nullptr;
         }
+        Log::I("session %d paint frame pool grow to %d", session, d.poolSize);
+    }
+    PaintFrame* paintFrame = d.freePaintFrames.back();
+    d.freePaintFrames.pop_back();
+    Metrics::Set(Metrics::FREE_PAINT_FRAMES, session, d.freePaintFrames.size());
+    return paintFrame;
+}
 
-        // when pts == -1 the frame not output image(it only contain config information),
-        // we cache it until image frame come in, then merge together to decode.
-        struct AVPacketDeleter {
-            void operator()(AVPacket* p) const {
-                av_packet_free(&p);
-            }
-        };
-        std::unique_ptr<AVPacket, AVPacketDeleter> cachePacket;
-        cachePacket.reset(av_packet_alloc());
-        SS_THROW(cachePacket, "av_packet_alloc fail");
+void DecodeThread::offload() {
+    if (isOffloaded()) {
+        return;
+    }
+
+    startWorkers();
+}
+
+bool DecodeThread::decodeSlice(int session) {
+    Trace::SetThreadName("decode");
+    Bench::RegisterThread("decode");
+    ApplyThreadPolicy(ThreadRole::DECODE);
+    Decoder& d = *mDecoders[session];
+    for (int i = 0; i < SLICE_FRAMES; ++i) {
+        if (mFailed) {
+            return false;
+        }
 
-        clock::time_point now0;
-        clock::time_point now1;
         NetFrame* src = nullptr;
         PaintFrame* dst = nullptr;
-        while (!mClose) {
-            if (!src) {
-                std::optional<NetFrame*> tmp =
-                    mPendingNetFrames.pop_front(std::chrono::milliseconds(2000));
-                if (!tmp) {
-                    continue;
-                } else {
-                    src = *tmp;
-                    if (!src) {
-                        throw TagExit {};
-                    }
-                }
+        {
+            std::lock_guard<std::mutex> lock(d.lock);
+            if (d.pendingNetFrames.empty()) {
+                return false;
             }
-
+            // resumed by recycle.
+            dst = obtainPaintFrame(d, session);
             if (!dst) {
-                std::optional<PaintFrame*> tmp =
-                    mFreePaintFrames.pop_front(std::chrono::milliseconds(2000));
-                if (!tmp) {
-                    continue;
-                } else {
-                    dst = *tmp;
-                    if (!dst) {
-                        throw TagExit {};
-                    }
-                }
+                return false;
             }
+            src = d.pendingNetFrames.front();
+            d.pendingNetFrames.pop_front();
+            Metrics::Set(Metrics::DECODE_QUEUE, session, d.pendingNetFrames.size());
+        }
 
-            dst->pts = src->pts;
-
-            AVPacket* packet = nullptr;
-            // check whether need merge to cache packet.
-            if (cachePacket->size || dst->pts == -1) {
-                int offset = cachePacket->size;
-                int growSize = src->body->size;
-                uint8_t* growData = src->body->data;
-                av_grow_packet(cachePacket.get(), growSize);
-                ::memcpy(cachePacket->data + offset, growData, growSize);
-                packet = cachePacket.get();
-            } else {
-                packet = src->body;
-            }
-
-            if (dst->pts == -1) {
-                notifyRecyclePaintFrame(dst);
-            } else {
-                if (Config::Singleton()->debugDecode) {
-                    now0 = clock::now();
-                }
-
-                check_libav(avcodec_send_packet(mCodecCtx.get(), packet), "avcodec_send_packet");
-                check_libav(
-                    avcodec_receive_frame(mCodecCtx.get(), dst->decodeFrame),
-                    "avcodec_receive_frame");
-
-                SS_THROW(!UTSO_FAIL_DECODE, "unit test simulate");
-
-                if (Config::Singleton()->debugDecode) {
-                    now1 = clock::now();
-                    Log::I(
-                        "decode time: %lldms, pts: %lld, key frame: %s",
-                        (long long)chrono::duration_cast<chrono::milliseconds>(now1 - now0).count(),
-                        (long long)dst->pts,
-                        dst->decodeFrame->key_frame ? "true" : "false");
-                }
-                av_packet_unref(cachePacket.get());
+        try {
+            TraceZone zone("decode");
+            if (decode(src, dst)) {
                 if (PtsThread::Singleton()) {
                     PtsThread::Singleton()->notifySyncFrame(dst);
                 } else {
                     MainThread::Singleton()->notifyPaintFrame(dst);
                 }
+            } else {
+                notifyRecyclePaintFrame(dst);
             }
-
             NetThread::Singleton()->notifyRecycleNetFrame(src);
-
-            src = nullptr;
-            dst = nullptr;
+            continue;
+        } catch (const Error& e) {
+            Log::PrintError(e);
+        } catch (const std::exception& e) {
+            Log::E("catch %s: %s, %s#%d", typeid(e).name(), e.what(), __FILE__, __LINE__);
         }
-    } catch (const TagExit&) {  //
-    } catch (const Error& e) {
-        Log::PrintError(e);
-    } catch (const std::exception& e) {
-        Log::E("catch %s: %s, %s#%d", typeid(e).name(), e.what(), __FILE__, __LINE__);
-    }
 
-    MainThread::Singleton()->notifyClose();
-
-    Log::I("decode thread exit");
+        mFailed = true;
+        MainThread::Singleton()->notifyClose();
+        Log::I("decode fail, session: %d", session);
+        return false;
+    }
+    return true;
 }
-}  // namespace ss
\ No newline at end of file
+}  // namespace ss
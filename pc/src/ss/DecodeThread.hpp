@@ -1,28 +1,93 @@
 #pragma once
 #include <ss/Common.hpp>
+#include <ss/HugePageAlloc.hpp>
+#include <ss/Metrics.hpp>
+#include <ss/SessionScheduler.hpp>
 
 namespace ss {
-/** decode thread, handle frame decode. */
+/**
+ * decode thread, handle frame decode. one decoder per session, sessions share worker threads by
+ * SessionScheduler, frames of one session decode in order.
+ */
 class DecodeThread : public xm::SingletonBase<DecodeThread> {
 public:
     DecodeThread();
 
     void notifyRecyclePaintFrame(PaintFrame* paintFrame) {
-        mFreePaintFrames.push_back(paintFrame);
+        // image buffers back to decoder pool now, free paint-frame hold no image.
+        av_frame_unref(paintFrame->decodeFrame);
+        int64_t bytes = std::exchange(paintFrame->residentBytes, 0);
+        mResidentBytes.fetch_sub(bytes, std::memory_order_relaxed);
+        Metrics::Add(Metrics::PAINT_FRAME_BYTES, paintFrame->session, -bytes);
+
+        Decoder& d = *mDecoders[paintFrame->session];
+        {
+            std::lock_guard<std::mutex> lock(d.lock);
+            d.freePaintFrames.push_back(paintFrame);
+            Metrics::Set(Metrics::FREE_PAINT_FRAMES, paintFrame->session, d.freePaintFrames.size());
+        }
+        // may blocked by paint-frame pool exhausted.
+        if (mScheduler) {
+            mScheduler->notifyRunnable(paintFrame->session);
+        }
     }
 
     void notifyDecodeFrame(NetFrame* netFrame) {
-        mPendingNetFrames.push_back(netFrame);
+        Decoder& d = *mDecoders[netFrame->session];
+        {
+            std::lock_guard<std::mutex> lock(d.lock);
+            d.pendingNetFrames.push_back(netFrame);
+            Metrics::Set(Metrics::DECODE_QUEUE, netFrame->session, d.pendingNetFrames.size());
+        }
+        mScheduler->notifyRunnable(netFrame->session);
+    }
+
+    /** higher decode first, e.g. focused session. */
+    void notifySessionPriority(int session, int priority) {
+        mPriorities[session] = priority;
+        if (mScheduler) {
+            mScheduler->setPriority(session, priority);
+        }
+    }
+
+    /** window visibility changed, decode throttle by `Config::hiddenDecode` while hidden. */
+    void notifyVisible(bool visible) {
+        mHidden = !visible;
     }
 
     void notifyClose() {
-        mClose = true;
-        mPendingNetFrames.push_back(nullptr);
-        mFreePaintFrames.push_back(nullptr);
+        if (mScheduler) {
+            mScheduler->stop();
+        }
+    }
+
+    /** join workers, log pool size and peak resident bytes. */
+    void join();
+
+    /** inline pipeline only, return free paint-frame without wait, nullptr if pool exhausted. */
+    PaintFrame* obtainPaintFrameInline() {
+        Decoder& d = *mDecoders[0];
+        std::lock_guard<std::mutex> lock(d.lock);
+        return obtainPaintFrame(d, 0);
+    }
+
+    /**
+     * decode src to dst on caller thread, return false if dst not output image(config frame).
+     * inline pipeline only call it before `offload`, after that decoder owned by decode thread.
+     */
+    bool decode(NetFrame* src, PaintFrame* dst);
+
+    /** inline pipeline only, start decode thread, then pass frames by `notifyDecodeFrame`. */
+    void offload();
+
+    /** whether decode thread running. */
+    bool isOffloaded() const {
+        return mScheduler.has_value();
     }
 
-    void join() {
-        mThread->join();
+    /** frames discarded by decoder(window hidden or waiting key frame) of all sessions. */
+    uint64_t droppedFrames() const {
+        return mDroppedFrames.load(std::memory_order_relaxed);
     }
 
 private:
@@ -32,29 +97,94 @@ private:
         }
     };
 
+    struct AVPacketDeleter {
+        void operator()(AVPacket* p) const {
+            av_packet_free(&p);
+        }
+    };
+
     enum : uint8_t {
+        /** max paint-frames per session, pool grow up to it. */
         PAINT_FRAME_POOL_CAPACITY = 20,
+        /** decoding, pending paint and painting. */
+        PAINT_FRAME_POOL_IMMEDIATELY = 3,
+        /** one more waiting pts, pool grow if sender jitter need more. */
+        PAINT_FRAME_POOL_SYNC = 4,
+        /** frames decode in one schedule of session, then other sessions of worker run. */
+        SLICE_FRAMES = 4,
 
         /** unit test simulate options. */
         UTSO_FAIL_DECODE = 0,
     };
 
-    void run();
+    /** decoder state of one session, only touched by worker running session. */
+    struct Decoder : xm::NonCopyable {
+        /** -huge-pages only, declared before codecCtx, outlive it. */
+        std::optional<HugeFramePool> framePool;
+        std::unique_ptr<AVCodecContext, AVCodecContextDeleter> codecCtx;
+        /**
+         * when pts == -1 the frame not output image(it only contain config information),
+         * we cache it until image frame come in, then merge together to decode.
+         */
+        std::unique_ptr<AVPacket, AVPacketDeleter> cachePacket;
 
-    // ----
+        /** visibility applied to decoder. */
+        bool hiddenApplied = false;
+        /** references dropped while hidden, skip until key frame. */
+        bool waitKeyFrame = false;
+        /** epoch of last decoded net-frame. */
+        uint32_t epoch = 0;
+
+        /** image bytes of last decoded frame, budget estimate of next frame. */
+        int64_t frameBytes = 0;
+
+        std::optional<PaintFrame> paintFramePool[PAINT_FRAME_POOL_CAPACITY];
+
+        std::mutex lock;
+        /** created paint-frames, guard by lock. */
+        int poolSize = 0;
+        /** pending net-frame, use as decode src, guard by lock. */
+        std::deque<NetFrame*> pendingNetFrames;
+        /** free paint-frame, use as decode dst, guard by lock. */
+        xm::Array<PaintFrame*> freePaintFrames;
+    };
+
+    void startWorkers();
+
+    /** create paint-frame of session, return false if pool full, lock held. */
+    bool growPool(Decoder& d, int session);
+
+    /** free paint-frame as decode dst, nullptr if exhausted or over memory budget, lock held. */
+    PaintFrame* obtainPaintFrame(Decoder& d, int session);
 
-    bool mClose = false;
+    /** decode up to SLICE_FRAMES frames of session, return true if may have more. */
+    bool decodeSlice(int session);
 
-    std::optional<std::thread> mThread;
+    /** apply visibility change to decoder skip frame, on decode thread. */
+    void updateSkipFrame(Decoder& decoder);
+
+    // ----
+
+    /** decode error, stop decode and wait close. */
+    std::atomic<bool> mFailed = false;
+    int mSessionCount = 1;
+    int mWorkerCount = 1;
+    int mPriorities[MAX_SESSION] = {};
 
     const AVCodec* mCodec = nullptr;
-    std::unique_ptr<AVCodecContext, AVCodecContextDeleter> mCodecCtx;
 
-    std::optional<PaintFrame> mPaintFramePool[PAINT_FRAME_POOL_CAPACITY];
+    std::atomic<bool> mHidden = false;
+    std::atomic<uint64_t> mDroppedFrames = 0;
+
+    /** pool grow when blocked, only auto size with pts sync. */
+    bool mPoolGrow = false;
+    int64_t mMemoryBudget = 0;
+    /** image bytes held by paint-frames of all sessions. */
+    std::atomic<int64_t> mResidentBytes = 0;
+    std::atomic<int64_t> mPeakResidentBytes = 0;
 
-    /** pending net-frame, use as decode src. */
-    BlockingQueue<NetFrame*> mPendingNetFrames;
-    /** free paint-frame, use as decode dst. */
-    BlockingQueue<PaintFrame*> mFreePaintFrames;
+    std::optional<Decoder> mDecoders[MAX_SESSION];
+    /** declared after decoders, workers stop before decoders destroyed. */
+    std::optional<SessionScheduler> mScheduler;
 };
 }  // namespace ss
@@ -0,0 +1,224 @@
+#pragma once
+#include <xm/PlatformDefine.hpp>
+#include <xm/Array.hpp>
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #include <emmintrin.h>
+    #define SS_TILE_HASH_SSE2
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+    #include <arm_neon.h>
+    #define SS_TILE_HASH_NEON
+#endif
+
+namespace ss {
+/**
+ * hash of image rect, use for detect changed region between frames.
+ * accumulate 16 bytes per step as 2 x 64bit lanes(like xxh3), sse2/neon/scalar give same result.
+ */
+struct TileHash {
+    /** hash rect of `widthBytes` x `height`, `linesize` is bytes between rows. */
+    static uint64_t Hash(const uint8_t* data, size_t linesize, size_t widthBytes, size_t height) {
+#if defined(SS_TILE_HASH_SSE2)
+        __m128i acc = _mm_set_epi64x((long long)PRIME_2, (long long)PRIME_1);
+        for (size_t y = 0; y < height; ++y) {
+            const uint8_t* row = data + y * linesize;
+            uint64_t k = RowKey(y);
+            __m128i key = _mm_set_epi64x((long long)(k ^ PRIME_3), (long long)k);
+            size_t x = 0;
+            for (; x + 16 <= widthBytes; x += 16) {
+                acc = AccumulateSse2(acc, _mm_loadu_si128((const __m128i*)(row + x)), key);
+            }
+            if (x < widthBytes) {
+                alignas(16) uint8_t tail[16] = {};
+                ::memcpy(tail, row + x, widthBytes - x);
+                acc = AccumulateSse2(acc, _mm_load_si128((const __m128i*)tail), key);
+            }
+        }
+        alignas(16) uint64_t lanes[2];
+        _mm_store_si128((__m128i*)lanes, acc);
+        return Finalize(lanes[0], lanes[1], widthBytes, height);
+#elif defined(SS_TILE_HASH_NEON)
+        uint64x2_t acc = vcombine_u64(vcreate_u64(PRIME_1), vcreate_u64(PRIME_2));
+        for (size_t y = 0; y < height; ++y) {
+            const uint8_t* row = data + y * linesize;
+            uint64_t k = RowKey(y);
+            uint64x2_t key = vcombine_u64(vcreate_u64(k), vcreate_u64(k ^ PRIME_3));
+            size_t x = 0;
+            for (; x + 16 <= widthBytes; x += 16) {
+                acc = AccumulateNeon(acc, vreinterpretq_u64_u8(vld1q_u8(row + x)), key);
+            }
+            if (x < widthBytes) {
+                alignas(16) uint8_t tail[16] = {};
+                ::memcpy(tail, row + x, widthBytes - x);
+                acc = AccumulateNeon(acc, vreinterpretq_u64_u8(vld1q_u8(tail)), key);
+            }
+        }
+        return Finalize(vgetq_lane_u64(acc, 0), vgetq_lane_u64(acc, 1), widthBytes, height);
+#else
+        return HashScalar(data, linesize, widthBytes, height);
+#endif
+    }
+
+    /** portable version of `Hash`, same result. */
+    static uint64_t HashScalar(
+        const uint8_t* data, size_t linesize, size_t widthBytes, size_t height) {
+        uint64_t acc[2] = {PRIME_1, PRIME_2};
+        for (size_t y = 0; y < height; ++y) {
+            const uint8_t* row = data + y * linesize;
+            uint64_t k = RowKey(y);
+            uint64_t key[2] = {k, k ^ PRIME_3};
+            size_t x = 0;
+            for (; x + 16 <= widthBytes; x += 16) {
+                AccumulateScalar(acc, row + x, key);
+            }
+            if (x < widthBytes) {
+                uint8_t tail[16] = {};
+                ::memcpy(tail, row + x, widthBytes - x);
+                AccumulateScalar(acc, tail, key);
+            }
+        }
+        return Finalize(acc[0], acc[1], widthBytes, height);
+    }
+
+private:
+    static constexpr uint64_t PRIME_1 = 0x9E3779B185EBCA87ULL;
+    static constexpr uint64_t PRIME_2 = 0xC2B2AE3D27D4EB4FULL;
+    static constexpr uint64_t PRIME_3 = 0x165667B19E3779F9ULL;
+
+    static uint64_t RowKey(size_t y) {
+        return PRIME_2 ^ ((uint64_t)(y + 1) * PRIME_1);
+    }
+
+    static uint64_t Finalize(uint64_t a, uint64_t b, size_t widthBytes, size_t height) {
+        uint64_t h = a ^ ((b << 31) | (b >> 33)) ^ ((uint64_t)widthBytes << 32) ^ height;
+        h ^= h >> 33;
+        h *= PRIME_2;
+        h ^= h >> 29;
+        h *= PRIME_3;
+        h ^= h >> 32;
+        return h;
+    }
+
+    /** acc[i] += data[i ^ 1] + lo32(data[i] ^ key[i]) * hi32(data[i] ^ key[i]). */
+    static void AccumulateScalar(uint64_t acc[2], const uint8_t* p, const uint64_t key[2]) {
+        uint64_t d[2];
+        ::memcpy(d, p, 16);
+        for (int i = 0; i < 2; ++i) {
+            uint64_t dk = d[i] ^ key[i];
+            acc[i] += d[i ^ 1] + (dk & 0xFFFFFFFFULL) * (dk >> 32);
+        }
+    }
+
+#if defined(SS_TILE_HASH_SSE2)
+    XM_FORCE_INLINE static __m128i AccumulateSse2(__m128i acc, __m128i d, __m128i key) {
+        __m128i dk = _mm_xor_si128(d, key);
+        __m128i dkHi = _mm_shuffle_epi32(dk, _MM_SHUFFLE(0, 3, 0, 1));
+        __m128i product = _mm_mul_epu32(dk, dkHi);
+        __m128i dSwap = _mm_shuffle_epi32(d, _MM_SHUFFLE(1, 0, 3, 2));
+        return _mm_add_epi64(acc, _mm_add_epi64(product, dSwap));
+    }
+#endif
+
+#if defined(SS_TILE_HASH_NEON)
+    XM_FORCE_INLINE static uint64x2_t AccumulateNeon(uint64x2_t acc, uint64x2_t d, uint64x2_t key) {
+        uint64x2_t dk = veorq_u64(d, key);
+        uint64x2_t product = vmull_u32(vmovn_u64(dk), vshrn_n_u64(dk, 32));
+        uint64x2_t dSwap = vextq_u64(d, d, 1);
+        return vaddq_u64(acc, vaddq_u64(product, dSwap));
+    }
+#endif
+};
+
+/**
+ * track changed tiles of one image plane between frames.
+ *
+ * usage:
+ * @code
+ * DirtyTiles tiles;
+ * uint32_t n = tiles.update(data, linesize, w, h, 1);
+ * for (uint32_t r = 0; r < tiles.rows(); ++r)
+ *     for (uint32_t c = 0; c < tiles.cols(); ++c)
+ *         if (tiles.dirty(c, r))
+ *             upload(c * DirtyTiles::TILE_SIZE, r * DirtyTiles::TILE_SIZE, ...);
+ * @endcode
+ */
+class DirtyTiles {
+public:
+    enum : uint32_t {
+        TILE_SIZE = 64,
+    };
+
+    /** forget previous frame, next `update` mark all tiles dirty. */
+    void reset() {
+        mValid = false;
+    }
+
+    /**
+     * hash all tiles of plane(`w` x `h` pixels), mark tile dirty if changed since last update,
+     * return dirty tile count.
+     */
+    uint32_t update(
+        const uint8_t* data, size_t linesize, uint32_t w, uint32_t h, uint32_t bytesPerPixel) {
+        if (w != mWidth || h != mHeight) {
+            mWidth = w;
+            mHeight = h;
+            mCols = (w + TILE_SIZE - 1) / TILE_SIZE;
+            mRows = (h + TILE_SIZE - 1) / TILE_SIZE;
+            mHashes.assign((size_t)mCols * mRows, 0);
+            mDirty.assign((size_t)mCols * mRows, 1);
+            mValid = false;
+        }
+
+        uint32_t dirtyCount = 0;
+        for (uint32_t r = 0; r < mRows; ++r) {
+            uint32_t y = r * TILE_SIZE;
+            uint32_t th = std::min<uint32_t>(TILE_SIZE, h - y);
+            for (uint32_t c = 0; c < mCols; ++c) {
+                uint32_t x = c * TILE_SIZE;
+                uint32_t tw = std::min<uint32_t>(TILE_SIZE, w - x);
+                uint64_t hash = TileHash::Hash(
+                    data + y * linesize + (size_t)x * bytesPerPixel,
+                    linesize,
+                    (size_t)tw * bytesPerPixel,
+                    th);
+                size_t i = (size_t)r * mCols + c;
+                bool dirty = !mValid || mHashes[i] != hash;
+                mHashes[i] = hash;
+                mDirty[i] = dirty ? 1 : 0;
+                dirtyCount += dirty ? 1 : 0;
+            }
+        }
+        mValid = true;
+        return dirtyCount;
+    }
+
+    uint32_t cols() const {
+        return mCols;
+    }
+
+    uint32_t rows() const {
+        return mRows;
+    }
+
+    uint32_t count() const {
+        return mCols * mRows;
+    }
+
+    bool dirty(uint32_t col, uint32_t row) const {
+        return mDirty[(size_t)row * mCols + col] != 0;
+    }
+
+private:
+    bool mValid = false;
+    uint32_t mWidth = 0;
+    uint32_t mHeight = 0;
+    uint32_t mCols = 0;
+    uint32_t mRows = 0;
+    xm::Array<uint64_t> mHashes;
+    xm::Array<uint8_t> mDirty;
+};
+}  // namespace ss
@@ -0,0 +1,115 @@
+#pragma once
+#include <ss/Common.hpp>
+
+// gl 3.x/4.x enums miss in glad(generate for gl 2.1).
+#ifndef GL_RG
+    #define GL_RG 0x8227
+#endif
+#ifndef GL_R8
+    #define GL_R8 0x8229
+#endif
+#ifndef GL_R16
+    #define GL_R16 0x822A
+#endif
+#ifndef GL_RG8
+    #define GL_RG8 0x822B
+#endif
+#ifndef GL_RG16
+    #define GL_RG16 0x822C
+#endif
+#ifndef GL_NUM_EXTENSIONS
+    #define GL_NUM_EXTENSIONS 0x821D
+#endif
+#ifndef GL_CONTEXT_PROFILE_MASK
+    #define GL_CONTEXT_PROFILE_MASK 0x9126
+#endif
+#ifndef GL_CONTEXT_CORE_PROFILE_BIT
+    #define GL_CONTEXT_CORE_PROFILE_BIT 0x00000001
+#endif
+
+namespace ss {
+/**
+ * gl 3.x/4.x entry points miss in glad, `Load` after context current(same place as
+ * `gladLoadGL`), entry is nullptr if not supported.
+ */
+struct GlExt {
+    using PFNGETSTRINGI = const GLubyte*(GLAD_API_PTR*)(GLenum name, GLuint index);
+    using PFNGENVERTEXARRAYS = void(GLAD_API_PTR*)(GLsizei n, GLuint* arrays);
+    using PFNDELETEVERTEXARRAYS = void(GLAD_API_PTR*)(GLsizei n, const GLuint* arrays);
+    using PFNBINDVERTEXARRAY = void(GLAD_API_PTR*)(GLuint array);
+    using PFNTEXSTORAGE2D = void(GLAD_API_PTR*)(
+        GLenum target, GLsizei levels, GLenum internalformat, GLsizei width, GLsizei height);
+
+    static inline int Major = 0;
+    static inline int Minor = 0;
+    /** whether context is core profile. */
+    static inline bool Core = false;
+
+    static inline PFNGETSTRINGI GetStringi = nullptr;
+    static inline PFNGENVERTEXARRAYS GenVertexArrays = nullptr;
+    static inline PFNDELETEVERTEXARRAYS DeleteVertexArrays = nullptr;
+    static inline PFNBINDVERTEXARRAY BindVertexArray = nullptr;
+    /** gl 4.2 or 'GL_ARB_texture_storage'. */
+    static inline PFNTEXSTORAGE2D TexStorage2D = nullptr;
+
+    static void Load(GLADloadfunc load) {
+        // glad(gl 2.1) query extensions by glGetString(GL_EXTENSIONS), it is invalid in core
+        // profile, drop the error.
+        (void)glGetError();
+
+        const char* version = (const char*)glGetString(GL_VERSION);
+        Major = 0;
+        Minor = 0;
+        (void)::sscanf(version ? version : "", "%d.%d", &Major, &Minor);
+
+        Core = false;
+        GetStringi = nullptr;
+        GenVertexArrays = nullptr;
+        DeleteVertexArrays = nullptr;
+        BindVertexArray = nullptr;
+        TexStorage2D = nullptr;
+
+        if (Major >= 3) {
+            GetStringi = (PFNGETSTRINGI)load("glGetStringi");
+            GenVertexArrays = (PFNGENVERTEXARRAYS)load("glGenVertexArrays");
+            DeleteVertexArrays = (PFNDELETEVERTEXARRAYS)load("glDeleteVertexArrays");
+            BindVertexArray = (PFNBINDVERTEXARRAY)load("glBindVertexArray");
+        }
+        if (Major > 3 || (Major == 3 && Minor >= 2)) {
+            GLint mask = 0;
+            glGetIntegerv(GL_CONTEXT_PROFILE_MASK, &mask);
+            Core = (mask & GL_CONTEXT_CORE_PROFILE_BIT) != 0;
+        }
+        if (Major > 4 || (Major == 4 && Minor >= 2) || HasExtension("GL_ARB_texture_storage")) {
+            TexStorage2D = (PFNTEXSTORAGE2D)load("glTexStorage2D");
+        }
+    }
+
+    static bool IsVersion(int major, int minor) {
+        return Major > major || (Major == major && Minor >= minor);
+    }
+
+    static bool HasExtension(const char* name) {
+        if (GetStringi) {
+            GLint n = 0;
+            glGetIntegerv(GL_NUM_EXTENSIONS, &n);
+            for (GLint i = 0; i < n; ++i) {
+                const char* ext = (const char*)GetStringi(GL_EXTENSIONS, (GLuint)i);
+                if (ext && ::strcmp(ext, name) == 0) {
+                    return true;
+                }
+            }
+            return false;
+        }
+        // legacy, space separated list.
+        const char* exts = (const char*)glGetString(GL_EXTENSIONS);
+        size_t len = ::strlen(name);
+        for (const char* p = exts; p && (p = ::strstr(p, name)) != nullptr; p += len) {
+            if ((p == exts || p[-1] == ' ') && (p[len] == ' ' || p[len] == '\0')) {
+                return true;
+            }
+        }
+        return false;
+    }
+};
+}  // namespace ss
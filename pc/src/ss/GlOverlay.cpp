@@ -0,0 +1,361 @@
+#include <ss/GlOverlay.hpp>
+#include <ss/Trace.hpp>
+
+namespace ss {
+namespace {
+enum : GLuint {
+    ATTRIB_POS = 0,
+    ATTRIB_UV = 1,
+    ATTRIB_COLOR = 2,
+};
+
+constexpr const char* VS_PREFIX_LEGACY = R"(
+#define IN attribute
+#define OUT varying
+)";
+
+constexpr const char* VS_PREFIX_MODERN = R"(#version 150
+#define IN in
+#define OUT out
+)";
+
+constexpr const char* FS_PREFIX_LEGACY = R"(
+#define IN varying
+#define TEXTURE texture2D
+#define FRAG_COLOR gl_FragColor
+)";
+
+constexpr const char* FS_PREFIX_MODERN = R"(#version 150
+#define IN in
+#define TEXTURE texture
+#define FRAG_COLOR fragColor
+out vec4 fragColor;
+)";
+
+// position in window pixels, top-left origin.
+constexpr const char* VS = R"(
+IN vec2 iPos;
+IN vec2 iUv;
+IN vec4 iColor;
+uniform vec2 viewSize;
+OUT vec2 uv;
+OUT vec4 color;
+void main() {
+    gl_Position = vec4(iPos.x / viewSize.x * 2.0 - 1.0, 1.0 - iPos.y / viewSize.y * 2.0, 0.0, 1.0);
+    uv = iUv;
+    color = iColor;
+})";
+
+// atlas is coverage in red(modern) or luminance(legacy).
+constexpr const char* FS = R"(
+IN vec2 uv;
+IN vec4 color;
+uniform sampler2D texFont;
+void main() {
+    FRAG_COLOR = vec4(color.rgb, color.a * TEXTURE(texFont, uv).r);
+})";
+
+constexpr uint32_t COLOR_BACKGROUND = 0x000000b0;
+constexpr uint32_t COLOR_TEXT = 0xffffffff;
+constexpr uint32_t COLOR_GRAPH_GOOD = 0x40e040ff;
+constexpr uint32_t COLOR_GRAPH_SLOW = 0xe0e040ff;
+constexpr uint32_t COLOR_GRAPH_BAD = 0xe04040ff;
+constexpr uint32_t COLOR_GRAPH_LINE = 0xffffff80;
+/** inner space of background. */
+constexpr float PADDING = 6.0f;
+}  // namespace
+
+GlOverlay::GlOverlay() {
+    mModern = !Config::Singleton()->glLegacy && GlExt::IsVersion(3, 2) &&
+              GlExt::GenVertexArrays && GlExt::BindVertexArray;
+
+    GLint result = GL_FALSE;
+    mVs.emplace(GlRender::CompileShader(
+        GL_VERTEX_SHADER, mModern ? VS_PREFIX_MODERN : VS_PREFIX_LEGACY, VS, "overlay vs"));
+    mFs.emplace(GlRender::CompileShader(
+        GL_FRAGMENT_SHADER, mModern ? FS_PREFIX_MODERN : FS_PREFIX_LEGACY, FS, "overlay fs"));
+    GLuint _program = glCreateProgram();
+    SS_THROW(_program, "create gl program fail");
+    mProgram.emplace(_program);
+    glAttachShader(mProgram->id(), mVs->id());
+    glAttachShader(mProgram->id(), mFs->id());
+    glBindAttribLocation(mProgram->id(), ATTRIB_POS, "iPos");
+    glBindAttribLocation(mProgram->id(), ATTRIB_UV, "iUv");
+    glBindAttribLocation(mProgram->id(), ATTRIB_COLOR, "iColor");
+    glLinkProgram(mProgram->id());
+    glGetProgramiv(mProgram->id(), GL_LINK_STATUS, &result);
+    SS_THROW(result != GL_FALSE, "link gl overlay program fail");
+    glUseProgram(mProgram->id());
+    glUniform1i(glGetUniformLocation(mProgram->id(), "texFont"), 0);
+    mLocViewSize = glGetUniformLocation(mProgram->id(), "viewSize");
+
+    GLuint _vbo = 0;
+    glGenBuffers(1, &_vbo);
+    SS_THROW(_vbo, "create gl buffer fail");
+    mVbo.emplace(_vbo);
+    if (mModern) {
+        GLuint _vao = 0;
+        GlExt::GenVertexArrays(1, &_vao);
+        SS_THROW(_vao, "create gl vertex array fail");
+        mVao.emplace(_vao);
+    }
+    // attribute pointers in own vao(modern), or set every paint(legacy).
+    bindState();
+
+    // rows of 5 bits, msb is left column, index by ascii - GLYPH_FIRST.
+    static const uint8_t FONT[GLYPH_COUNT][GLYPH_H] = {
+        {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},  // ' '
+        {0x04, 0x04, 0x04, 0x04, 0x04, 0x00, 0x04},  // '!'
+        {0x0A, 0x0A, 0x0A, 0x00, 0x00, 0x00, 0x00},  // '"'
+        {0x0A, 0x0A, 0x1F, 0x0A, 0x1F, 0x0A, 0x0A},  // '#'
+        {0x04, 0x0F, 0x14, 0x0E, 0x05, 0x1E, 0x04},  // '$'
+        {0x18, 0x19, 0x02, 0x04, 0x08, 0x13, 0x03},  // '%'
+        {0x0C, 0x12, 0x14, 0x08, 0x15, 0x12, 0x0D},  // '&'
+        {0x0C, 0x04, 0x08, 0x00, 0x00, 0x00, 0x00},  // '\''
+        {0x02, 0x04, 0x08, 0x08, 0x08, 0x04, 0x02},  // '('
+        {0x08, 0x04, 0x02, 0x02, 0x02, 0x04, 0x08},  // ')'
+        {0x00, 0x04, 0x15, 0x0E, 0x15, 0x04, 0x00},  // '*'
+        {0x00, 0x04, 0x04, 0x1F, 0x04, 0x04, 0x00},  // '+'
+        {0x00, 0x00, 0x00, 0x00, 0x0C, 0x04, 0x08},  // ','
+        {0x00, 0x00, 0x00, 0x1F, 0x00, 0x00, 0x00},  // '-'
+        {0x00, 0x00, 0x00, 0x00, 0x00, 0x0C, 0x0C},  // '.'
+        {0x00, 0x01, 0x02, 0x04, 0x08, 0x10, 0x00},  // '/'
+        {0x0E, 0x11, 0x13, 0x15, 0x19, 0x11, 0x0E},  // '0'
+        {0x04, 0x0C, 0x04, 0x04, 0x04, 0x04, 0x0E},  // '1'
+        {0x0E, 0x11, 0x01, 0x02, 0x04, 0x08, 0x1F},  // '2'
+        {0x1F, 0x02, 0x04, 0x02, 0x01, 0x11, 0x0E},  // '3'
+        {0x02, 0x06, 0x0A, 0x12, 0x1F, 0x02, 0x02},  // '4'
+        {0x1F, 0x10, 0x1E, 0x01, 0x01, 0x11, 0x0E},  // '5'
+        {0x06, 0x08, 0x10, 0x1E, 0x11, 0x11, 0x0E},  // '6'
+        {0x1F, 0x01, 0x02, 0x04, 0x08, 0x08, 0x08},  // '7'
+        {0x0E, 0x11, 0x11, 0x0E, 0x11, 0x11, 0x0E},  // '8'
+        {0x0E, 0x11, 0x11, 0x0F, 0x01, 0x02, 0x0C},  // '9'
+        {0x00, 0x0C, 0x0C, 0x00, 0x0C, 0x0C, 0x00},  // ':'
+        {0x00, 0x0C, 0x0C, 0x00, 0x0C, 0x04, 0x08},  // ';'
+        {0x02, 0x04, 0x08, 0x10, 0x08, 0x04, 0x02},  // '<'
+        {0x00, 0x00, 0x1F, 0x00, 0x1F, 0x00, 0x00},  // '='
+        {0x08, 0x04, 0x02, 0x01, 0x02, 0x04, 0x08},  // '>'
+        {0x0E, 0x11, 0x01, 0x02, 0x04, 0x00, 0x04},  // '?'
+        {0x0E, 0x11, 0x01, 0x0D, 0x15, 0x15, 0x0E},  // '@'
+        {0x0E, 0x11, 0x11, 0x11, 0x1F, 0x11, 0x11},  // 'A'
+        {0x1E, 0x11, 0x11, 0x1E, 0x11, 0x11, 0x1E},  // 'B'
+        {0x0E, 0x11, 0x10, 0x10, 0x10, 0x11, 0x0E},  // 'C'
+        {0x1C, 0x12, 0x11, 0x11, 0x11, 0x12, 0x1C},  // 'D'
+        {0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x1F},  // 'E'
+        {0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x10},  // 'F'
+        {0x0E, 0x11, 0x10, 0x17, 0x11, 0x11, 0x0F},  // 'G'
+        {0x11, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11},  // 'H'
+        {0x0E, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0E},  // 'I'
+        {0x07, 0x02, 0x02, 0x02, 0x02, 0x12, 0x0C},  // 'J'
+        {0x11, 0x12, 0x14, 0x18, 0x14, 0x12, 0x11},  // 'K'
+        {0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x1F},  // 'L'
+        {0x11, 0x1B, 0x15, 0x15, 0x11, 0x11, 0x11},  // 'M'
+        {0x11, 0x11, 0x19, 0x15, 0x13, 0x11, 0x11},  // 'N'
+        {0x0E, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E},  // 'O'
+        {0x1E, 0x11, 0x11, 0x1E, 0x10, 0x10, 0x10},  // 'P'
+        {0x0E, 0x11, 0x11, 0x11, 0x15, 0x12, 0x0D},  // 'Q'
+        {0x1E, 0x11, 0x11, 0x1E, 0x14, 0x12, 0x11},  // 'R'
+        {0x0F, 0x10, 0x10, 0x0E, 0x01, 0x01, 0x1E},  // 'S'
+        {0x1F, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04},  // 'T'
+        {0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E},  // 'U'
+        {0x11, 0x11, 0x11, 0x11, 0x11, 0x0A, 0x04},  // 'V'
+        {0x11, 0x11, 0x11, 0x15, 0x15, 0x15, 0x0A},  // 'W'
+        {0x11, 0x11, 0x0A, 0x04, 0x0A, 0x11, 0x11},  // 'X'
+        {0x11, 0x11, 0x11, 0x0A, 0x04, 0x04, 0x04},  // 'Y'
+        {0x1F, 0x01, 0x02, 0x04, 0x08, 0x10, 0x1F},  // 'Z'
+        {0x0E, 0x08, 0x08, 0x08, 0x08, 0x08, 0x0E},  // '['
+        {0x00, 0x10, 0x08, 0x04, 0x02, 0x01, 0x00},  // '\\'
+        {0x0E, 0x02, 0x02, 0x02, 0x02, 0x02, 0x0E},  // ']'
+        {0x04, 0x0A, 0x11, 0x00, 0x00, 0x00, 0x00},  // '^'
+        {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1F},  // '_'
+    };
+
+    // one cell per glyph, last cell solid.
+    xm::Array<uint8_t> pixels((size_t)ATLAS_W * ATLAS_H);
+    ::memset(pixels.data(), 0, pixels.size());
+    for (int i = 0; i <= GLYPH_COUNT; ++i) {
+        for (int y = 0; y < GLYPH_H; ++y) {
+            for (int x = 0; x < GLYPH_W; ++x) {
+                bool set = i == SOLID_GLYPH || ((FONT[i][y] >> (GLYPH_W - 1 - x)) & 1);
+                pixels[(size_t)y * ATLAS_W + i * CELL_W + x] = set ? 0xff : 0;
+            }
+        }
+    }
+    GLuint _atlas = 0;
+    glGenTextures(1, &_atlas);
+    SS_THROW(_atlas, "create gl texture fail");
+    mAtlas.emplace(_atlas);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, mAtlas->id());
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    // render upload leave row length of frame plane.
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    glTexImage2D(
+        GL_TEXTURE_2D,
+        0,
+        mModern ? GL_R8 : GL_LUMINANCE,
+        ATLAS_W,
+        ATLAS_H,
+        0,
+        mModern ? GL_RED : GL_LUMINANCE,
+        GL_UNSIGNED_BYTE,
+        pixels.data());
+    unbindState();
+
+    setStats({});
+    Log::I("gl overlay: %s", mModern ? "modern" : "legacy");
+}
+
+void GlOverlay::setStats(const Stats& stats) {
+    char lines[5][64];
+    snprintf(lines[0], sizeof(lines[0]), "FPS %u  %.2f MBPS", stats.fps, stats.mbps);
+    snprintf(
+        lines[1],
+        sizeof(lines[1]),
+        "DECODE %.2f  PAINT %.2f  SWAP %.2f MS",
+        stats.decodeMs,
+        stats.paintMs,
+        stats.swapMs);
+    snprintf(
+        lines[2],
+        sizeof(lines[2]),
+        "LATENCY %.1f  MAX %.1f MS",
+        stats.latencyMs,
+        stats.latencyMaxMs);
+    snprintf(
+        lines[3],
+        sizeof(lines[3]),
+        "DROP DECODE %llu  PRESENT %llu",
+        (unsigned long long)stats.decodeDrops,
+        (unsigned long long)stats.presentDrops);
+    snprintf(lines[4], sizeof(lines[4]), "FRAME TIME 0-%d MS", (int)GRAPH_MAX_MS);
+
+    // background first, cover text and graph.
+    mTextVertices.clear();
+    AddRect(mTextVertices, 0.0f, 0.0f, 0.0f, 0.0f, COLOR_BACKGROUND);
+    float x = MARGIN + PADDING;
+    float y = MARGIN + PADDING;
+    float w = GRAPH_FRAMES * GRAPH_BAR_W;
+    for (const char* line : lines) {
+        w = std::max(w, AddText(mTextVertices, x, y, line, COLOR_TEXT));
+        y += LINE_H;
+    }
+    mTextH = y - (MARGIN + PADDING);
+
+    float h = mTextH + GRAPH_H;
+    Vertex* bg = mTextVertices.data();
+    float x0 = MARGIN;
+    float y0 = MARGIN;
+    float x1 = MARGIN + w + 2 * PADDING;
+    float y1 = MARGIN + h + 2 * PADDING;
+    float corners[6][2] = {{x0, y0}, {x1, y0}, {x0, y1}, {x1, y0}, {x1, y1}, {x0, y1}};
+    for (int i = 0; i < 6; ++i) {
+        bg[i].x = corners[i][0];
+        bg[i].y = corners[i][1];
+    }
+}
+
+void GlOverlay::paint(int winW, int winH) {
+    TraceZone zone("overlay paint");
+    mVertices.assign(mTextVertices.begin(), mTextVertices.end());
+
+    // oldest at left.
+    float gx = MARGIN + PADDING;
+    float gy = MARGIN + PADDING + mTextH;
+    for (int i = 0; i < GRAPH_FRAMES; ++i) {
+        float ms = mFrameTimes[(mFrameTimeIndex + i) % GRAPH_FRAMES];
+        float h = std::min(ms / GRAPH_MAX_MS, 1.0f) * GRAPH_H;
+        uint32_t color = ms <= 20.0f   ? COLOR_GRAPH_GOOD
+                         : ms <= 34.0f ? COLOR_GRAPH_SLOW
+                                       : COLOR_GRAPH_BAD;
+        AddRect(mVertices, gx + i * GRAPH_BAR_W, gy + GRAPH_H - h, GRAPH_BAR_W, h, color);
+    }
+    // 60 fps reference.
+    float lineY = gy + GRAPH_H - (1000.0f / 60.0f) / GRAPH_MAX_MS * GRAPH_H;
+    AddRect(mVertices, gx, lineY, GRAPH_FRAMES * GRAPH_BAR_W, 1.0f, COLOR_GRAPH_LINE);
+
+    bindState();
+    glViewport(0, 0, winW, winH);
+    glScissor(0, 0, winW, winH);
+    glUniform2f(mLocViewSize, (GLfloat)winW, (GLfloat)winH);
+    glBufferData(
+        GL_ARRAY_BUFFER, mVertices.size() * sizeof(Vertex), mVertices.data(), GL_STREAM_DRAW);
+    glDrawArrays(GL_TRIANGLES, 0, (GLsizei)mVertices.size());
+    unbindState();
+}
+
+void GlOverlay::AddQuad(
+    xm::Array<Vertex>& out, float x, float y, float w, float h, int glyph, uint32_t rgba) {
+    float u0 = (float)(glyph * CELL_W) / ATLAS_W;
+    float u1 = (float)(glyph * CELL_W + GLYPH_W) / ATLAS_W;
+    float v0 = 0.0f;
+    float v1 = (float)GLYPH_H / ATLAS_H;
+    if (glyph == SOLID_GLYPH) {
+        // sample cell center, any size of rect.
+        u0 = u1 = (glyph * CELL_W + GLYPH_W * 0.5f) / ATLAS_W;
+        v0 = v1 = GLYPH_H * 0.5f / ATLAS_H;
+    }
+    uint8_t r = (uint8_t)(rgba >> 24);
+    uint8_t g = (uint8_t)(rgba >> 16);
+    uint8_t b = (uint8_t)(rgba >> 8);
+    uint8_t a = (uint8_t)rgba;
+    Vertex v[4] = {
+        {x, y, u0, v0, {r, g, b, a}},
+        {x + w, y, u1, v0, {r, g, b, a}},
+        {x, y + h, u0, v1, {r, g, b, a}},
+        {x + w, y + h, u1, v1, {r, g, b, a}},
+    };
+    for (int i : {0, 1, 2, 1, 3, 2}) {
+        out.push_back(v[i]);
+    }
+}
+
+float GlOverlay::AddText(
+    xm::Array<Vertex>& out, float x, float y, const char* text, uint32_t rgba) {
+    float x0 = x;
+    for (const char* c = text; *c; ++c) {
+        int ch = *c >= 'a' && *c <= 'z' ? *c - 'a' + 'A' : *c;
+        if (ch < GLYPH_FIRST || ch >= GLYPH_FIRST + GLYPH_COUNT) {
+            ch = '?';
+        }
+        if (ch != ' ') {
+            AddQuad(out, x, y, GLYPH_W * SCALE, GLYPH_H * SCALE, ch - GLYPH_FIRST, rgba);
+        }
+        x += CELL_W * SCALE;
+    }
+    return x - x0;
+}
+
+void GlOverlay::bindState() {
+    if (mModern) {
+        GlExt::BindVertexArray(mVao->id());
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, mVbo->id());
+    glVertexAttribPointer(
+        ATTRIB_POS, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, x));
+    glVertexAttribPointer(
+        ATTRIB_UV, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, u));
+    glVertexAttribPointer(
+        ATTRIB_COLOR, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(Vertex), (void*)offsetof(Vertex, color));
+    glEnableVertexAttribArray(ATTRIB_POS);
+    glEnableVertexAttribArray(ATTRIB_UV);
+    glEnableVertexAttribArray(ATTRIB_COLOR);
+    glUseProgram(mProgram->id());
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, mAtlas ? mAtlas->id() : 0);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+}
+
+void GlOverlay::unbindState() {
+    glDisable(GL_BLEND);
+    if (!mModern) {
+        // render's legacy path use default attribute state.
+        glDisableVertexAttribArray(ATTRIB_COLOR);
+    }
+    GlRender::InvalidateBoundState();
+}
+}  // namespace ss
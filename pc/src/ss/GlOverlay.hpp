@@ -0,0 +1,111 @@
+#pragma once
+#include <ss/GlRender.hpp>
+
+namespace ss {
+/**
+ * stats overlay drawn over views in same pass before swap buffers: text by baked 5x7 bitmap
+ * font and frame time graph, one texture and one draw call. text vertices rebuilt only when
+ * stats updated(every second), graph every frame.
+ */
+class GlOverlay : public xm::NonCopyable {
+public:
+    /** average of last second, time in ms. */
+    struct Stats {
+        uint32_t fps = 0;
+        double mbps = 0.0;
+        double decodeMs = 0.0;
+        /** upload and draw call. */
+        double paintMs = 0.0;
+        double swapMs = 0.0;
+        double latencyMs = 0.0;
+        double latencyMaxMs = 0.0;
+        /** accumulated since start. */
+        uint64_t decodeDrops = 0;
+        /** multi session, frames replaced by newer before present. */
+        uint64_t presentDrops = 0;
+    };
+
+    /** gl context must be current, same render path(legacy/modern) as GlRender. */
+    GlOverlay();
+
+    void setStats(const Stats& stats);
+
+    /** interval between presents, newest at right of graph. */
+    void pushFrameTime(chrono::high_resolution_clock::duration interval) {
+        mFrameTimes[mFrameTimeIndex] = chrono::duration<float, std::milli>(interval).count();
+        mFrameTimeIndex = (mFrameTimeIndex + 1) % GRAPH_FRAMES;
+    }
+
+    /** draw at top-left of window, leave viewport/scissor as full window. */
+    void paint(int winW, int winH);
+
+private:
+    enum : int {
+        GLYPH_W = 5,
+        GLYPH_H = 7,
+        /** glyph cell in atlas, 1 pixel blank on right and bottom. */
+        CELL_W = GLYPH_W + 1,
+        CELL_H = GLYPH_H + 1,
+        /** printable ascii ' ' to '_', lower case shown as upper case. */
+        GLYPH_FIRST = 32,
+        GLYPH_COUNT = 64,
+        /** solid cell after glyphs, for rects. */
+        SOLID_GLYPH = GLYPH_COUNT,
+        /** multiple of 4, no unpack alignment change. */
+        ATLAS_W = ((GLYPH_COUNT + 1) * CELL_W + 3) & ~3,
+        ATLAS_H = CELL_H,
+        /** screen pixels per font pixel. */
+        SCALE = 2,
+        LINE_H = (GLYPH_H + 2) * SCALE,
+        MARGIN = 8,
+        GRAPH_FRAMES = 120,
+        GRAPH_BAR_W = 2,
+        GRAPH_H = 60,
+        /** frame time at top of graph. */
+        GRAPH_MAX_MS = 50,
+    };
+
+    struct Vertex {
+        GLfloat x;
+        GLfloat y;
+        GLfloat u;
+        GLfloat v;
+        uint8_t color[4];
+    };
+
+    /** quad of atlas cell, in window pixels, top-left origin. */
+    static void AddQuad(
+        xm::Array<Vertex>& out, float x, float y, float w, float h, int glyph, uint32_t rgba);
+
+    static void AddRect(xm::Array<Vertex>& out, float x, float y, float w, float h, uint32_t rgba) {
+        AddQuad(out, x, y, w, h, SOLID_GLYPH, rgba);
+    }
+
+    /** return width in pixels. */
+    static float AddText(xm::Array<Vertex>& out, float x, float y, const char* text, uint32_t rgba);
+
+    void bindState();
+
+    void unbindState();
+
+    // ----
+
+    bool mModern = false;
+    std::optional<GlRender::RaiiVertexArray> mVao;
+    std::optional<GlRender::RaiiBuffer> mVbo;
+    std::optional<GlRender::RaiiShader> mVs;
+    std::optional<GlRender::RaiiShader> mFs;
+    std::optional<GlRender::RaiiProgram> mProgram;
+    std::optional<GlRender::RaiiImage> mAtlas;
+    GLint mLocViewSize = -1;
+
+    /** text and background, rebuilt by `setStats`. */
+    xm::Array<Vertex> mTextVertices;
+    /** text vertices and graph of current frame. */
+    xm::Array<Vertex> mVertices;
+    /** height of text lines, graph below it. */
+    float mTextH = 0.0f;
+    float mFrameTimes[GRAPH_FRAMES] = {};
+    int mFrameTimeIndex = 0;
+};
+}  // namespace ss
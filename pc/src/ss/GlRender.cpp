@@ -1,184 +1,440 @@
 #include <ss/GlRender.hpp>
+#include <ss/Trace.hpp>
 
 #define GLAD_GL_IMPLEMENTATION
 #include <glad/gl.h>
 
 namespace ss {
-GlRender::GlRender() {
-    GLint result = GL_FALSE;
+namespace {
+enum : GLuint {
+    ATTRIB_POS = 0,
+    ATTRIB_UV = 1,
+};
+
+// shader body share between gl 2.1(glsl 1.10) and gl 3.2+(glsl 1.50) by prefix macros.
+constexpr const char* VS_PREFIX_LEGACY = R"(
+#define IN attribute
+#define OUT varying
+)";
+
+constexpr const char* VS_PREFIX_MODERN = R"(#version 150
+#define IN in
+#define OUT out
+)";
 
-    static constexpr const char* VS = R"(
-attribute vec2 iPos;
-attribute vec2 iUv;
-varying vec2 uv;
+// 2 channels plane upload as luminance-alpha in legacy, rg in modern.
+constexpr const char* FS_PREFIX_LEGACY = R"(
+#define IN varying
+#define TEXTURE texture2D
+#define FRAG_COLOR gl_FragColor
+#define UV_SWIZZLE ra
+)";
+
+constexpr const char* FS_PREFIX_MODERN = R"(#version 150
+#define IN in
+#define TEXTURE texture
+#define FRAG_COLOR fragColor
+#define UV_SWIZZLE rg
+out vec4 fragColor;
+)";
+
+constexpr const char* VS = R"(
+IN vec2 iPos;
+IN vec2 iUv;
+OUT vec2 uv;
 void main() {
     gl_Position = vec4(iPos, 1.0, 1.0);
     uv = iUv;
 })";
-    GLuint _vs = glCreateShader(GL_VERTEX_SHADER);
-    SS_THROW(_vs, "create vs shader fail");
-    mVs.emplace(_vs);
-    glShaderSource(mVs->id(), 1, &VS, NULL);
-    glCompileShader(mVs->id());
-    glGetShaderiv(mVs->id(), GL_COMPILE_STATUS, &result);
-    if (result == GL_FALSE) {
-        GLint errStrLen = 0;
-        glGetShaderiv(mVs->id(), GL_INFO_LOG_LENGTH, &errStrLen);
-        if (errStrLen) {
-            std::string errStr((size_t)errStrLen, 0);
-            glGetShaderInfoLog(mVs->id(), errStrLen, &errStrLen, &errStr[0]);
-            Log::E("compiler output:\n%s", errStr.c_str());
-        }
-        SS_THROW(0, "compile vs fail");
-    }
 
-    static const char* const FS = R"(
-varying vec2 uv;
+constexpr const char* FS_3PLANE = R"(
+IN vec2 uv;
 uniform sampler2D texY;
 uniform sampler2D texU;
 uniform sampler2D texV;
+uniform float sampleScale;
+uniform mat3 yuvMatrix;
+uniform vec3 yuvOffset;
+void main() {
+    vec3 yuv;
+    yuv.x = TEXTURE(texY, uv).r;
+    yuv.y = TEXTURE(texU, uv).r;
+    yuv.z = TEXTURE(texV, uv).r;
+    FRAG_COLOR = vec4(yuvMatrix * (yuv * sampleScale - yuvOffset), 1.0);
+})";
+
+constexpr const char* FS_2PLANE = R"(
+IN vec2 uv;
+uniform sampler2D texY;
+uniform sampler2D texUV;
+uniform float sampleScale;
+uniform mat3 yuvMatrix;
+uniform vec3 yuvOffset;
+void main() {
+    vec3 yuv;
+    yuv.x = TEXTURE(texY, uv).r;
+    yuv.yz = TEXTURE(texUV, uv).UV_SWIZZLE;
+    FRAG_COLOR = vec4(yuvMatrix * (yuv * sampleScale - yuvOffset), 1.0);
+})";
+
+// plane rect xy: offset, zw: size, in texture coordinate.
+constexpr const char* FS_PACKED = R"(
+IN vec2 uv;
+uniform sampler2D texYuv;
+uniform vec4 planeRects[3];
+uniform vec2 halfTexel;
+uniform float sampleScale;
+uniform mat3 yuvMatrix;
+uniform vec3 yuvOffset;
+float samplePlane(vec4 rect) {
+    // clamp inside plane, linear filter not bleed neighbour plane.
+    vec2 p = clamp(rect.xy + uv * rect.zw, rect.xy + halfTexel, rect.xy + rect.zw - halfTexel);
+    return TEXTURE(texYuv, p).r;
+}
 void main() {
-    vec4 yuv;
-    yuv.x = texture2D(texY, uv).x;
-    yuv.y = texture2D(texU, uv).x;
-    yuv.z = texture2D(texV, uv).x;
-    yuv.w = 1.0;
-    mat4 m = mat4(
-        1.0,  0.0,    1.402, -0.701,
-        1.0, -0.344, -0.714,  0.529,
-        1.0,  1.772,  0.0,   -0.886,
-        0.0,  0.0,    0.0,    1.0);
-    gl_FragColor = yuv * m;
+    vec3 yuv;
+    yuv.x = samplePlane(planeRects[0]);
+    yuv.y = samplePlane(planeRects[1]);
+    yuv.z = samplePlane(planeRects[2]);
+    FRAG_COLOR = vec4(yuvMatrix * (yuv * sampleScale - yuvOffset), 1.0);
 })";
-    GLuint _fs = glCreateShader(GL_FRAGMENT_SHADER);
-    SS_THROW(_fs, "create fs shader fail");
-    mFs.emplace(_fs);
-    glShaderSource(mFs->id(), 1, &FS, NULL);
-    glCompileShader(mFs->id());
-    glGetShaderiv(mFs->id(), GL_COMPILE_STATUS, &result);
+}  // namespace
+
+GlRender* GlRender::sBoundRender = nullptr;
+
+GlRender::GlRender() {
+    sBoundRender = this;
+    mModern = !Config::Singleton()->glLegacy && GlExt::IsVersion(3, 2) &&
+              GlExt::GenVertexArrays && GlExt::BindVertexArray;
+    mPacked = Config::Singleton()->glPackedPlanes;
+    Log::I(
+        "gl render: %s, %s profile, immutable texture: %s, packed planes: %s",
+        mModern ? "modern" : "legacy",
+        GlExt::Core ? "core" : "compatibility",
+        mModern && GlExt::TexStorage2D ? "true" : "false",
+        mPacked ? "true" : "false");
+
+    GLuint _vs =
+        CompileShader(GL_VERTEX_SHADER, mModern ? VS_PREFIX_MODERN : VS_PREFIX_LEGACY, VS, "vs");
+    mVs.emplace(_vs);
+
+    // core profile require vao, keep it bound.
+    if (mModern) {
+        GLuint _vao = 0;
+        GlExt::GenVertexArrays(1, &_vao);
+        SS_THROW(_vao, "create gl vertex array fail");
+        mVao.emplace(_vao);
+        GlExt::BindVertexArray(mVao->id());
+    }
+
+    // x, y, u, v.
+    // clang-format off
+    static const GLfloat vertices[] = {
+        -1.0f, -1.0f, 0.0f, 1.0f,
+        1.0f, -1.0f, 1.0f, 1.0f,
+        -1.0f, 1.0f, 0.0f, 0.0f,
+        1.0f, -1.0f, 1.0f, 1.0f,
+        1.0f, 1.0f, 1.0f, 0.0f,
+        -1.0f, 1.0f, 0.0f, 0.0f,
+    };
+    // clang-format on
+    GLuint _vbo = 0;
+    glGenBuffers(1, &_vbo);
+    SS_THROW(_vbo, "create gl buffer fail");
+    mVbo.emplace(_vbo);
+    glBindBuffer(GL_ARRAY_BUFFER, mVbo->id());
+    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+
+    glVertexAttribPointer(ATTRIB_POS, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(GLfloat), (void*)0);
+    glEnableVertexAttribArray(ATTRIB_POS);
+    glVertexAttribPointer(
+        ATTRIB_UV, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(GLfloat), (void*)(2 * sizeof(GLfloat)));
+    glEnableVertexAttribArray(ATTRIB_UV);
+
+    // compile common variant early, report shader error at startup.
+    useProgram(mPacked ? PROGRAM_PACKED : PROGRAM_3PLANE);
+}
+
+const GlRender::FrameFormat* GlRender::FindFrameFormat(int pixFmt) {
+    // 10 bits sample in high bits of 16 bits(p010), or low bits(yuv420p10).
+    static constexpr float P010_SCALE = 65535.0f / (1023.0f * 64.0f);
+    static constexpr float P10_SCALE = 65535.0f / 1023.0f;
+
+    using K = PlaneKind;
+    static const FrameFormat FORMATS[] = {
+        {AV_PIX_FMT_YUV420P, 8, false, 1.0f, 3, {K::R8, K::R8, K::R8}},
+        {AV_PIX_FMT_YUVJ420P, 8, true, 1.0f, 3, {K::R8, K::R8, K::R8}},
+        {AV_PIX_FMT_NV12, 8, false, 1.0f, 2, {K::R8, K::RG8, {}}},
+#if defined(SS_IS_LITTLE)
+        {AV_PIX_FMT_P010LE, 10, false, P010_SCALE, 2, {K::R16, K::RG16, {}}},
+        {AV_PIX_FMT_YUV420P10LE, 10, false, P10_SCALE, 3, {K::R16, K::R16, K::R16}},
+#else
+        {AV_PIX_FMT_P010BE, 10, false, P010_SCALE, 2, {K::R16, K::RG16, {}}},
+        {AV_PIX_FMT_YUV420P10BE, 10, false, P10_SCALE, 3, {K::R16, K::R16, K::R16}},
+#endif
+    };
+
+    for (const FrameFormat& f : FORMATS) {
+        if (f.pixFmt == pixFmt) {
+            return &f;
+        }
+    }
+    return nullptr;
+}
+
+const GlRender::PlaneFormat& GlRender::planeFormat(PlaneKind kind) const {
+    // index by PlaneKind, luminance(-alpha) not exist in core profile.
+    static const PlaneFormat LEGACY[] = {
+        {GL_LUMINANCE, GL_LUMINANCE, GL_UNSIGNED_BYTE, 1},
+        {GL_LUMINANCE_ALPHA, GL_LUMINANCE_ALPHA, GL_UNSIGNED_BYTE, 2},
+        {GL_LUMINANCE16, GL_LUMINANCE, GL_UNSIGNED_SHORT, 2},
+        {GL_LUMINANCE16_ALPHA16, GL_LUMINANCE_ALPHA, GL_UNSIGNED_SHORT, 4},
+    };
+    static const PlaneFormat MODERN[] = {
+        {GL_R8, GL_RED, GL_UNSIGNED_BYTE, 1},
+        {GL_RG8, GL_RG, GL_UNSIGNED_BYTE, 2},
+        {GL_R16, GL_RED, GL_UNSIGNED_SHORT, 2},
+        {GL_RG16, GL_RG, GL_UNSIGNED_SHORT, 4},
+    };
+    return mModern ? MODERN[(int)kind] : LEGACY[(int)kind];
+}
+
+GLuint GlRender::CompileShader(GLenum type, const char* prefix, const char* src, const char* name) {
+    GLint result = GL_FALSE;
+    GLuint shader = glCreateShader(type);
+    SS_THROW(shader, "create %s shader fail", name);
+    const char* srcs[] = {prefix, src};
+    glShaderSource(shader, 2, srcs, NULL);
+    glCompileShader(shader);
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &result);
     if (result == GL_FALSE) {
         GLint errStrLen = 0;
-        glGetShaderiv(mFs->id(), GL_INFO_LOG_LENGTH, &errStrLen);
+        glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &errStrLen);
         if (errStrLen) {
             std::string errStr((size_t)errStrLen, 0);
-            glGetShaderInfoLog(mFs->id(), errStrLen, &errStrLen, &errStr[0]);
+            glGetShaderInfoLog(shader, errStrLen, &errStrLen, &errStr[0]);
             Log::E("compiler output:\n%s", errStr.c_str());
         }
-        SS_THROW(0, "compile fs fail");
+        glDeleteShader(shader);
+        SS_THROW(0, "compile %s fail", name);
     }
+    return shader;
+}
 
-    GLuint _program = glCreateProgram();
-    SS_THROW(_program, "create gl program fail");
-    mProgram.emplace(_program);
-    glAttachShader(mProgram->id(), mVs->id());
-    glAttachShader(mProgram->id(), mFs->id());
-    glLinkProgram(mProgram->id());
-    glGetProgramiv(mProgram->id(), GL_LINK_STATUS, &result);
-    if (result == GL_FALSE) {
-        GLint errStrLen = 0;
-        glGetProgramiv(mProgram->id(), GL_INFO_LOG_LENGTH, &errStrLen);
-        if (errStrLen) {
-            std::string errStr((size_t)errStrLen, 0);
-            glGetProgramInfoLog(mProgram->id(), errStrLen, &errStrLen, &errStr[0]);
-            Log::E("linker output:\n%s", errStr.c_str());
+GlRender::Program& GlRender::useProgram(ProgramKind kind) {
+    Program& p = mPrograms[kind];
+    if (!p.program) {
+        static const char* const FS_SRCS[PROGRAM_COUNT] = {FS_3PLANE, FS_2PLANE, FS_PACKED};
+        static const char* const FS_NAMES[PROGRAM_COUNT] = {
+            "fs(3 planes)", "fs(2 planes)", "fs(packed planes)"};
+        GLint result = GL_FALSE;
+
+        GLuint _fs = CompileShader(
+            GL_FRAGMENT_SHADER,
+            mModern ? FS_PREFIX_MODERN : FS_PREFIX_LEGACY,
+            FS_SRCS[kind],
+            FS_NAMES[kind]);
+        p.fs.emplace(_fs);
+
+        GLuint _program = glCreateProgram();
+        SS_THROW(_program, "create gl program fail");
+        p.program.emplace(_program);
+        glAttachShader(p.program->id(), mVs->id());
+        glAttachShader(p.program->id(), p.fs->id());
+        // all variants share vertex arrays, so fix attribute locations.
+        glBindAttribLocation(p.program->id(), ATTRIB_POS, "iPos");
+        glBindAttribLocation(p.program->id(), ATTRIB_UV, "iUv");
+        glLinkProgram(p.program->id());
+        glGetProgramiv(p.program->id(), GL_LINK_STATUS, &result);
+        if (result == GL_FALSE) {
+            GLint errStrLen = 0;
+            glGetProgramiv(p.program->id(), GL_INFO_LOG_LENGTH, &errStrLen);
+            if (errStrLen) {
+                std::string errStr((size_t)errStrLen, 0);
+                glGetProgramInfoLog(p.program->id(), errStrLen, &errStrLen, &errStr[0]);
+                Log::E("linker output:\n%s", errStr.c_str());
+            }
+            p.program = std::nullopt;
+            SS_THROW(0, "link gl program fail");
         }
-        SS_THROW(0, "link gl program fail");
-    }
-    glUseProgram(mProgram->id());
-
-    GLint locY = glGetUniformLocation(mProgram->id(), "texY");
-    GLint locU = glGetUniformLocation(mProgram->id(), "texU");
-    GLint locV = glGetUniformLocation(mProgram->id(), "texV");
-    glUniform1i(locY, 0);
-    glUniform1i(locU, 1);
-    glUniform1i(locV, 2);
-
-    GLint locPos = glGetAttribLocation(mProgram->id(), "iPos");
-    GLint locUv = glGetAttribLocation(mProgram->id(), "iUv");
-
-    static const GLfloat poss[] = {
-        -1.0f,
-        -1.0f,
-        //
-        1.0f,
-        -1.0f,
-        //
-        -1.0f,
-        1.0f,
-        //
-        1.0f,
-        -1.0f,
-        //
-        1.0f,
-        1.0f,
-        //
-        -1.0f,
-        1.0f,
-    };
-    glVertexAttribPointer(locPos, 2, GL_FLOAT, 0, 0, poss);
-    glEnableVertexAttribArray(locPos);
-
-    static const GLfloat uvs[] = {
-        0.0f,
-        1.0f,
-        //
-        1.0f,
-        1.0f,
-        //
-        0.0f,
-        0.0f,
-        //
-        1.0f,
-        1.0f,
-        //
-        1.0f,
-        0.0f,
-        //
-        0.0f,
-        0.0f,
+        glUseProgram(p.program->id());
+        mCurrentProgram = &p;
+
+        switch (kind) {
+            case PROGRAM_3PLANE:
+                glUniform1i(glGetUniformLocation(p.program->id(), "texY"), 0);
+                glUniform1i(glGetUniformLocation(p.program->id(), "texU"), 1);
+                glUniform1i(glGetUniformLocation(p.program->id(), "texV"), 2);
+                break;
+            case PROGRAM_2PLANE:
+                glUniform1i(glGetUniformLocation(p.program->id(), "texY"), 0);
+                glUniform1i(glGetUniformLocation(p.program->id(), "texUV"), 1);
+                break;
+            default:
+                glUniform1i(glGetUniformLocation(p.program->id(), "texYuv"), 0);
+                p.locPlaneRects = glGetUniformLocation(p.program->id(), "planeRects[0]");
+                p.locHalfTexel = glGetUniformLocation(p.program->id(), "halfTexel");
+                break;
+        }
+        p.locMatrix = glGetUniformLocation(p.program->id(), "yuvMatrix");
+        p.locOffset = glGetUniformLocation(p.program->id(), "yuvOffset");
+        p.locScale = glGetUniformLocation(p.program->id(), "sampleScale");
+    }
+
+    if (mCurrentProgram != &p) {
+        glUseProgram(p.program->id());
+        mCurrentProgram = &p;
+    }
+    return p;
+}
+
+void GlRender::updateColor(Program& program, const FrameFormat& format, const AVFrame* frame) {
+    int key[3] = {format.pixFmt, frame->colorspace, frame->color_range};
+    if (::memcmp(key, program.colorKey, sizeof(key)) == 0) {
+        return;
+    }
+    ::memcpy(program.colorKey, key, sizeof(key));
+
+    // luma coefficients, unspecified as bt.601.
+    float kr = 0.299f;
+    float kb = 0.114f;
+    const char* matrixName = "bt601";
+    switch (frame->colorspace) {
+        case AVCOL_SPC_BT709:
+            kr = 0.2126f;
+            kb = 0.0722f;
+            matrixName = "bt709";
+            break;
+        case AVCOL_SPC_BT2020_NCL:
+        case AVCOL_SPC_BT2020_CL:
+            kr = 0.2627f;
+            kb = 0.0593f;
+            matrixName = "bt2020";
+            break;
+        default:
+            break;
+    }
+    float kg = 1.0f - kr - kb;
+
+    // range, unspecified as limited(mpeg) unless format is full range(yuvj).
+    bool fullRange = format.fullRange || frame->color_range == AVCOL_RANGE_JPEG;
+    float maxValue = (float)((1 << format.depth) - 1);
+    float yOffset = 0.0f;
+    float yScale = 1.0f;
+    float cScale = 1.0f;
+    float cOffset = (float)(1 << (format.depth - 1)) / maxValue;
+    if (!fullRange) {
+        float shift = (float)(1 << (format.depth - 8));
+        yOffset = 16.0f * shift / maxValue;
+        yScale = maxValue / (219.0f * shift);
+        cScale = maxValue / (224.0f * shift);
+    }
+
+    // rgb = m * (yuv - offset), column major.
+    // clang-format off
+    const GLfloat m[9] = {
+        yScale, yScale, yScale,
+        0.0f, -2.0f * kb * (1.0f - kb) / kg * cScale, 2.0f * (1.0f - kb) * cScale,
+        2.0f * (1.0f - kr) * cScale, -2.0f * kr * (1.0f - kr) / kg * cScale, 0.0f,
     };
-    glVertexAttribPointer(locUv, 2, GL_FLOAT, 0, 0, uvs);
-    glEnableVertexAttribArray(locUv);
+    // clang-format on
+    glUniformMatrix3fv(program.locMatrix, 1, GL_FALSE, m);
+    glUniform3f(program.locOffset, yOffset, cOffset, cOffset);
+    glUniform1f(program.locScale, format.sampleScale);
+
+    Log::I(
+        "frame color: %s, matrix: %s, range: %s",
+        av_get_pix_fmt_name(format.pixFmt),
+        matrixName,
+        fullRange ? "full" : "limited");
+}
+
+void GlRender::bindState() {
+    if (sBoundRender == this) {
+        return;
+    }
+    sBoundRender = this;
+
+    if (mModern) {
+        GlExt::BindVertexArray(mVao->id());
+    } else {
+        glBindBuffer(GL_ARRAY_BUFFER, mVbo->id());
+        glVertexAttribPointer(ATTRIB_POS, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(GLfloat), (void*)0);
+        glVertexAttribPointer(
+            ATTRIB_UV, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(GLfloat), (void*)(2 * sizeof(GLfloat)));
+    }
+    if (mCurrentProgram) {
+        glUseProgram(mCurrentProgram->program->id());
+    }
+    if (mImageSet) {
+        for (int i = 0; i < MAX_PLANE; ++i) {
+            if (mImageSet->imgs[i]) {
+                glActiveTexture(GL_TEXTURE0 + i);
+                glBindTexture(GL_TEXTURE_2D, mImageSet->imgs[i]->id());
+            }
+        }
+    }
 }
 
 void GlRender::paint(PaintFrame* paintFrame) {
+    TraceZone zone("gl paint");
+    bindState();
+
     if (paintFrame) {
         AVFrame* decodeF = paintFrame->decodeFrame;
 
-        if (decodeF->format != AV_PIX_FMT_YUV420P) {
+        const FrameFormat* format = FindFrameFormat(decodeF->format);
+        if (!format) {
             const char* formatName =
                 av_get_pix_fmt_name((AVPixelFormat)paintFrame->decodeFrame->format);
             if (!formatName)
                 formatName = "unknown";
-            SS_THROW(0, "format not supported, expect: AV_PIX_FMT_YUV420P, now: %s", formatName);
+            SS_THROW(
+                0,
+                "format not supported, expect: AV_PIX_FMT_YUV420P/YUVJ420P/NV12/P010/YUV420P10, "
+                "now: %s",
+                formatName);
         }
 
+        ProgramKind kind = format->planeCount == 2 ? PROGRAM_2PLANE
+                           : mPacked               ? PROGRAM_PACKED
+                                                   : PROGRAM_3PLANE;
+        Program& program = useProgram(kind);
+        updateColor(program, *format, decodeF);
+
         int w = decodeF->width;
         int h = decodeF->height;
-        int hw = w / 2;
-        int hh = h / 2;
-        checkImgResize(w, h, hw, hh);
-
-        // update y-image data.
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, mImgY->id());
-        glPixelStorei(GL_UNPACK_ROW_LENGTH, (GLint)decodeF->linesize[0]);
-        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, w, h, GL_RED, GL_UNSIGNED_BYTE, decodeF->data[0]);
-
-        // update v-image data.
-        glActiveTexture(GL_TEXTURE1);
-        glBindTexture(GL_TEXTURE_2D, mImgU->id());
-        glPixelStorei(GL_UNPACK_ROW_LENGTH, (GLint)decodeF->linesize[1]);
-        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, hw, hh, GL_RED, GL_UNSIGNED_BYTE, decodeF->data[1]);
-
-        // update v-image data.
-        glActiveTexture(GL_TEXTURE2);
-        glBindTexture(GL_TEXTURE_2D, mImgV->id());
-        glPixelStorei(GL_UNPACK_ROW_LENGTH, (GLint)decodeF->linesize[2]);
-        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, hw, hh, GL_RED, GL_UNSIGNED_BYTE, decodeF->data[2]);
-    }
-
-    if (mImgY) {
+        int hw = (w + 1) / 2;
+        int hh = (h + 1) / 2;
+        ImageSet& imgSet = useImageSet(*format, w, h, program);
+
+        // update y/u/v or y/uv-image data, packed: y at (0, 0), u at (0, h), v at (hw, h).
+        chrono::high_resolution_clock::time_point now0 = chrono::high_resolution_clock::now();
+        uint64_t bytes = 0;
+        for (int i = 0; i < format->planeCount; ++i) {
+            bytes += uploadPlane(
+                imgSet.packed ? GL_TEXTURE0 : GL_TEXTURE0 + i,
+                imgSet.packed ? *imgSet.imgs[0] : *imgSet.imgs[i],
+                imgSet.tiles[i],
+                planeFormat(format->planes[i]),
+                decodeF->data[i],
+                decodeF->linesize[i],
+                imgSet.packed && i == 2 ? hw : 0,
+                imgSet.packed && i > 0 ? h : 0,
+                i == 0 ? w : hw,
+                i == 0 ? h : hh);
+        }
+        mUploadStats.uploadTime += chrono::high_resolution_clock::now() - now0;
+
+        ++mUploadStats.frames;
+        mUploadStats.uploadBytes += bytes;
+        mUploadStats.formatName = av_get_pix_fmt_name(format->pixFmt);
+        if (bytes == 0) {
+            ++mUploadStats.skipFrames;
+        }
+    }
+
+    if (mImageSet) {
         glDrawArrays(GL_TRIANGLES, 0, 6);
     } else {
         glClearColor(0.5f, 0.5f, 0.5f, 1.0f);
@@ -186,52 +442,174 @@ void GlRender::paint(PaintFrame* paintFrame) {
     }
 }
 
-void GlRender::checkImgResize(int w, int h, int hw, int hh) {
-    if (mImgW == w && mImgH == h) {
-        return;
+uint64_t GlRender::uploadPlane(
+    GLenum unit,
+    const RaiiImage& img,
+    DirtyTiles& tiles,
+    const PlaneFormat& format,
+    const uint8_t* data,
+    int linesize,
+    int x,
+    int y,
+    int w,
+    int h) {
+    glActiveTexture(unit);
+    glBindTexture(GL_TEXTURE_2D, img.id());
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, (GLint)(linesize / format.bytesPerPixel));
+
+    uint64_t fullBytes = (uint64_t)w * h * format.bytesPerPixel;
+    if (!Config::Singleton()->dirtyTile) {
+        glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, w, h, format.format, format.type, data);
+        return fullBytes;
     }
 
-    Log::I("frame image size changed: (%d, %d) -> (%d, %d)", mImgW, mImgH, w, h);
+    uint32_t dirtyCount = tiles.update(data, linesize, w, h, format.bytesPerPixel);
+    mUploadStats.tiles += tiles.count();
+    mUploadStats.dirtyTiles += dirtyCount;
 
-    mImgY = std::nullopt;
-    mImgU = std::nullopt;
-    mImgV = std::nullopt;
+    if (dirtyCount == 0) {
+        return 0;
+    }
+    if (dirtyCount == tiles.count()) {
+        glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, w, h, format.format, format.type, data);
+        return fullBytes;
+    }
 
-    GLuint _imgY = 0;
-    glGenTextures(1, &_imgY);
-    SS_THROW(_imgY, "create gl img-y fail");
-    mImgY.emplace(_imgY);
-    GLuint _imgU = 0;
-    glGenTextures(1, &_imgU);
-    SS_THROW(_imgU, "create gl img-u fail");
-    mImgU.emplace(_imgU);
-    GLuint _imgV = 0;
-    glGenTextures(1, &_imgV);
-    SS_THROW(_imgV, "create gl img-v fail");
-    mImgV.emplace(_imgV);
+    // upload dirty tiles, merge continuous tiles in same row to one call.
+    uint64_t bytes = 0;
+    for (uint32_t r = 0; r < tiles.rows(); ++r) {
+        int y0 = (int)(r * DirtyTiles::TILE_SIZE);
+        int y1 = std::min(h, y0 + (int)DirtyTiles::TILE_SIZE);
+        for (uint32_t c = 0; c < tiles.cols();) {
+            if (!tiles.dirty(c, r)) {
+                ++c;
+                continue;
+            }
+            uint32_t c1 = c + 1;
+            while (c1 < tiles.cols() && tiles.dirty(c1, r)) {
+                ++c1;
+            }
+            int x0 = (int)(c * DirtyTiles::TILE_SIZE);
+            int x1 = std::min(w, (int)(c1 * DirtyTiles::TILE_SIZE));
+            glTexSubImage2D(
+                GL_TEXTURE_2D,
+                0,
+                x + x0,
+                y + y0,
+                x1 - x0,
+                y1 - y0,
+                format.format,
+                format.type,
+                data + (size_t)y0 * linesize + (size_t)x0 * format.bytesPerPixel);
+            bytes += (uint64_t)(x1 - x0) * (y1 - y0) * format.bytesPerPixel;
+            c = c1;
+        }
+    }
+    return bytes;
+}
 
-    glBindTexture(GL_TEXTURE_2D, mImgY->id());
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RED, w, h, 0, GL_RED, GL_UNSIGNED_BYTE, nullptr);
+GlRender::ImageSet& GlRender::useImageSet(
+    const FrameFormat& format, int w, int h, Program& program) {
+    bool packed = mPacked && format.planeCount == 3;
+    int hw = (w + 1) / 2;
+    int hh = (h + 1) / 2;
 
-    glBindTexture(GL_TEXTURE_2D, mImgU->id());
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RED, hw, hh, 0, GL_RED, GL_UNSIGNED_BYTE, nullptr);
+    ImageSet* imgSet = nullptr;
+    for (std::optional<ImageSet>& i : mImageSets) {
+        if (i && i->w == w && i->h == h && i->format == &format && i->packed == packed) {
+            imgSet = &*i;
+            break;
+        }
+    }
 
-    glBindTexture(GL_TEXTURE_2D, mImgV->id());
+    if (!imgSet) {
+        // take empty slot, otherwise evict least recently used.
+        std::optional<ImageSet>* slot = &mImageSets[0];
+        for (std::optional<ImageSet>& i : mImageSets) {
+            if (!i) {
+                slot = &i;
+                break;
+            }
+            if (i->lastUse < (*slot)->lastUse) {
+                slot = &i;
+            }
+        }
+
+        Log::I(
+            "frame image changed: (%d, %d, %s) -> (%d, %d, %s), evict: %s",
+            mImageSet ? mImageSet->w : 0,
+            mImageSet ? mImageSet->h : 0,
+            mImageSet ? av_get_pix_fmt_name(mImageSet->format->pixFmt) : "none",
+            w,
+            h,
+            av_get_pix_fmt_name(format.pixFmt),
+            *slot ? "true" : "false");
+        if (*slot && mImageSet == &**slot) {
+            mImageSet = nullptr;
+        }
+
+        imgSet = &slot->emplace();
+        imgSet->w = w;
+        imgSet->h = h;
+        imgSet->format = &format;
+        imgSet->packed = packed;
+        if (packed) {
+            createImage(imgSet->imgs[0], planeFormat(format.planes[0]), hw * 2, h + hh);
+        } else {
+            for (int i = 0; i < format.planeCount; ++i) {
+                createImage(
+                    imgSet->imgs[i],
+                    planeFormat(format.planes[i]),
+                    i == 0 ? w : hw,
+                    i == 0 ? h : hh);
+            }
+        }
+    } else if (imgSet != mImageSet) {
+        Log::I(
+            "frame image changed: (%d, %d, %s), reuse pooled",
+            w,
+            h,
+            av_get_pix_fmt_name(format.pixFmt));
+    }
+
+    imgSet->lastUse = ++mImageSetUse;
+    if (imgSet != mImageSet) {
+        mImageSet = imgSet;
+        if (packed) {
+            float tw = (float)(hw * 2);
+            float th = (float)(h + hh);
+            // clang-format off
+            const GLfloat rects[12] = {
+                0.0f, 0.0f, w / tw, h / th,
+                0.0f, h / th, hw / tw, hh / th,
+                hw / tw, h / th, hw / tw, hh / th,
+            };
+            // clang-format on
+            glUniform4fv(program.locPlaneRects, 3, rects);
+            glUniform2f(program.locHalfTexel, 0.5f / tw, 0.5f / th);
+        }
+    }
+    return *imgSet;
+}
+
+void GlRender::createImage(std::optional<RaiiImage>& img, const PlaneFormat& format, int w, int h) {
+    GLuint _img = 0;
+    glGenTextures(1, &_img);
+    SS_THROW(_img, "create gl img fail");
+    img.emplace(_img);
+
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, img->id());
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RED, hw, hh, 0, GL_RED, GL_UNSIGNED_BYTE, nullptr);
-
-    mImgW = w;
-    mImgH = h;
+    if (mModern && GlExt::TexStorage2D) {
+        // immutable, driver skip completeness and realloc check on each upload.
+        GlExt::TexStorage2D(GL_TEXTURE_2D, 1, (GLenum)format.internalFormat, w, h);
+    } else {
+        glTexImage2D(
+            GL_TEXTURE_2D, 0, format.internalFormat, w, h, 0, format.format, format.type, nullptr);
+    }
 }
 }  // namespace ss
@@ -1,18 +1,57 @@
 #pragma once
 #include <ss/Common.hpp>
+#include <ss/DirtyTiles.hpp>
+#include <ss/GlExt.hpp>
 
 namespace ss {
-/** opengl impl for Render, support AV_PIX_FMT_YUV420P. */
+/**
+ * opengl impl for Render, support AV_PIX_FMT_YUV420P/YUVJ420P/NV12/P010LE/YUV420P10LE,
+ * color matrix and range follow frame's colorspace/color_range. use vao/vbo and immutable
+ * texture when context is gl 3.2+, otherwise gl 2.1.
+ */
 class GlRender : public xm::NonCopyable {
 public:
+    /** texture upload statistics, accumulate until `takeUploadStats`. */
+    struct UploadStats {
+        uint64_t frames = 0;
+        /** frames skip upload, all tiles not changed. */
+        uint64_t skipFrames = 0;
+        uint64_t uploadBytes = 0;
+        uint64_t tiles = 0;
+        uint64_t dirtyTiles = 0;
+        /** cpu time of hash and upload calls. */
+        chrono::high_resolution_clock::duration uploadTime = {};
+        /** pixel format name of last frame. */
+        const char* formatName = "none";
+    };
+
     GlRender();
 
-    ~GlRender() {}
+    ~GlRender() {
+        if (sBoundRender == this) {
+            sBoundRender = nullptr;
+        }
+    }
 
+    /** several renders can share one context(multi session), paint rebind own gl state. */
     void paint(PaintFrame* paintFrame);
 
-private:
-    void checkImgResize(int w, int h, int hw, int hh);
+    UploadStats takeUploadStats() {
+        UploadStats r = mUploadStats;
+        mUploadStats = {};
+        mUploadStats.formatName = r.formatName;
+        return r;
+    }
+
+    /** other gl drawing(overlay) changed context state, next paint rebind own state. */
+    static void InvalidateBoundState() {
+        sBoundRender = nullptr;
+    }
+
+    /** throw if compile fail, compiler output logged. */
+    static GLuint CompileShader(GLenum type, const char* prefix, const char* src, const char* name);
+
+    // gl object owners, also used by GlOverlay.
 
     class RaiiImage : public xm::NonCopyable {
     public:
@@ -62,18 +101,167 @@ private:
         GLuint mId;
     };
 
+    class RaiiBuffer : public xm::NonCopyable {
+    public:
+        RaiiBuffer(GLuint id) : mId(id) {}
+
+        ~RaiiBuffer() {
+            glDeleteBuffers(1, &mId);
+        }
+
+        GLuint id() const {
+            return mId;
+        }
+
+    private:
+        GLuint mId;
+    };
+
+    class RaiiVertexArray : public xm::NonCopyable {
+    public:
+        RaiiVertexArray(GLuint id) : mId(id) {}
+
+        ~RaiiVertexArray() {
+            GlExt::DeleteVertexArrays(1, &mId);
+        }
+
+        GLuint id() const {
+            return mId;
+        }
+
+    private:
+        GLuint mId;
+    };
+
+private:
+    enum : int {
+        MAX_PLANE = 3,
+        /** frame images pool, reuse when frame size switch back(e.g. rotate screen). */
+        IMAGE_SET_POOL_CAPACITY = 3,
+    };
+
+    /** shader variant. */
+    enum ProgramKind : int {
+        PROGRAM_3PLANE = 0,
+        PROGRAM_2PLANE,
+        /** y/u/v planes packed in one image. */
+        PROGRAM_PACKED,
+        PROGRAM_COUNT,
+    };
+
+    /** sample layout of one frame plane, map to gl texture format by render path. */
+    enum class PlaneKind : uint8_t {
+        R8 = 0,
+        RG8,
+        R16,
+        RG16,
+    };
+
+    /** gl texture layout of one frame plane. */
+    struct PlaneFormat {
+        GLint internalFormat;
+        GLenum format;
+        GLenum type;
+        int bytesPerPixel;
+    };
+
+    /** frame pixel format support by GlRender. */
+    struct FrameFormat {
+        AVPixelFormat pixFmt;
+        /** bits of sample. */
+        int depth;
+        /** full range regardless of frame's color_range(yuvj). */
+        bool fullRange;
+        /** scale texture sample to [0, 1] of depth. */
+        float sampleScale;
+        /** 3: y/u/v planes, 2: y/uv planes. */
+        int planeCount;
+        PlaneKind planes[MAX_PLANE];
+    };
+
+    /** shader variant, color uniforms cached by key. */
+    struct Program {
+        std::optional<RaiiShader> fs;
+        std::optional<RaiiProgram> program;
+        GLint locMatrix = -1;
+        GLint locOffset = -1;
+        GLint locScale = -1;
+        /** packed only. */
+        GLint locPlaneRects = -1;
+        GLint locHalfTexel = -1;
+        /** pixFmt/colorspace/color_range of current uniforms. */
+        int colorKey[3] = {-1, -1, -1};
+    };
+
+    /** images of one frame size and format. */
+    struct ImageSet {
+        int w = 0;
+        int h = 0;
+        const FrameFormat* format = nullptr;
+        /** all planes in imgs[0], y on top, u and v side by side below. */
+        bool packed = false;
+        /** for evict least recently used. */
+        uint64_t lastUse = 0;
+        std::optional<RaiiImage> imgs[MAX_PLANE];
+        /** tiles hash match image content, so keep with images. */
+        DirtyTiles tiles[MAX_PLANE];
+    };
+
+    /** return nullptr if not supported. */
+    static const FrameFormat* FindFrameFormat(int pixFmt);
+
+    /** gl texture format of plane for current render path. */
+    const PlaneFormat& planeFormat(PlaneKind kind) const;
+
+    /** rebind vertex arrays, program and images if other render used context. */
+    void bindState();
+
+    /** return program of kind, create if not exist. */
+    Program& useProgram(ProgramKind kind);
+
+    /** update color matrix uniforms if frame color changed. */
+    void updateColor(Program& program, const FrameFormat& format, const AVFrame* frame);
+
+    /** return pooled images match frame, create(evict lru) if not exist, program must in use. */
+    ImageSet& useImageSet(const FrameFormat& format, int w, int h, Program& program);
+
+    void createImage(std::optional<RaiiImage>& img, const PlaneFormat& format, int w, int h);
+
+    /**
+     * upload plane to image at (x, y), only changed tiles if dirty tile enabled, return uploaded
+     * bytes.
+     */
+    uint64_t uploadPlane(
+        GLenum unit,
+        const RaiiImage& img,
+        DirtyTiles& tiles,
+        const PlaneFormat& format,
+        const uint8_t* data,
+        int linesize,
+        int x,
+        int y,
+        int w,
+        int h);
+
     // ----
 
-    /** current image width. */
-    int mImgW = 0;
-    /** current image height. */
-    int mImgH = 0;
+    /** render whose gl state bound to current context. */
+    static GlRender* sBoundRender;
 
-    std::optional<RaiiImage> mImgY;
-    std::optional<RaiiImage> mImgU;
-    std::optional<RaiiImage> mImgV;
+    /** gl 3.2+ path: vao, r/rg textures, immutable texture storage. */
+    bool mModern = false;
+    bool mPacked = false;
+
+    std::optional<RaiiVertexArray> mVao;
+    std::optional<RaiiBuffer> mVbo;
     std::optional<RaiiShader> mVs;
-    std::optional<RaiiShader> mFs;
-    std::optional<RaiiProgram> mProgram;
+    Program mPrograms[PROGRAM_COUNT];
+    Program* mCurrentProgram = nullptr;
+
+    std::optional<ImageSet> mImageSets[IMAGE_SET_POOL_CAPACITY];
+    ImageSet* mImageSet = nullptr;
+    uint64_t mImageSetUse = 0;
+
+    UploadStats mUploadStats;
 };
 }  // namespace ss
@@ -0,0 +1,200 @@
+#include <ss/HugePageAlloc.hpp>
+
+extern "C" {
+#include <libavutil/imgutils.h>
+}
+
+#if defined(XM_OS_LINUX)
+    #include <linux/mempolicy.h>
+    #include <sys/mman.h>
+    #include <sys/syscall.h>
+#endif
+
+namespace ss {
+HugePageAlloc::HugePageAlloc() {
+#if defined(XM_OS_LINUX)
+    mNuma = ::access("/sys/devices/system/node/node1", F_OK) == 0;
+#endif
+    Log::I(
+        "huge page alloc, min size: %dKB, numa: %s",
+        (int)(MIN_SIZE >> 10),
+        mNuma ? "prefer node of consumer thread" : "single node");
+}
+
+HugePageAlloc::~HugePageAlloc() {
+    Log::I(
+        "huge page mapped, hugetlb: %.1fMB, transparent: %.1fMB, fail: %llu",
+        (double)mHugetlbBytes.load() / (1 << 20),
+        (double)mThpBytes.load() / (1 << 20),
+        (unsigned long long)mFailed.load());
+}
+
+void HugePageAlloc::setConsumerThread(Consumer consumer) {
+#if defined(XM_OS_LINUX)
+    unsigned cpu = 0;
+    unsigned node = 0;
+    if (::syscall(SYS_getcpu, &cpu, &node, nullptr) == 0) {
+        mNodes[consumer].store((int)node, std::memory_order_relaxed);
+    }
+#else
+    (void)consumer;
+#endif
+}
+
+AVBufferRef* HugePageAlloc::alloc(Consumer consumer, size_t size) {
+#if defined(XM_OS_LINUX)
+    size_t mapped = (size + HUGE_PAGE_SIZE - 1) & ~(size_t)(HUGE_PAGE_SIZE - 1);
+    void* p = MAP_FAILED;
+    bool hugetlb = false;
+    if (!mHugetlbFailed.load(std::memory_order_relaxed)) {
+        p = ::mmap(
+            nullptr,
+            mapped,
+            PROT_READ | PROT_WRITE,
+            MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB,
+            -1,
+            0);
+        hugetlb = p != MAP_FAILED;
+        if (!hugetlb && !mHugetlbFailed.exchange(true)) {
+            Log::I("'mmap' MAP_HUGETLB fail: %s, use transparent huge page", ::strerror(errno));
+        }
+    }
+
+    if (p == MAP_FAILED) {
+        // transparent huge page only back 2MB aligned ranges, over map and trim.
+        size_t over = mapped + HUGE_PAGE_SIZE;
+        uint8_t* raw = (uint8_t*)::mmap(
+            nullptr, over, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (raw == MAP_FAILED) {
+            Log::W("'mmap' fail: %s, size: %zu", ::strerror(errno), mapped);
+            mFailed.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        uint8_t* aligned =
+            (uint8_t*)(((uintptr_t)raw + HUGE_PAGE_SIZE - 1) & ~(uintptr_t)(HUGE_PAGE_SIZE - 1));
+        if (aligned > raw) {
+            ::munmap(raw, aligned - raw);
+        }
+        if (raw + over > aligned + mapped) {
+            ::munmap(aligned + mapped, raw + over - (aligned + mapped));
+        }
+        p = aligned;
+        // thp disabled(never) keep normal pages, still usable.
+        ::madvise(p, mapped, MADV_HUGEPAGE);
+    }
+
+    int node = mNodes[consumer].load(std::memory_order_relaxed);
+    if (mNuma && node >= 0 && node < 64) {
+        // before first touch, pages placed on fault. kernel ignore last bit of maxnode.
+        unsigned long mask = 1ul << node;
+        ::syscall(SYS_mbind, p, mapped, MPOL_PREFERRED, &mask, sizeof(mask) * 8 + 1, 0);
+    }
+
+    AVBufferRef* buf = av_buffer_create((uint8_t*)p, mapped, &Unmap, (void*)(uintptr_t)mapped, 0);
+    if (!buf) {
+        ::munmap(p, mapped);
+        mFailed.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+    (hugetlb ? mHugetlbBytes : mThpBytes).fetch_add(mapped, std::memory_order_relaxed);
+    return buf;
+#else
+    (void)consumer;
+    (void)size;
+    return nullptr;
+#endif
+}
+
+void HugePageAlloc::Unmap(void* opaque, uint8_t* data) {
+#if defined(XM_OS_LINUX)
+    // may outlive instance, e.g. last frame held by render.
+    ::munmap(data, (size_t)(uintptr_t)opaque);
+#else
+    (void)opaque;
+    (void)data;
+#endif
+}
+
+AVBufferRef* HugeFramePool::AllocBuffer(void* opaque, size_t size) {
+    (void)opaque;
+    AVBufferRef* buf = HugePageAlloc::Alloc(HugePageAlloc::PAINT, size);
+    return buf ? buf : av_buffer_alloc(size);
+}
+
+int HugeFramePool::getBuffer(AVCodecContext* ctx, AVFrame* frame, int flags) {
+    if (!(ctx->codec->capabilities & AV_CODEC_CAP_DR1)) {
+        return avcodec_default_get_buffer2(ctx, frame, flags);
+    }
+    if (frame->width != mWidth || frame->height != mHeight || frame->format != mFormat) {
+        updateLayout(ctx, frame);
+    }
+    if (!mBufferSize) {
+        return avcodec_default_get_buffer2(ctx, frame, flags);
+    }
+
+    frame->buf[0] = av_buffer_pool_get(mPool);
+    if (!frame->buf[0]) {
+        return AVERROR(ENOMEM);
+    }
+    for (int i = 0; i < 4; ++i) {
+        frame->data[i] = mLinesizes[i] ? frame->buf[0]->data + mOffsets[i] : nullptr;
+        frame->linesize[i] = mLinesizes[i];
+    }
+    frame->extended_data = frame->data;
+    return 0;
+}
+
+void HugeFramePool::updateLayout(AVCodecContext* ctx, const AVFrame* frame) {
+    mWidth = frame->width;
+    mHeight = frame->height;
+    mFormat = frame->format;
+    mBufferSize = 0;
+    // stream size changed(e.g. rotation), buffers of old layout freed when returned.
+    av_buffer_pool_uninit(&mPool);
+
+    // decoder write edges and read past width/height, same padding as ffmpeg default.
+    int w = frame->width;
+    int h = frame->height;
+    int strideAligns[AV_NUM_DATA_POINTERS] = {};
+    avcodec_align_dimensions2(ctx, &w, &h, strideAligns);
+    int linesizes[4] = {};
+    for (bool unaligned = true; unaligned; w += w & ~(w - 1)) {
+        if (av_image_fill_linesizes(linesizes, (AVPixelFormat)mFormat, w) < 0) {
+            return;
+        }
+        unaligned = false;
+        for (int i = 0; i < 4; ++i) {
+            unaligned = unaligned || linesizes[i] % PLANE_ALIGN != 0 ||
+                        (strideAligns[i] > 0 && linesizes[i] % strideAligns[i] != 0);
+        }
+    }
+
+    ptrdiff_t planeLinesizes[4] = {linesizes[0], linesizes[1], linesizes[2], linesizes[3]};
+    size_t planeSizes[4] = {};
+    if (av_image_fill_plane_sizes(planeSizes, (AVPixelFormat)mFormat, h, planeLinesizes) < 0) {
+        return;
+    }
+    size_t total = 0;
+    for (int i = 0; i < 4; ++i) {
+        mOffsets[i] = total;
+        total += (planeSizes[i] + PLANE_ALIGN - 1) & ~(size_t)(PLANE_ALIGN - 1);
+    }
+    total += TAIL_PADDING;
+    if (total < HugePageAlloc::MIN_SIZE) {
+        return;
+    }
+
+    mPool = av_buffer_pool_init2(total, this, &HugeFramePool::AllocBuffer, nullptr);
+    if (!mPool) {
+        Log::W("'av_buffer_pool_init2' fail, use default frame buffers");
+        return;
+    }
+    ::memcpy(mLinesizes, linesizes, sizeof(mLinesizes));
+    mBufferSize = total;
+    Log::I(
+        "huge frame pool, frame: %dx%d, buffer: %.1fMB",
+        mWidth,
+        mHeight,
+        (double)mBufferSize / (1 << 20));
+}
+}  // namespace ss
@@ -0,0 +1,114 @@
+#pragma once
+#include <ss/Common.hpp>
+
+namespace ss {
+/**
+ * large frame and packet buffers on 2MB pages(-huge-pages), MAP_HUGETLB if huge pages reserved,
+ * else transparent huge page by madvise, preferred on numa node of consumer thread. linux only,
+ * caller fallback to av_malloc on fail.
+ */
+class HugePageAlloc : public xm::SingletonBase<HugePageAlloc> {
+public:
+    enum Consumer : int {
+        /** net-frame bodies, read by decode thread. */
+        DECODE = 0,
+        /** decoded frames, read by main thread(upload). */
+        PAINT,
+        CONSUMER_COUNT,
+    };
+
+    enum : size_t {
+        HUGE_PAGE_SIZE = 2 << 20,
+        /** smaller buffer waste most of huge page, keep av_malloc. */
+        MIN_SIZE = 1 << 20,
+    };
+
+    HugePageAlloc();
+
+    /** log mapped bytes by kind. */
+    ~HugePageAlloc();
+
+    /** numa node of calling thread as node of `consumer`, call after thread pinned. */
+    static void SetConsumerThread(Consumer consumer) {
+        if (HugePageAlloc* self = Singleton()) {
+            self->setConsumerThread(consumer);
+        }
+    }
+
+    /**
+     * refcounted zero buffer, size rounded up to huge pages(AVBufferRef::size is rounded size).
+     * nullptr if not instanced, `size` below MIN_SIZE or map fail.
+     */
+    static AVBufferRef* Alloc(Consumer consumer, size_t size) {
+        HugePageAlloc* self = Singleton();
+        return self && size >= MIN_SIZE ? self->alloc(consumer, size) : nullptr;
+    }
+
+private:
+    void setConsumerThread(Consumer consumer);
+
+    AVBufferRef* alloc(Consumer consumer, size_t size);
+
+    /** buffer free callback, munmap. */
+    static void Unmap(void* opaque, uint8_t* data);
+
+    // ----
+
+    /** -1 means unknown, no bind. */
+    std::atomic<int> mNodes[CONSUMER_COUNT] = {-1, -1};
+    /** bind only if more than one node. */
+    bool mNuma = false;
+    /** no reserved huge pages, skip MAP_HUGETLB after first fail. */
+    std::atomic<bool> mHugetlbFailed = false;
+    std::atomic<uint64_t> mHugetlbBytes = 0;
+    std::atomic<uint64_t> mThpBytes = 0;
+    std::atomic<uint64_t> mFailed = 0;
+};
+
+/**
+ * decoder frame buffers from HugePageAlloc, all planes of frame in one pooled buffer. frames
+ * below HugePageAlloc::MIN_SIZE or not direct rendering codec use default get_buffer2.
+ */
+class HugeFramePool : public xm::NonCopyable {
+public:
+    ~HugeFramePool() {
+        // buffers in use freed when returned.
+        av_buffer_pool_uninit(&mPool);
+    }
+
+    /** set as get_buffer2 of `ctx`(opaque point to pool), before avcodec_open2. */
+    void attach(AVCodecContext* ctx) {
+        ctx->opaque = this;
+        ctx->get_buffer2 = &HugeFramePool::GetBuffer2;
+    }
+
+private:
+    enum : int {
+        PLANE_ALIGN = 64,
+        /** extra bytes after last plane, same as ffmpeg default. */
+        TAIL_PADDING = 16 + PLANE_ALIGN - 1,
+    };
+
+    static int GetBuffer2(AVCodecContext* ctx, AVFrame* frame, int flags) {
+        return ((HugeFramePool*)ctx->opaque)->getBuffer(ctx, frame, flags);
+    }
+
+    static AVBufferRef* AllocBuffer(void* opaque, size_t size);
+
+    int getBuffer(AVCodecContext* ctx, AVFrame* frame, int flags);
+
+    /** plane layout and pool of `frame` size and format, mBufferSize 0 if use default. */
+    void updateLayout(AVCodecContext* ctx, const AVFrame* frame);
+
+    // ----
+
+    AVBufferPool* mPool = nullptr;
+    int mWidth = 0;
+    int mHeight = 0;
+    int mFormat = AV_PIX_FMT_NONE;
+    /** 0 means default get_buffer2 for this layout. */
+    size_t mBufferSize = 0;
+    int mLinesizes[4] = {};
+    size_t mOffsets[4] = {};
+};
+}  // namespace ss
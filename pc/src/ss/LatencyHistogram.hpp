@@ -0,0 +1,109 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+
+namespace ss {
+/**
+ * hdr style histogram of durations in microseconds. log-linear buckets, values below
+ * `SUB_COUNT` exact, above each power of two split to `SUB_COUNT / 2` buckets, relative error
+ * < 2 / SUB_COUNT. fixed memory, add is o(1) without allocation, not thread safe.
+ */
+class LatencyHistogram {
+public:
+    enum : int {
+        SUB_BITS = 6,
+        SUB_COUNT = 1 << SUB_BITS,
+        /** values clamp to 2^VALUE_BITS - 1 us, about 12 days. */
+        VALUE_BITS = 40,
+        BUCKET_COUNT = SUB_COUNT + (VALUE_BITS - SUB_BITS) * SUB_COUNT / 2,
+    };
+
+    void add(std::chrono::nanoseconds d) {
+        int64_t us = std::chrono::duration_cast<std::chrono::microseconds>(d).count();
+        add((uint64_t)std::max<int64_t>(us, 0));
+    }
+
+    void add(uint64_t us) {
+        us = std::min<uint64_t>(us, (1ull << VALUE_BITS) - 1);
+        ++mCounts[BucketOf(us)];
+        ++mCount;
+        mMax = std::max(mMax, us);
+    }
+
+    void merge(const LatencyHistogram& other) {
+        for (int i = 0; i < BUCKET_COUNT; ++i) {
+            mCounts[i] += other.mCounts[i];
+        }
+        mCount += other.mCount;
+        mMax = std::max(mMax, other.mMax);
+    }
+
+    void reset() {
+        std::fill(mCounts, mCounts + BUCKET_COUNT, 0);
+        mCount = 0;
+        mMax = 0;
+    }
+
+    uint64_t count() const {
+        return mCount;
+    }
+
+    /** us, 0 if empty. */
+    uint64_t max() const {
+        return mMax;
+    }
+
+    /** us, highest value of bucket the percentile(0-100) falls in, never above max. */
+    uint64_t percentile(double p) const {
+        if (mCount == 0) {
+            return 0;
+        }
+        uint64_t rank = (uint64_t)(std::clamp(p, 0.0, 100.0) / 100.0 * (double)mCount + 0.5);
+        rank = std::clamp<uint64_t>(rank, 1, mCount);
+        uint64_t seen = 0;
+        for (int i = 0; i < BUCKET_COUNT; ++i) {
+            seen += mCounts[i];
+            if (seen >= rank) {
+                return std::min(LowestOf(i + 1) - 1, mMax);
+            }
+        }
+        return mMax;
+    }
+
+    static int BucketOf(uint64_t us) {
+        if (us < SUB_COUNT) {
+            return (int)us;
+        }
+        int msb = 63 - CountLeadingZero(us);
+        int shift = msb - (SUB_BITS - 1);
+        int sub = (int)(us >> shift) - SUB_COUNT / 2;
+        return SUB_COUNT + (shift - 1) * (SUB_COUNT / 2) + sub;
+    }
+
+    /** lowest value of bucket, `BUCKET_COUNT` gives upper limit. */
+    static uint64_t LowestOf(int bucket) {
+        if (bucket < SUB_COUNT) {
+            return (uint64_t)bucket;
+        }
+        int shift = (bucket - SUB_COUNT) / (SUB_COUNT / 2) + 1;
+        int sub = (bucket - SUB_COUNT) % (SUB_COUNT / 2) + SUB_COUNT / 2;
+        return (uint64_t)sub << shift;
+    }
+
+private:
+    static int CountLeadingZero(uint64_t v) {
+        int n = 0;
+        for (uint64_t bit = 1ull << 63; bit && !(v & bit); bit >>= 1) {
+            ++n;
+        }
+        return n;
+    }
+
+    // ----
+
+    uint64_t mCounts[BUCKET_COUNT] = {};
+    uint64_t mCount = 0;
+    uint64_t mMax = 0;
+};
+}  // namespace ss
@@ -0,0 +1,225 @@
+#include <ss/Common.hpp>
+
+namespace ss {
+namespace {
+/** release ring when thread exit, skipped if log destroyed before(main thread). */
+struct ThreadRing {
+    std::atomic<bool>* owned = nullptr;
+    void* ring = nullptr;
+
+    ~ThreadRing() {
+        if (owned && Log::Singleton()) {
+            owned->store(false, std::memory_order_release);
+        }
+    }
+};
+
+thread_local ThreadRing tThreadRing;
+
+constexpr uint32_t AlignRecord(uint32_t size) {
+    return (size + 7) & ~7u;
+}
+
+const char* TagPrefix(LogTag tag) {
+    switch (tag) {
+        case LogTag::INFO:
+            return "[I] ";
+        case LogTag::WARNING:
+            return "[W] ";
+        case LogTag::ERR:
+            return "[E] ";
+        default:
+            return "[?] ";
+    }
+}
+}  // namespace
+
+Log::Log() {
+    try {
+        mWriter.emplace([this]() { runWriter(); });
+    } catch (const std::exception& e) {
+        ::printf("[E] create log thread fail: %s\n", e.what());
+    }
+
+    I("share screen, version: %d.%d.%d, code: %d, build type: %s",
+      SS_VERSION_MAJOR,
+      SS_VERSION_MINOR,
+      SS_VERSION_PATCH,
+      SS_VERSION_CODE,
+      SS_BUILD_TYPE_NAME);
+}
+
+Log::~Log() {
+    if (mWriter) {
+        mStop = true;
+        {
+            std::lock_guard<std::mutex> lock(mWakeupLock);
+            mWakeupCond.notify_one();
+        }
+        mWriter->join();
+    } else {
+        // no writer, print what queued.
+        while (drain()) {
+            ::fwrite(mBatch.data(), 1, mBatch.size(), mOutput);
+        }
+    }
+    if (mOutput != stdout) {
+        ::fclose(mOutput);
+    }
+}
+
+void Log::setOutputFile(const std::string& path) {
+    FILE* file = ::fopen(path.c_str(), "ab");
+    SS_THROW(file, "open log file fail: %s", path.c_str());
+    std::lock_guard<std::mutex> lock(mOutputLock);
+    if (mOutput != stdout) {
+        ::fclose(mOutput);
+    }
+    mOutput = file;
+}
+
+void Log::AvLogCallback(void* avcl, int level, const char* fmt, va_list vl) {
+    if (level > av_log_get_level()) {
+        return;
+    }
+    // ffmpeg may print one line by several calls, prefix only at line begin.
+    thread_local int printPrefix = 1;
+    char line[1024];
+    av_log_format_line2(avcl, level, fmt, vl, line, sizeof(line), &printPrefix);
+    size_t len = ::strlen(line);
+    while (len > 0 && (line[len - 1] == '\n' || line[len - 1] == '\r')) {
+        line[--len] = '\0';
+    }
+    if (len == 0) {
+        return;
+    }
+    LogTag tag = level <= AV_LOG_ERROR     ? LogTag::ERR
+                 : level <= AV_LOG_WARNING ? LogTag::WARNING
+                                           : LogTag::INFO;
+    Singleton()->write(tag, line);
+}
+
+Log::Ring* Log::ringOfThread() {
+    if (tThreadRing.ring) {
+        return (Ring*)tThreadRing.ring;
+    }
+
+    Ring* ring = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(mRingsLock);
+        // reuse ring of exited thread, after writer drained it.
+        for (std::unique_ptr<Ring>& i : mRings) {
+            if (!i->owned.load(std::memory_order_acquire) &&
+                i->head.load(std::memory_order_relaxed) ==
+                    i->tail.load(std::memory_order_acquire)) {
+                i->owned.store(true, std::memory_order_relaxed);
+                ring = &*i;
+                break;
+            }
+        }
+        if (!ring) {
+            mRings.push_back(std::make_unique<Ring>());
+            ring = &*mRings.back();
+        }
+    }
+    tThreadRing.owned = &ring->owned;
+    tThreadRing.ring = ring;
+    return ring;
+}
+
+void Log::append(LogTag tag, FormatFn format, const char* payload, uint32_t size) {
+    Ring& r = *ringOfThread();
+    size = std::min<uint32_t>(size, RING_CAPACITY / 2);
+    uint32_t need = AlignRecord((uint32_t)sizeof(RecordHeader) + size);
+
+    uint64_t head = r.head.load(std::memory_order_relaxed);
+    uint32_t pos = (uint32_t)(head & (RING_CAPACITY - 1));
+    // record never wrap, pad to ring begin.
+    uint32_t padding = pos + need > RING_CAPACITY ? RING_CAPACITY - pos : 0;
+    uint64_t used = head - r.tail.load(std::memory_order_acquire);
+    if (used + padding + need > RING_CAPACITY) {
+        ++mDropLines;
+        return;
+    }
+
+    if (padding) {
+        ((RecordHeader*)(r.data + pos))->size = PADDING;
+        pos = 0;
+    }
+    RecordHeader* header = (RecordHeader*)(r.data + pos);
+    header->size = size;
+    header->tag = tag;
+    header->format = format;
+    ::memcpy(header + 1, payload, size);
+    r.head.store(head + padding + need, std::memory_order_release);
+
+    if (!mWakeup.exchange(true, std::memory_order_acq_rel)) {
+        mWakeupCond.notify_one();
+    }
+}
+
+bool Log::drain() {
+    mBatch.clear();
+    char line[1024];
+    {
+        std::lock_guard<std::mutex> lock(mRingsLock);
+        for (std::unique_ptr<Ring>& i : mRings) {
+            Ring& r = *i;
+            uint64_t tail = r.tail.load(std::memory_order_relaxed);
+            uint64_t head = r.head.load(std::memory_order_acquire);
+            while (tail < head) {
+                uint32_t pos = (uint32_t)(tail & (RING_CAPACITY - 1));
+                const RecordHeader* header = (const RecordHeader*)(r.data + pos);
+                if (header->size == PADDING) {
+                    tail += RING_CAPACITY - pos;
+                    continue;
+                }
+                const char* prefix = TagPrefix(header->tag);
+                const char* text = (const char*)(header + 1);
+                uint32_t textSize = header->size;
+                if (header->format) {
+                    // deferred line formatted here, off the producer thread.
+                    int n = header->format(line, sizeof(line), text);
+                    text = line;
+                    textSize = (uint32_t)std::clamp<int>(n, 0, (int)sizeof(line) - 1);
+                }
+                mBatch.insert(mBatch.end(), prefix, prefix + 4);
+                mBatch.insert(mBatch.end(), text, text + textSize);
+                mBatch.push_back('\n');
+                tail += AlignRecord((uint32_t)sizeof(RecordHeader) + header->size);
+            }
+            r.tail.store(tail, std::memory_order_release);
+        }
+    }
+
+    uint64_t dropLines = mDropLines.load(std::memory_order_relaxed);
+    if (dropLines != mReportedDropLines) {
+        int n = snprintf(
+            line, sizeof(line), "[W] log drop lines: %llu\n", (unsigned long long)dropLines);
+        mBatch.insert(mBatch.end(), line, line + n);
+        mReportedDropLines = dropLines;
+    }
+    return !mBatch.empty();
+}
+
+void Log::runWriter() {
+    while (true) {
+        bool stop = mStop.load();
+        mWakeup.store(false, std::memory_order_release);
+        if (drain()) {
+            // one write and flush per batch.
+            std::lock_guard<std::mutex> lock(mOutputLock);
+            ::fwrite(mBatch.data(), 1, mBatch.size(), mOutput);
+            ::fflush(mOutput);
+            continue;
+        }
+        if (stop) {
+            break;
+        }
+        std::unique_lock<std::mutex> lock(mWakeupLock);
+        mWakeupCond.wait_for(lock, chrono::milliseconds(WRITER_WAIT_MS), [this]() {
+            return mWakeup.load() || mStop.load();
+        });
+    }
+}
+}  // namespace ss
@@ -2,24 +2,129 @@
 #include <ss/PtsThread.hpp>
 #include <ss/DecodeThread.hpp>
 #include <ss/NetThread.hpp>
+#include <ss/RecordThread.hpp>
+#include <ss/Metrics.hpp>
+#include <ss/Bench.hpp>
+#include <ss/HugePageAlloc.hpp>
+#include <ss/ThreadPolicy.hpp>
+#include <ss/StartupReport.hpp>
+#include <ss/Trace.hpp>
+
+/** `[role]:[cpus]`, cpus e.g. `2`, `2,3` or `2-5`. */
+static void parse_pin(const char* arg, ss::Config* cfg) {
+    const char* colon = ::strchr(arg, ':');
+    SS_THROW(colon, "parse pin fail: %s, expect [role]:[cpus]", arg);
+    std::string roleName(arg, colon);
+    int role = 0;
+    while (role < (int)ss::ThreadRole::COUNT &&
+           roleName != ss::ThreadRoleName((ss::ThreadRole)role)) {
+        ++role;
+    }
+    SS_THROW(
+        role < (int)ss::ThreadRole::COUNT,
+        "unknown pin thread: %s, acceptable: net, decode, pts, main, record",
+        roleName.c_str());
+
+    uint64_t cpus = 0;
+    const char* p = colon + 1;
+    while (true) {
+        int first = 0;
+        int last = 0;
+        int n = 0;
+        if (::sscanf(p, "%d-%d%n", &first, &last, &n) != 2) {
+            SS_THROW(::sscanf(p, "%d%n", &first, &n) == 1, "parse pin cpus fail: %s", arg);
+            last = first;
+        }
+        SS_THROW(
+            first >= 0 && first <= last && last < 64,
+            "pin cpus out of range: %s, acceptable range: [0, 64)",
+            arg);
+        for (int i = first; i <= last; ++i) {
+            cpus |= (uint64_t)1 << i;
+        }
+        p += n;
+        if (*p == '\0') {
+            break;
+        }
+        SS_THROW(*p == ',', "parse pin cpus fail: %s", arg);
+        ++p;
+    }
+    cfg->threadCpus[role] = cpus;
+}
 
 static std::unique_ptr<ss::Config> parse_config(int argc, char* argv[]) {
     auto cfg = std::make_unique<ss::Config>();
+#if defined(XM_OS_WINDOWS)
+    const char* cacheDir = ::getenv("APPDATA");
+#else
+    const char* cacheDir = ::getenv("HOME");
+#endif
+    if (cacheDir) {
+        cfg->senderCachePath = std::string(cacheDir) + "/.share_screen_sender";
+    }
     for (int i = 1; i < argc; ++i) {
         size_t len = ::strlen(argv[i]);
         if (len > 4 && ::strncmp(argv[i], "-ip=", 4) == 0) {
-            cfg->ip = argv[i] + 4;
+            SS_THROW(
+                (int)cfg->ips.size() < ss::MAX_SESSION,
+                "too many sessions, max: %d",
+                (int)ss::MAX_SESSION);
             sockaddr_in tmpAddr = {};
             SS_THROW(
-                uv_ip4_addr(cfg->ip.c_str(), 1314, &tmpAddr) == 0,
+                uv_ip4_addr(argv[i] + 4, 1314, &tmpAddr) == 0,
                 "parse direct ip address fail: %s",
                 argv[i]);
+            cfg->ips.push_back(argv[i] + 4);
+        } else if (len > 16 && ::strncmp(argv[i], "-decode-threads=", 16) == 0) {
+            SS_THROW(
+                ::sscanf(argv[i] + 16, "%d", &cfg->decodeThreads) == 1,
+                "parse decode threads fail: %s",
+                argv[i]);
+            SS_THROW(
+                cfg->decodeThreads >= 0 && cfg->decodeThreads <= ss::MAX_SESSION,
+                "decode threads out of range: %d, acceptable range: [0, %d]",
+                cfg->decodeThreads,
+                (int)ss::MAX_SESSION);
         } else if (len > 6 && ::strncmp(argv[i], "-port=", 6) == 0) {
             SS_THROW(::sscanf(argv[i] + 6, "%d", &cfg->port) == 1, "parse port fail: %s", argv[i]);
             SS_THROW(
                 cfg->port >= 0 && cfg->port < 65536,
                 "port out of range: %d, acceptable range: [0, 65536)",
                 cfg->port);
+        } else if (::strcmp(argv[i], "-relay") == 0) {
+            cfg->relay = true;
+        } else if (len > 12 && ::strncmp(argv[i], "-relay-port=", 12) == 0) {
+            SS_THROW(
+                ::sscanf(argv[i] + 12, "%d", &cfg->relayPort) == 1,
+                "parse relay port fail: %s",
+                argv[i]);
+            SS_THROW(
+                cfg->relayPort >= 0 && cfg->relayPort < 65536,
+                "relay port out of range: %d, acceptable range: [0, 65536)",
+                cfg->relayPort);
+        } else if (::strcmp(argv[i], "-startup-report") == 0) {
+            cfg->startupReport = true;
+        } else if (::strcmp(argv[i], "-no-reconnect") == 0) {
+            cfg->reconnect = false;
+        } else if (len > 14 && ::strncmp(argv[i], "-sender-cache=", 14) == 0) {
+            cfg->senderCachePath = argv[i] + 14;
+        } else if (::strcmp(argv[i], "-no-sender-cache") == 0) {
+            cfg->senderCachePath.clear();
+        } else if (len > 8 && ::strncmp(argv[i], "-record=", 8) == 0) {
+            cfg->recordPath = argv[i] + 8;
+        } else if (len > 14 && ::strncmp(argv[i], "-metrics-port=", 14) == 0) {
+            SS_THROW(
+                ::sscanf(argv[i] + 14, "%d", &cfg->metricsPort) == 1,
+                "parse metrics port fail: %s",
+                argv[i]);
+            SS_THROW(
+                cfg->metricsPort >= 0 && cfg->metricsPort < 65536,
+                "metrics port out of range: %d, acceptable range: [0, 65536)",
+                cfg->metricsPort);
+        } else if (len > 10 && ::strncmp(argv[i], "-log-file=", 10) == 0) {
+            ss::Log::Singleton()->setOutputFile(argv[i] + 10);
+        } else if (len > 7 && ::strncmp(argv[i], "-trace=", 7) == 0) {
+            cfg->tracePath = argv[i] + 7;
         } else if (len > 16 && ::strncmp(argv[i], "-broadcast-port=", 16) == 0) {
             SS_THROW(
                 ::sscanf(argv[i] + 16, "%d", &cfg->broadcastPort) == 1,
@@ -37,28 +142,226 @@ static std::unique_ptr<ss::Config> parse_config(int argc, char* argv[]) {
             cfg->debugPts = true;
         } else if (::strcmp(argv[i], "-debug-decode") == 0) {
             cfg->debugDecode = true;
+        } else if (::strcmp(argv[i], "-debug-latency") == 0) {
+            cfg->debugLatency = true;
+        } else if (::strcmp(argv[i], "-debug-upload") == 0) {
+            cfg->debugUpload = true;
+        } else if (::strcmp(argv[i], "-no-dirty-tile") == 0) {
+            cfg->dirtyTile = false;
+        } else if (::strcmp(argv[i], "-debug-stage") == 0) {
+            cfg->debugStage = true;
+        } else if (::strcmp(argv[i], "-overlay") == 0) {
+            cfg->overlay = true;
+        } else if (::strcmp(argv[i], "-huge-pages") == 0) {
+#if !defined(XM_OS_LINUX)
+            SS_THROW(0, "'-huge-pages' only support linux");
+#endif
+            cfg->hugePages = true;
+        } else if (len > 5 && ::strncmp(argv[i], "-pin=", 5) == 0) {
+#if !defined(XM_OS_LINUX)
+            SS_THROW(0, "'-pin' only support linux");
+#endif
+            parse_pin(argv[i] + 5, cfg.get());
+        } else if (::strcmp(argv[i], "-priority=normal") == 0) {
+            cfg->threadPriority = ss::ThreadPriority::NORMAL;
+        } else if (::strcmp(argv[i], "-priority=nice") == 0) {
+#if !defined(XM_OS_LINUX)
+            SS_THROW(0, "'-priority' only support linux");
+#endif
+            cfg->threadPriority = ss::ThreadPriority::NICE;
+        } else if (::strcmp(argv[i], "-priority=fifo") == 0) {
+#if !defined(XM_OS_LINUX)
+            SS_THROW(0, "'-priority' only support linux");
+#endif
+            cfg->threadPriority = ss::ThreadPriority::FIFO;
+        } else if (len > 14 && ::strncmp(argv[i], "-paint-frames=", 14) == 0) {
+            SS_THROW(
+                ::sscanf(argv[i] + 14, "%d", &cfg->paintFrames) == 1,
+                "parse paint frames fail: %s",
+                argv[i]);
+            SS_THROW(
+                cfg->paintFrames >= 0 && cfg->paintFrames <= 20,
+                "paint frames out of range: %d, acceptable range: [0, 20]",
+                cfg->paintFrames);
+        } else if (len > 14 && ::strncmp(argv[i], "-frame-memory=", 14) == 0) {
+            int mb = 0;
+            SS_THROW(
+                ::sscanf(argv[i] + 14, "%d", &mb) == 1, "parse frame memory fail: %s", argv[i]);
+            SS_THROW(mb >= 0, "frame memory out of range: %d, acceptable range: [0, +inf)", mb);
+            cfg->frameMemoryBudget = (int64_t)mb << 20;
+        } else if (len > 7 && ::strncmp(argv[i], "-bench=", 7) == 0) {
+            cfg->benchClip = argv[i] + 7;
+        } else if (::strcmp(argv[i], "-bench-paced") == 0) {
+            cfg->benchPaced = true;
+        } else if (::strcmp(argv[i], "-headless=egl") == 0) {
+#if !defined(XM_OS_LINUX)
+            SS_THROW(0, "'-headless' only support linux");
+#endif
+            cfg->render = ss::RenderBackend::HEADLESS_EGL;
+        } else if (::strcmp(argv[i], "-headless=cpu") == 0) {
+#if !defined(XM_OS_LINUX)
+            SS_THROW(0, "'-headless' only support linux");
+#endif
+            cfg->render = ss::RenderBackend::HEADLESS_CPU;
+        } else if (::strcmp(argv[i], "-headless=sw") == 0) {
+#if !defined(XM_OS_LINUX)
+            SS_THROW(0, "'-headless' only support linux");
+#endif
+            cfg->render = ss::RenderBackend::HEADLESS_SW;
+        } else if (::strcmp(argv[i], "-sw-render") == 0) {
+#if !defined(XM_OS_LINUX)
+            SS_THROW(0, "'-sw-render' only support linux");
+#endif
+            cfg->swRender = true;
+        } else if (len > 19 && ::strncmp(argv[i], "-sw-render-threads=", 19) == 0) {
+            SS_THROW(
+                ::sscanf(argv[i] + 19, "%d", &cfg->swRenderThreads) == 1,
+                "parse software render threads fail: %s",
+                argv[i]);
+            SS_THROW(
+                cfg->swRenderThreads >= 0 && cfg->swRenderThreads <= 16,
+                "software render threads out of range: %d, acceptable range: [0, 16]",
+                cfg->swRenderThreads);
+        } else if (len > 15 && ::strncmp(argv[i], "-headless-size=", 15) == 0) {
+            SS_THROW(
+                ::sscanf(argv[i] + 15, "%dx%d", &cfg->headlessWidth, &cfg->headlessHeight) == 2,
+                "parse headless size fail: %s",
+                argv[i]);
+            SS_THROW(
+                cfg->headlessWidth > 0 && cfg->headlessHeight > 0,
+                "headless size out of range: %dx%d",
+                cfg->headlessWidth,
+                cfg->headlessHeight);
+        } else if (len > 17 && ::strncmp(argv[i], "-headless-frames=", 17) == 0) {
+            unsigned long long frames = 0;
+            SS_THROW(
+                ::sscanf(argv[i] + 17, "%llu", &frames) == 1,
+                "parse headless frames fail: %s",
+                argv[i]);
+            cfg->headlessFrames = frames;
+        } else if (::strcmp(argv[i], "-gl-legacy") == 0) {
+            cfg->glLegacy = true;
+        } else if (::strcmp(argv[i], "-gl-packed-planes") == 0) {
+            cfg->glPackedPlanes = true;
+        } else if (::strcmp(argv[i], "-hidden-decode=all") == 0) {
+            cfg->hiddenDecode = ss::HiddenDecode::ALL;
+        } else if (::strcmp(argv[i], "-hidden-decode=nonref") == 0) {
+            cfg->hiddenDecode = ss::HiddenDecode::NONREF;
+        } else if (::strcmp(argv[i], "-hidden-decode=none") == 0) {
+            cfg->hiddenDecode = ss::HiddenDecode::NONE;
+        } else if (::strcmp(argv[i], "-pipeline=threaded") == 0) {
+            cfg->pipeline = ss::PipelineMode::THREADED;
+        } else if (::strcmp(argv[i], "-pipeline=inline") == 0) {
+#if !defined(XM_OS_LINUX)
+            SS_THROW(0, "'-pipeline=inline' only support linux");
+#endif
+            cfg->pipeline = ss::PipelineMode::INLINE;
+        } else if (len > 22 && ::strncmp(argv[i], "-inline-decode-budget=", 22) == 0) {
+            SS_THROW(
+                ::sscanf(argv[i] + 22, "%d", &cfg->inlineDecodeBudget) == 1,
+                "parse inline decode budget fail: %s",
+                argv[i]);
+            SS_THROW(
+                cfg->inlineDecodeBudget >= 0,
+                "inline decode budget out of range: %d, acceptable range: [0, +inf)",
+                cfg->inlineDecodeBudget);
         } else {
             SS_THROW(0, "unknown command line arg: %s", argv[i]);
         }
     }
 
+    SS_THROW(
+        cfg->sessionCount() == 1 || cfg->pipeline == ss::PipelineMode::THREADED,
+        "'-pipeline=inline' only support one session");
+    SS_THROW(!cfg->relay || cfg->sessionCount() == 1, "'-relay' only support one session");
+
+    SS_THROW(!cfg->benchPaced || !cfg->benchClip.empty(), "'-bench-paced' need '-bench'");
+    // bench connect fake sender on loopback, measure pipeline as fast as it can present.
+    if (!cfg->benchClip.empty()) {
+        SS_THROW(cfg->ips.empty(), "'-bench' not support '-ip'");
+        cfg->ips.push_back("127.0.0.1");
+        cfg->immediatelyPaint = true;
+        cfg->reconnect = false;
+        cfg->senderCachePath.clear();
+        cfg->debugStage = true;
+        if (cfg->headlessFrames == 0) {
+            cfg->headlessFrames = 600;
+        }
+#if defined(XM_OS_LINUX)
+        const char* display = ::getenv("DISPLAY");
+        if (cfg->render == ss::RenderBackend::WINDOW && (!display || !*display)) {
+            cfg->render = ss::RenderBackend::HEADLESS_SW;
+        }
+#endif
+    }
+
+    std::string ipsStr;
+    for (const std::string& ip : cfg->ips) {
+        ipsStr += ipsStr.empty() ? ip : ", " + ip;
+    }
+
+    // headless is for benchmark, always report stages.
+    if (cfg->render != ss::RenderBackend::WINDOW) {
+        cfg->debugStage = true;
+    }
+
     // clang-format off
     ss::Log::I(
         "current config:\n"
-        "- ip: %s\n"
+        "- ips: %s\n"
         "- port: %d\n"
         "- broadcast port: %d\n"
-        "- immedlately paint: %s",
-        cfg->ip.empty() ? "empty" : cfg->ip.c_str(),
+        "- sender cache: %s\n"
+        "- reconnect: %s\n"
+        "- relay port: %s\n"
+        "- record: %s\n"
+        "- metrics port: %s\n"
+        "- trace: %s\n"
+        "- bench: %s\n"
+        "- thread priority: %s\n"
+        "- immedlately paint: %s\n"
+        "- pipeline: %s\n"
+        "- hidden decode: %s\n"
+        "- dirty tile: %s\n"
+        "- gl legacy: %s\n"
+        "- gl packed planes: %s\n"
+        "- render: %s\n"
+        "- software render: %s",
+        ipsStr.empty() ? "empty" : ipsStr.c_str(),
         cfg->port,
         cfg->broadcastPort,
-        cfg->immediatelyPaint ? "true" : "false"
+        cfg->senderCachePath.empty() ? "disable" : cfg->senderCachePath.c_str(),
+        cfg->reconnect ? "true" : "false",
+        cfg->relay ? std::to_string(cfg->relayPort).c_str() : "disable",
+        cfg->recordPath.empty() ? "disable" : cfg->recordPath.c_str(),
+        cfg->metricsPort > 0 ? std::to_string(cfg->metricsPort).c_str() : "disable",
+        cfg->tracePath.empty() ? "disable" : cfg->tracePath.c_str(),
+        cfg->benchClip.empty() ? "disable" : cfg->benchClip.c_str(),
+        cfg->threadPriority == ss::ThreadPriority::FIFO   ? "fifo"
+        : cfg->threadPriority == ss::ThreadPriority::NICE ? "nice"
+                                                          : "normal",
+        cfg->immediatelyPaint ? "true" : "false",
+        cfg->pipeline == ss::PipelineMode::INLINE ? "inline" : "threaded",
+        cfg->hiddenDecode == ss::HiddenDecode::ALL      ? "all"
+        : cfg->hiddenDecode == ss::HiddenDecode::NONREF ? "nonref"
+                                                        : "none",
+        cfg->dirtyTile ? "true" : "false",
+        cfg->glLegacy ? "true" : "false",
+        cfg->glPackedPlanes ? "true" : "false",
+        cfg->render == ss::RenderBackend::HEADLESS_EGL   ? "headless egl"
+        : cfg->render == ss::RenderBackend::HEADLESS_CPU ? "headless cpu"
+        : cfg->render == ss::RenderBackend::HEADLESS_SW  ? "headless sw"
+                                                         : "window",
+        cfg->swRender ? "true" : "false"
     );
     // clang-format on
     return cfg;
 }
 
 int main(int argc, char* argv[]) {
+    // startup phases relative to it.
+    auto startupReport = std::make_unique<ss::StartupReport>();
+
     // use crtdbg for windows memory leak check.
 #if defined(XM_OS_WINDOWS) && !defined(NDEBUG)
     _CrtSetDbgFlag(_CRTDBG_ALLOC_MEM_DF | _CRTDBG_LEAK_CHECK_DF);
@@ -84,13 +387,72 @@ int main(int argc, char* argv[]) {
         ss::Log::I_STR(
             "command line usage:\n"
             "-help, print this\n"
-            "-ip=[addr], direct ip adress, e.g. -ip=192.168.1.1\n"
+            "-ip=[addr], direct ip adress, e.g. -ip=192.168.1.1, repeat it to view several\n"
+            "    devices in grid(max 16), e.g. -ip=192.168.1.1 -ip=192.168.1.2\n"
+            "-decode-threads=[n], decode threads shared by sessions(0: auto), e.g.\n"
+            "    -decode-threads=2\n"
             "-port=[port], connect port, e.g. -port=1314\n"
             "-broadcast-port=[port], broadcast port, e.g. -broadcast-port=1413\n"
+            "-sender-cache=[path], file of last sender found by broadcast, connect it directly\n"
+            "    while broadcast receiving on next start, default ~/.share_screen_sender\n"
+            "-no-sender-cache, disable sender cache\n"
+            "-startup-report, print startup phases(window/gl, discovery, connect, decode...)\n"
+            "    time after first frame presented\n"
+            "-no-reconnect, exit on net error instead of reconnect(keep window and last frame)\n"
+            "-relay, re-serve received stream to downstream viewers(one session only)\n"
+            "-relay-port=[port], relay listen port, e.g. -relay-port=1315\n"
+            "-record=[path], remux stream to mp4/mkv file without re-encoding, e.g.\n"
+            "    -record=a.mkv, several sessions record to a_0.mkv, a_1.mkv...\n"
+            "-metrics-port=[port], serve prometheus metrics on http://127.0.0.1:[port]/metrics,\n"
+            "    e.g. -metrics-port=9464\n"
+            "-log-file=[path], append log to file instead of stdout, e.g. -log-file=ss.log\n"
+            "-trace=[path], trace thread activity, dump chrome trace json at exit and on SIGUSR1,\n"
+            "    e.g. -trace=trace.json, open by chrome://tracing or ui.perfetto.dev\n"
             "-immediately-paint, enable immediately paint\n"
             "-debug-net, print net info to log\n"
             "-debug-pts, print pts info to log\n"
-            "-debug-decode, print decode info to log");
+            "-debug-decode, print decode info to log\n"
+            "-debug-latency, print latency(net receive -> swap buffers) to log every second\n"
+            "-debug-upload, print texture upload bytes and skip ratio to log every second\n"
+            "-no-dirty-tile, upload full frame image instead of changed 64x64 tiles\n"
+            "-gl-legacy, force opengl 2.1 path instead of 3.3 core(vao/vbo/immutable texture)\n"
+            "-gl-packed-planes, pack y/u/v planes to one texture\n"
+            "-debug-stage, print per stage(net/queue/decode/sync/wait/paint/swap/total) time\n"
+            "    percentiles(p50/p95/p99/max) to log every second, and for whole run at exit\n"
+            "-paint-frames=[n], decoded frames pool per session(0: auto, 3 if immediately paint,\n"
+            "    else 4 and grow on demand up to 20), e.g. -paint-frames=3\n"
+            "-frame-memory=[MB], ceiling of decoded frames held by pipeline(all sessions, 0: no\n"
+            "    limit), decode wait when reached, e.g. -frame-memory=256\n"
+            "-huge-pages, decoded frames and packets larger than 1MB(1440p/4k) on 2MB pages,\n"
+            "    MAP_HUGETLB or transparent huge page, on numa node of consumer thread(only for\n"
+            "    linux)\n"
+            "-pin=[net|decode|pts|main|record]:[cpus], pin thread(all decode workers for\n"
+            "    decode) to cpus(only for linux), repeat it for several threads, e.g.\n"
+            "    -pin=pts:2 -pin=main:3 -pin=decode:4-7\n"
+            "-priority=[normal|nice|fifo], priority of pts and main thread(only for linux), fifo:\n"
+            "    SCHED_FIFO, nice: nice -10, fallback to lower one without privilege\n"
+            "-bench=[clip], serve h264 clip(no b frames, any container) by fake sender on\n"
+            "    127.0.0.1 and view it as fast as possible, report throughput, stage percentiles\n"
+            "    and cpu time per thread at exit, headless sw if no display, e.g. -bench=a.mp4\n"
+            "-bench-paced, bench sender send at frame rate of clip, compare latency(stage total)\n"
+            "    of pipelines, e.g. -bench=a.mp4 -bench-paced -pipeline=inline\n"
+            "-overlay, show stats(fps/bitrate/stage times/latency/frame time graph/drops) over\n"
+            "    video at start, toggle by key 'o' in window(opengl only)\n"
+            "-headless=[egl|cpu|sw], render without display(only for linux), egl: gl on pbuffer,\n"
+            "    cpu: copy frame to memory, sw: software render to memory, imply -debug-stage\n"
+            "-headless-size=[w]x[h], headless render size, e.g. -headless-size=1920x1080\n"
+            "-headless-frames=[n], headless exit after present n frames(0: never),\n"
+            "    e.g. -headless-frames=600\n"
+            "-sw-render, software render(no opengl) presented by MIT-SHM(only for linux), auto\n"
+            "    fallback to it if opengl not available\n"
+            "-sw-render-threads=[n], software render convert threads(0: auto), e.g.\n"
+            "    -sw-render-threads=4\n"
+            "-hidden-decode=[all|nonref|none], decode while window hidden, default nonref(only\n"
+            "    reference frames), none: skip decode and request key frame when visible\n"
+            "-pipeline=[threaded|inline], frame pipeline, default threaded, inline run net read/\n"
+            "    decode/pts/paint on main thread for lower latency(only for linux)\n"
+            "-inline-decode-budget=[ms], inline pipeline offload decode to decode thread when\n"
+            "    decode continuous exceed it, e.g. -inline-decode-budget=8");
         return 0;
     }
 
@@ -99,24 +461,63 @@ int main(int argc, char* argv[]) {
     std::unique_ptr<ss::PtsThread> ptsThread;
     std::unique_ptr<ss::DecodeThread> decodeThread;
     std::unique_ptr<ss::NetThread> netThread;
+    std::unique_ptr<ss::RecordThread> recordThread;
+    std::unique_ptr<ss::Trace> trace;
+    std::unique_ptr<ss::Metrics> metrics;
+    std::unique_ptr<ss::Bench> bench;
+    std::unique_ptr<ss::HugePageAlloc> hugePages;
 
+    bool initialized = false;
     try {
         cfg = parse_config(argc, argv);
+        ss::StartupReport::End(ss::StartupReport::CONFIG);
+        // before pipeline threads, they trace by it.
+        if (!cfg->tracePath.empty()) {
+            trace = std::make_unique<ss::Trace>(cfg->tracePath);
+        }
+        if (cfg->metricsPort > 0) {
+            metrics = std::make_unique<ss::Metrics>();
+        }
+        // before pipeline threads, they register cpu clock by it.
+        if (!cfg->benchClip.empty()) {
+            bench = std::make_unique<ss::Bench>(cfg->benchClip, cfg->benchPaced);
+            cfg->port = bench->port();
+        }
+        // before decoder and net frames allocated.
+        if (cfg->hugePages) {
+            hugePages = std::make_unique<ss::HugePageAlloc>();
+        }
+        // only event queue, window and gl created by `init`.
         mainThread = std::make_unique<ss::MainThread>();
-        if (!cfg->immediatelyPaint) {
+        // inline pipeline sync pts on main thread.
+        if (!cfg->immediatelyPaint && cfg->pipeline == ss::PipelineMode::THREADED) {
             ptsThread = std::make_unique<ss::PtsThread>();
         }
+        // decoder opened before first packet.
         decodeThread = std::make_unique<ss::DecodeThread>();
+        if (!cfg->recordPath.empty()) {
+            recordThread = std::make_unique<ss::RecordThread>();
+        }
+        // discovery and connect run while window and gl init.
         netThread = std::make_unique<ss::NetThread>();
+        mainThread->init();
+        initialized = true;
     } catch (const ss::Error& e) {
         ss::Log::PrintError(e);
-        return 0;
     } catch (const std::exception& e) {
         ss::Log::E("catch %s: %s, %s#%d", typeid(e).name(), e.what(), __FILE__, __LINE__);
-        return 0;
     }
 
-    mainThread->loop();
+    if (initialized) {
+        mainThread->loop();
+    }
+    if (cfg && cfg->startupReport) {
+        startupReport->report();
+    }
+    // pipeline threads still alive, their cpu clocks valid.
+    if (initialized && bench) {
+        bench->report();
+    }
 
     if (netThread) {
         netThread->notifyClose();
@@ -133,9 +534,26 @@ int main(int argc, char* argv[]) {
         ptsThread->join();
     }
 
+    // after net thread, no more frames.
+    if (recordThread) {
+        recordThread->notifyClose();
+        recordThread->join();
+    }
+
     netThread = nullptr;
     decodeThread = nullptr;
     ptsThread = nullptr;
+    recordThread = nullptr;
     mainThread = nullptr;
+    // after net thread, receiver closed.
+    bench = nullptr;
+    // buffers freed by munmap, may outlive it.
+    hugePages = nullptr;
+
+    // all threads joined, no more events.
+    if (trace) {
+        trace->dump();
+        trace = nullptr;
+    }
     return 0;
 }
\ No newline at end of file
@@ -1,5 +1,15 @@
 #include <ss/MainThread.hpp>
 #include <ss/DecodeThread.hpp>
+#include <ss/Metrics.hpp>
+#include <ss/NetThread.hpp>
+#include <ss/StartupReport.hpp>
+#include <ss/Trace.hpp>
+#include <ss/Bench.hpp>
+#include <ss/ThreadPolicy.hpp>
+
+extern "C" {
+#include <libavutil/imgutils.h>
+}
 
 namespace ss {
 MainThread::MainThread() {
@@ -14,9 +24,48 @@ MainThread::MainThread() {
         mLocale.asEn();
     }
 
+    mSessionCount = Config::Singleton()->sessionCount();
+}
+
+void MainThread::init() {
+    StartupReport::Begin(StartupReport::WINDOW_GL);
+    initRender();
+    StartupReport::End(StartupReport::WINDOW_GL);
+}
+
+void MainThread::initRender() {
     initWindowAndGl();
     setWindowTitle(mLocale.title_connecting.c_str());
-    mRender.emplace();
+    Config* cfg = Config::Singleton();
+#if defined(XM_OS_LINUX)
+    if (isSoftware()) {
+        int threads = cfg->swRenderThreads;
+        if (threads <= 0) {
+            threads = std::clamp((int)std::thread::hardware_concurrency(), 1, 4);
+        }
+        for (int i = 0; i < mSessionCount; ++i) {
+            mSwRenders[i].emplace(std::max(threads / mSessionCount, 1));
+        }
+        return;
+    }
+#endif
+    if (cfg->render != RenderBackend::HEADLESS_CPU) {
+        for (int i = 0; i < mSessionCount; ++i) {
+            mRenders[i].emplace();
+        }
+        // views share window, keep clear and draw in own view.
+        if (mSessionCount > 1) {
+            glEnable(GL_SCISSOR_TEST);
+        }
+        // optional, run without it if gl not capable.
+        try {
+            mOverlay.emplace();
+            mOverlayVisible = cfg->overlay;
+        } catch (const Error& e) {
+            Log::PrintError(e);
+            Log::W("gl overlay disabled");
+        }
+    }
 }
 
 void MainThread::notifyPaintFrame(PaintFrame* paintFrame) {
@@ -32,59 +81,582 @@ void MainThread::notifyClose() {
     }
 }
 
+void MainThread::notifyNetConnected() {
+    postEvent({EVENT_TYPE_NET_CONNECTED, nullptr, nullptr});
+}
+
+void MainThread::notifyInlineNetFrame(NetFrame* netFrame) {
+    // call by net loop(c code), so never throw from here.
+    try {
+        DecodeThread* decodeThread = DecodeThread::Singleton();
+        if (decodeThread->isOffloaded()) {
+            decodeThread->notifyDecodeFrame(netFrame);
+            return;
+        }
+
+        PaintFrame* dst = decodeThread->obtainPaintFrameInline();
+        // pool exhausted by frames wait for paint, paint the oldest early.
+        while (!dst && !mInlineFrames.empty()) {
+            PaintFrame* oldest = mInlineFrames.front().paintFrame;
+            mInlineFrames.pop_front();
+            present(oldest);
+            dst = decodeThread->obtainPaintFrameInline();
+        }
+        SS_THROW(dst, "paint frame pool exhausted");
+
+        clock::time_point now0 = clock::now();
+        bool output = decodeThread->decode(netFrame, dst);
+        clock::duration decodeTime = clock::now() - now0;
+
+        NetThread::Singleton()->recycleNetFrameInline(netFrame);
+        if (output) {
+            scheduleInline(dst);
+        } else {
+            decodeThread->notifyRecyclePaintFrame(dst);
+        }
+
+        if (decodeTime > chrono::milliseconds(Config::Singleton()->inlineDecodeBudget)) {
+            ++mInlineOverBudget;
+            if (mInlineOverBudget >= INLINE_DECODE_OVER_BUDGET_LIMIT) {
+                Log::I(
+                    "decode time: %lldms, exceed budget: %dms, offload decode to decode thread",
+                    (long long)chrono::duration_cast<chrono::milliseconds>(decodeTime).count(),
+                    Config::Singleton()->inlineDecodeBudget);
+                decodeThread->offload();
+            }
+        } else {
+            mInlineOverBudget = 0;
+        }
+    } catch (const Error& e) {
+        Log::PrintError(e);
+        mClose = true;
+    } catch (const std::exception& e) {
+        Log::E("catch %s: %s, %s#%d", typeid(e).name(), e.what(), __FILE__, __LINE__);
+        mClose = true;
+    }
+}
+
 void MainThread::loop() {
+    Trace::SetThreadName("main");
+    Bench::RegisterThread("main");
+    ApplyThreadPolicy(ThreadRole::MAIN);
+#if defined(XM_OS_LINUX)
+    if (Config::Singleton()->pipeline == PipelineMode::INLINE) {
+        loopInline();
+    } else {
+        loopThreaded();
+    }
+#else
+    loopThreaded();
+#endif
+
+    if (Config::Singleton()->debugStage && mStageTotal.stages[StageStats::TOTAL].count()) {
+        LogStageStats("stage total", mStageTotal);
+    }
+}
+
+void MainThread::loopThreaded() {
     while (!mClose) {
         pollEvent(chrono::milliseconds(2000));
+        if (Trace* trace = Trace::Singleton()) {
+            trace->dumpIfRequested();
+        }
         for (std::optional<Event> e = peekEvent(); e; e = peekEvent()) {
-            switch (e->type) {
-                case EVENT_TYPE_WIN_RESIZE: {
-                    size_t newWidth = (size_t)e->data0;
-                    size_t newHeight = (size_t)e->data1;
-                    if (mWinWidth != newWidth || mWinHeight != newHeight) {
-                        Log::I(
-                            "win size changed: (%d, %d) -> (%d, %d)",
-                            (int)mWinWidth,
-                            (int)mWinHeight,
-                            (int)newWidth,
-                            (int)newHeight);
-                        mWinWidth = newWidth;
-                        mWinHeight = newHeight;
-                        draw(nullptr);
+            TraceZone zone("handle event");
+            if (!handleEvent(*e)) {
+                return;
+            }
+        }
+        presentPending();
+    }
+}
+
+bool MainThread::handleEvent(const Event& e) {
+    switch (e.type) {
+        case EVENT_TYPE_WIN_RESIZE: {
+            size_t newWidth = (size_t)e.data0;
+            size_t newHeight = (size_t)e.data1;
+            if (mWinWidth != newWidth || mWinHeight != newHeight) {
+                Log::I(
+                    "win size changed: (%d, %d) -> (%d, %d)",
+                    (int)mWinWidth,
+                    (int)mWinHeight,
+                    (int)newWidth,
+                    (int)newHeight);
+                mWinWidth = newWidth;
+                mWinHeight = newHeight;
+                draw(nullptr);
+            }
+            break;
+        }
+        case EVENT_TYPE_WIN_VISIBILITY: {
+            bool visible = e.data0 != nullptr;
+            if (mWinVisible == visible) {
+                break;
+            }
+            mWinVisible = visible;
+            Log::I("win visibility changed: %s", visible ? "visible" : "hidden");
+            DecodeThread::Singleton()->notifyVisible(visible);
+            if (visible) {
+                // decoder references dropped while hidden.
+                if (Config::Singleton()->hiddenDecode == HiddenDecode::NONE) {
+                    for (int i = 0; i < mSessionCount; ++i) {
+                        NetThread::Singleton()->notifyRequestKeyFrame(i);
                     }
-                    break;
                 }
-                case EVENT_TYPE_PAINT_FRAME: {
-                    PaintFrame* paintFrame = (PaintFrame*)e->data0;
-                    draw(paintFrame);
-                    DecodeThread::Singleton()->notifyRecyclePaintFrame(paintFrame);
-
-                    ++mFps;
-                    clock::time_point nowTp = clock::now();
-                    if (nowTp - mFpsTp > std::chrono::seconds(1)) {
-                        char titleStr[512];
-                        snprintf(titleStr, 512, mLocale.title_connected.c_str(), (int)mFps);
-                        setWindowTitle(titleStr);
-                        mFpsTp = nowTp;
-                        mFps = 0;
+                draw(nullptr);
+            }
+            break;
+        }
+        case EVENT_TYPE_WIN_CLICK: {
+            if (mSessionCount == 1) {
+                break;
+            }
+            int x = (int)(size_t)e.data0;
+            int y = (int)(size_t)e.data1;
+            for (int i = 0; i < mSessionCount; ++i) {
+                ViewRect view = viewRect(i);
+                if (x < view.x || x >= view.x + view.w || y < view.y || y >= view.y + view.h) {
+                    continue;
+                }
+                if (mFocusSession != i) {
+                    // decode focused session first, lowest latency for it.
+                    if (mFocusSession >= 0) {
+                        DecodeThread::Singleton()->notifySessionPriority(mFocusSession, 0);
                     }
-                    break;
+                    DecodeThread::Singleton()->notifySessionPriority(i, 1);
+                    mFocusSession = i;
+                    Log::I("focus session: %d", i);
+                }
+                break;
+            }
+            break;
+        }
+        case EVENT_TYPE_WIN_KEY: {
+            char key = (char)(size_t)e.data0;
+            if ((key == 'o' || key == 'O') && mOverlay) {
+                mOverlayVisible = !mOverlayVisible;
+                mOverlaySums = {};
+                mLastPresentTp = {};
+                Log::I("overlay: %s", mOverlayVisible ? "show" : "hide");
+                draw(nullptr);
+            }
+            break;
+        }
+        case EVENT_TYPE_PAINT_FRAME: {
+            PaintFrame* paintFrame = (PaintFrame*)e.data0;
+            if (mNetInline) {
+                // decode offloaded, but still sync pts on main thread.
+                scheduleInline(paintFrame);
+                break;
+            }
+            if (mSessionCount > 1) {
+                // only latest frame of session shown, drop older not presented yet.
+                PaintFrame*& pending = mPendingFrames[paintFrame->session];
+                if (pending) {
+                    DecodeThread::Singleton()->notifyRecyclePaintFrame(pending);
+                    ++mPresentDrops;
                 }
-                case EVENT_TYPE_WIN_CLOSE:
-                case EVENT_TYPE_CLOSE:
-                    return;
+                pending = paintFrame;
+                break;
+            }
+            present(paintFrame);
+            break;
+        }
+#if defined(XM_OS_LINUX)
+        case EVENT_TYPE_NET_CONNECTED: {
+            NetThread::Singleton()->startInline();
+            setExtraPollFd(NetThread::Singleton()->inlineBackendFd());
+            mNetInline = true;
+            Log::I_STR("net loop run on main thread");
+            break;
+        }
+#endif
+        case EVENT_TYPE_WIN_CLOSE:
+        case EVENT_TYPE_CLOSE:
+            return false;
+    }
+    return true;
+}
+
+void MainThread::present(PaintFrame* paintFrame) {
+    TraceZone zone("present");
+    clock::time_point beginTp = clock::now();
+    // nobody can see it, skip upload and swap.
+    if (mWinVisible) {
+        draw(&paintFrame);
+    } else {
+        mPaintTime = {};
+        mSwapTime = {};
+    }
+
+    finishPresent(paintFrame, beginTp);
+}
+
+void MainThread::presentPending() {
+    PaintFrame** end = mPendingFrames + mSessionCount;
+    if (std::all_of(mPendingFrames, end, [](PaintFrame* i) { return !i; })) {
+        return;
+    }
+
+    TraceZone zone("present");
+    clock::time_point beginTp = clock::now();
+    if (mWinVisible) {
+        draw(mPendingFrames);
+    } else {
+        mPaintTime = {};
+        mSwapTime = {};
+    }
+
+    for (PaintFrame*& i : mPendingFrames) {
+        if (i) {
+            finishPresent(i, beginTp);
+            i = nullptr;
+        }
+    }
+}
+
+void MainThread::finishPresent(PaintFrame* paintFrame, clock::time_point beginTp) {
+    Config* cfg = Config::Singleton();
+    if (cfg->debugLatency) {
+        clock::duration latency = clock::now() - paintFrame->recvTp;
+        mLatencySum += latency;
+        mLatencyMax = std::max(mLatencyMax, latency);
+    }
+
+    if (cfg->debugStage) {
+        const PaintFrame& f = *paintFrame;
+        clock::duration durations[StageStats::STAGE_COUNT] = {
+            f.recvTp - f.headerTp,
+            f.decodeBeginTp - f.recvTp,
+            f.decodeEndTp - f.decodeBeginTp,
+            f.releaseTp - f.decodeEndTp,
+            beginTp - f.releaseTp,
+            mPaintTime,
+            mSwapTime,
+            beginTp + mPaintTime + mSwapTime - f.headerTp,
+        };
+        for (StageStats* stats : {&mStageStats, &mStageTotal}) {
+            for (int i = 0; i < StageStats::STAGE_COUNT; ++i) {
+                stats->stages[i].add(durations[i]);
+            }
+        }
+    }
+
+    if (mOverlayVisible) {
+        const PaintFrame& f = *paintFrame;
+        OverlaySums& sums = mOverlaySums;
+        clock::duration latency = beginTp + mPaintTime + mSwapTime - f.headerTp;
+        ++sums.frames;
+        sums.bodyBytes += (uint64_t)f.bodySize;
+        sums.decode += f.decodeEndTp - f.decodeBeginTp;
+        sums.latency += latency;
+        sums.latencyMax = std::max(sums.latencyMax, latency);
+        // frames of one multi session present share begin time.
+        if (beginTp != mLastPresentTp) {
+            if (mLastPresentTp != clock::time_point {}) {
+                mOverlay->pushFrameTime(beginTp - mLastPresentTp);
             }
+            mLastPresentTp = beginTp;
+            ++sums.presents;
+            sums.paint += mPaintTime;
+            sums.swap += mSwapTime;
+        }
+    }
+
+    Metrics::Add(Metrics::PRESENTED_FRAMES, paintFrame->session);
+    Metrics::Observe(
+        Metrics::LATENCY,
+        paintFrame->session,
+        beginTp + mPaintTime + mSwapTime - paintFrame->headerTp);
+
+    DecodeThread::Singleton()->notifyRecyclePaintFrame(paintFrame);
+
+    if (mPresentFrames == 0) {
+        StartupReport::Begin(StartupReport::FIRST_PRESENT, beginTp);
+        StartupReport::End(StartupReport::FIRST_PRESENT);
+        if (cfg->startupReport) {
+            StartupReport::Singleton()->report();
+        }
+    }
+    ++mPresentFrames;
+    Bench::Present(beginTp + mPaintTime + mSwapTime);
+    if (cfg->headlessFrames && mPresentFrames >= cfg->headlessFrames) {
+        Log::I("headless present %llu frames, exit", (unsigned long long)mPresentFrames);
+        mClose = true;
+    }
+
+    ++mFps;
+    clock::time_point nowTp = clock::now();
+    if (nowTp - mFpsTp > std::chrono::seconds(1)) {
+        char titleStr[512];
+        snprintf(titleStr, 512, mLocale.title_connected.c_str(), (int)mFps);
+        setWindowTitle(titleStr);
+        Metrics::Set(Metrics::FPS, 0, mFps);
+
+        if (cfg->debugLatency) {
+            using ms = chrono::duration<double, std::milli>;
+            Log::I(
+                "latency(receive -> swap), avg: %.2fms, max: %.2fms, frames: %u",
+                chrono::duration_cast<ms>(mLatencySum).count() / mFps,
+                chrono::duration_cast<ms>(mLatencyMax).count(),
+                mFps);
+            mLatencySum = {};
+            mLatencyMax = {};
+        }
+
+        if (cfg->debugStage) {
+            LogStageStats("stage", mStageStats);
+            mStageStats.reset();
+        }
+
+        for (int i = 0; cfg->debugUpload && i < mSessionCount && mRenders[i]; ++i) {
+            GlRender::UploadStats stats = mRenders[i]->takeUploadStats();
+            double seconds = chrono::duration<double>(nowTp - mFpsTp).count();
+            using us = chrono::duration<double, std::micro>;
+            Log::I(
+                "upload[%d]: %s, %.2fMB/s, %.1fus/frame, dirty tiles: %llu/%llu, skip: %llu/%llu",
+                i,
+                stats.formatName,
+                stats.uploadBytes / seconds / (1024.0 * 1024.0),
+                stats.frames ? chrono::duration_cast<us>(stats.uploadTime).count() / stats.frames
+                             : 0.0,
+                (unsigned long long)stats.dirtyTiles,
+                (unsigned long long)stats.tiles,
+                (unsigned long long)stats.skipFrames,
+                (unsigned long long)stats.frames);
         }
+
+        if (mOverlayVisible) {
+            updateOverlay(chrono::duration<double>(nowTp - mFpsTp).count());
+        }
+
+        mFpsTp = nowTp;
+        mFps = 0;
     }
 }
 
-void MainThread::draw(PaintFrame* paintFrame) {
+void MainThread::draw(PaintFrame* const* paintFrames) {
     if (!mWinWidth || !mWinHeight) {
         return;
     }
 
-    glViewport(0, 0, mWinWidth, mWinHeight);
-    glScissor(0, 0, mWinWidth, mWinHeight);
-    mRender->paint(paintFrame);
-    swapBuffers();
+    clock::time_point now0 = clock::now();
+    int winW = (int)mWinWidth;
+    int winH = (int)mWinHeight;
+    if (mRenders[0] && mSessionCount > 1) {
+        // grid may have empty views.
+        glViewport(0, 0, winW, winH);
+        glScissor(0, 0, winW, winH);
+        glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT);
+    }
+#if defined(XM_OS_LINUX)
+    SwRender::Target image = {nullptr, 0, winW, winH};
+    if (mSwRenders[0]) {
+        image.data = obtainSwImage(winW, winH, &image.stride);
+        if (mSessionCount > 1) {
+            for (int y = 0; y < winH; ++y) {
+                ::memset(image.data + (size_t)y * image.stride, 0, (size_t)winW * 4);
+            }
+        }
+    }
+#endif
+
+    for (int i = 0; i < mSessionCount; ++i) {
+        PaintFrame* paintFrame = paintFrames ? paintFrames[i] : nullptr;
+        ViewRect view = viewRect(i);
+        if (mRenders[i]) {
+            // gl origin at bottom-left.
+            int glY = winH - view.y - view.h;
+            glViewport(view.x, glY, view.w, view.h);
+            glScissor(view.x, glY, view.w, view.h);
+            mRenders[i]->paint(paintFrame);
+#if defined(XM_OS_LINUX)
+        } else if (mSwRenders[i]) {
+            SwRender::Target target = {
+                image.data + (size_t)view.y * image.stride + (size_t)view.x * 4,
+                image.stride,
+                view.w,
+                view.h};
+            mSwRenders[i]->paint(paintFrame, target);
+#endif
+        } else if (paintFrame) {
+            sinkCpu(paintFrame);
+        }
+    }
+    if (mOverlay && mOverlayVisible) {
+        mOverlay->paint(winW, winH);
+    }
+    clock::time_point now1 = clock::now();
+    {
+        TraceZone zone("swap buffers");
+        swapBuffers();
+    }
+    mPaintTime = now1 - now0;
+    mSwapTime = clock::now() - now1;
+}
+
+MainThread::ViewRect MainThread::viewRect(int session) const {
+    // near square grid, fill row by row.
+    int cols = (int)std::ceil(std::sqrt((double)mSessionCount));
+    int rows = (mSessionCount + cols - 1) / cols;
+    int col = session % cols;
+    int row = session / cols;
+    int winW = (int)mWinWidth;
+    int winH = (int)mWinHeight;
+    int x0 = winW * col / cols;
+    int x1 = winW * (col + 1) / cols;
+    int y0 = winH * row / rows;
+    int y1 = winH * (row + 1) / rows;
+    return {x0, y0, x1 - x0, y1 - y0};
+}
+
+void MainThread::updateOverlay(double seconds) {
+    using ms = chrono::duration<double, std::milli>;
+    const OverlaySums& sums = mOverlaySums;
+    GlOverlay::Stats stats;
+    stats.fps = mFps;
+    stats.mbps = (double)sums.bodyBytes * 8.0 / seconds / 1e6;
+    if (sums.frames) {
+        stats.decodeMs = chrono::duration_cast<ms>(sums.decode).count() / sums.frames;
+        stats.latencyMs = chrono::duration_cast<ms>(sums.latency).count() / sums.frames;
+    }
+    if (sums.presents) {
+        stats.paintMs = chrono::duration_cast<ms>(sums.paint).count() / sums.presents;
+        stats.swapMs = chrono::duration_cast<ms>(sums.swap).count() / sums.presents;
+    }
+    stats.latencyMaxMs = chrono::duration_cast<ms>(sums.latencyMax).count();
+    stats.decodeDrops = DecodeThread::Singleton()->droppedFrames();
+    stats.presentDrops = mPresentDrops;
+    mOverlay->setStats(stats);
+    mOverlaySums = {};
+}
+
+void MainThread::sinkCpu(PaintFrame* paintFrame) {
+    if (!paintFrame) {
+        return;
+    }
+    const AVFrame* f = paintFrame->decodeFrame;
+    AVPixelFormat pixFmt = (AVPixelFormat)f->format;
+    int size = av_image_get_buffer_size(pixFmt, f->width, f->height, 1);
+    check_libav(size, "av_image_get_buffer_size");
+    mSinkBuffer.resize((size_t)size);
+    check_libav(
+        av_image_copy_to_buffer(
+            mSinkBuffer.data(), size, f->data, f->linesize, pixFmt, f->width, f->height, 1),
+        "av_image_copy_to_buffer");
+}
+
+void MainThread::LogStageStats(const char* name, const StageStats& stats) {
+    static const char* const NAMES[StageStats::STAGE_COUNT] = {
+        "net",
+        "queue",
+        "decode",
+        "sync",
+        "wait",
+        "paint",
+        "swap",
+        "total",
+    };
+
+    std::string str = name;
+    char line[128];
+    snprintf(
+        line,
+        sizeof(line),
+        "(ms), frames: %llu\n  %-8s %8s %8s %8s %8s",
+        (unsigned long long)stats.stages[StageStats::TOTAL].count(),
+        "stage",
+        "p50",
+        "p95",
+        "p99",
+        "max");
+    str += line;
+    for (int i = 0; i < StageStats::STAGE_COUNT; ++i) {
+        const LatencyHistogram& h = stats.stages[i];
+        snprintf(
+            line,
+            sizeof(line),
+            "\n  %-8s %8.2f %8.2f %8.2f %8.2f",
+            NAMES[i],
+            h.percentile(50) / 1e3,
+            h.percentile(95) / 1e3,
+            h.percentile(99) / 1e3,
+            h.max() / 1e3);
+        str += line;
+    }
+    Log::I_STR(str.c_str());
+}
+
+#if defined(XM_OS_LINUX)
+void MainThread::loopInline() {
+    while (!mClose) {
+        // wait for: x11 event, cross thread event, net loop event, next paint time.
+        int timeout = 2000;
+        if (mNetInline) {
+            int netTimeout = NetThread::Singleton()->inlineBackendTimeout();
+            if (netTimeout >= 0) {
+                timeout = std::min(timeout, netTimeout);
+            }
+        }
+        if (!mInlineFrames.empty()) {
+            clock::duration wait = mInlineFrames.front().paintTp - clock::now();
+            timeout = std::min(
+                timeout,
+                (int)std::max<int64_t>(
+                    chrono::ceil<chrono::milliseconds>(wait).count(), (int64_t)0));
+        }
+        pollEvent(chrono::milliseconds(timeout));
+        if (Trace* trace = Trace::Singleton()) {
+            trace->dumpIfRequested();
+        }
+
+        if (mNetInline && !NetThread::Singleton()->pumpInline()) {
+            return;
+        }
+
+        presentDueInline();
+
+        for (std::optional<Event> e = peekEvent(); e; e = peekEvent()) {
+            TraceZone zone("handle event");
+            if (!handleEvent(*e)) {
+                return;
+            }
+        }
+    }
+}
+#endif
+
+void MainThread::scheduleInline(PaintFrame* paintFrame) {
+    clock::time_point now = clock::now();
+    if (Config::Singleton()->immediatelyPaint) {
+        mInlineFrames.push_back(InlineFrame {paintFrame, now});
+    } else if (mInlineFirstPts == 0 || paintFrame->epoch != mInlineEpoch) {
+        mInlineEpoch = paintFrame->epoch;
+        mInlineFirstPts = paintFrame->pts;
+        mInlineFirstTp = now;
+        mInlineFrames.push_back(InlineFrame {paintFrame, now});
+    } else {
+        clock::time_point paintTp =
+            mInlineFirstTp + chrono::microseconds(paintFrame->pts - mInlineFirstPts);
+        if (Config::Singleton()->debugPts) {
+            SS_LOG_I_DEFER(
+                "expect wait: %lldms, pts: %lld",
+                (long long)chrono::duration_cast<chrono::milliseconds>(paintTp - now).count(),
+                (long long)paintFrame->pts);
+        }
+        mInlineFrames.push_back(InlineFrame {paintFrame, paintTp});
+    }
+    presentDueInline();
+}
+
+void MainThread::presentDueInline() {
+    while (!mInlineFrames.empty() && mInlineFrames.front().paintTp <= clock::now()) {
+        PaintFrame* paintFrame = mInlineFrames.front().paintFrame;
+        mInlineFrames.pop_front();
+        paintFrame->releaseTp = clock::now();
+        present(paintFrame);
+    }
 }
 }  // namespace ss
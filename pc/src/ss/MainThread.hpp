@@ -3,9 +3,14 @@
 #include <ss/main_thread_impl/Linux.hpp>
 #include <ss/main_thread_impl/MacOs.hpp>
 #include <ss/GlRender.hpp>
+#include <ss/GlOverlay.hpp>
+#include <ss/SwRender.hpp>
+#include <ss/LatencyHistogram.hpp>
+
+#include <deque>
 
 namespace ss {
-/** ui/main thread, handle frame draw. */
+/** ui/main thread, handle frame draw. multi session draw views in grid of window. */
 class MainThread : protected detail::MainThreadImpl {
 public:
     using base_t = detail::MainThreadImpl;
@@ -14,20 +19,38 @@ public:
         return static_cast<MainThread*>(base_t::Singleton());
     }
 
+    /** window and gl not created yet, events can be posted. */
     MainThread();
 
+    /** create window and gl on main thread, may run while net thread connecting. */
+    void init();
+
     void notifyPaintFrame(PaintFrame* paintFrame);
 
     void notifyClose();
 
+    /** inline pipeline only, net thread connected, hand over net loop to main thread. */
+    void notifyNetConnected();
+
+    /** inline pipeline only, call by net loop on main thread, decode and schedule paint. */
+    void notifyInlineNetFrame(NetFrame* netFrame);
+
     void loop();
 
 private:
     enum : uint32_t {
         EVENT_TYPE_PAINT_FRAME = _EVENT_TYPE_APP,
         EVENT_TYPE_CLOSE,
+        EVENT_TYPE_NET_CONNECTED,
     };
 
+    enum : uint32_t {
+        /** inline pipeline, offload decode if continuous exceed budget count reach it. */
+        INLINE_DECODE_OVER_BUDGET_LIMIT = 5,
+    };
+
+    using clock = chrono::high_resolution_clock;
+
     struct Locale {
         std::string title_connecting;
         std::string title_connected;
@@ -43,17 +66,145 @@ private:
         }
     };
 
-    void draw(PaintFrame* paintFrame);
+    /** per stage time histograms of presented frames. */
+    struct StageStats {
+        enum Stage : int {
+            /** net header -> body receive complete. */
+            NET = 0,
+            /** body receive complete -> decode begin. */
+            QUEUE,
+            DECODE,
+            /** decode end -> pts release. */
+            SYNC,
+            /** pts release -> paint begin, cross thread and wait for main loop. */
+            WAIT,
+            /** render paint(upload, draw call), software: convert, headless cpu: copy planes. */
+            PAINT,
+            /** swap buffers, headless egl: gl finish, software: put image. */
+            SWAP,
+            /** net header -> swap done. */
+            TOTAL,
+            STAGE_COUNT,
+        };
+
+        void reset() {
+            for (LatencyHistogram& i : stages) {
+                i.reset();
+            }
+        }
+
+        LatencyHistogram stages[STAGE_COUNT];
+    };
+
+    /** sums of presented frames for overlay, reset every second. */
+    struct OverlaySums {
+        uint32_t frames = 0;
+        /** multi session, one present for several frames. */
+        uint32_t presents = 0;
+        uint64_t bodyBytes = 0;
+        clock::duration decode = {};
+        clock::duration paint = {};
+        clock::duration swap = {};
+        clock::duration latency = {};
+        clock::duration latencyMax = {};
+    };
+
+    /** view of session in window, top-left origin. */
+    struct ViewRect {
+        int x;
+        int y;
+        int w;
+        int h;
+    };
+
+    /** inline pipeline, paint-frame wait for paint. */
+    struct InlineFrame {
+        PaintFrame* paintFrame;
+        clock::time_point paintTp;
+    };
+
+    void initRender();
+
+    void loopThreaded();
+
+    /** return false if should exit loop. */
+    bool handleEvent(const Event& e);
+
+    /** draw paint-frame, then recycle it and update fps. */
+    void present(PaintFrame* paintFrame);
+
+    /** multi session, draw latest frame of sessions together, one swap for all views. */
+    void presentPending();
+
+    /** statistics of presented paint-frame, then recycle it. */
+    void finishPresent(PaintFrame* paintFrame, clock::time_point beginTp);
+
+    /** draw all views, `paintFrames` index by session, nullptr(or null item) repaint last. */
+    void draw(PaintFrame* const* paintFrames);
+
+    ViewRect viewRect(int session) const;
+
+    /** overlay stats of last second from sums, then reset sums. */
+    void updateOverlay(double seconds);
+
+    /** headless cpu, copy frame planes to memory instead of gl upload. */
+    void sinkCpu(PaintFrame* paintFrame);
+
+    static void LogStageStats(const char* name, const StageStats& stats);
+
+#if defined(XM_OS_LINUX)
+    void loopInline();
+#endif
+
+    /** inline pipeline, sync paint-frame with pts, same as PtsThread. */
+    void scheduleInline(PaintFrame* paintFrame);
+
+    /** inline pipeline, present all paint-frame reach paint time. */
+    void presentDueInline();
 
     //
-    using clock = chrono::high_resolution_clock;
 
     bool mClose = false;
     size_t mWinWidth = 0;
     size_t mWinHeight = 0;
+    /** skip draw while window hidden. */
+    bool mWinVisible = true;
     clock::time_point mFpsTp;
     uint32_t mFps;
+    uint64_t mPresentFrames = 0;
+    /** latency statistics(net receive -> swap buffers), reset every second. */
+    clock::duration mLatencySum = {};
+    clock::duration mLatencyMax = {};
+    /** stage statistics, reset every second, total for whole run. */
+    StageStats mStageStats;
+    StageStats mStageTotal;
+    /** time of last draw, paint and swap buffers. */
+    clock::duration mPaintTime = {};
+    clock::duration mSwapTime = {};
+    /** headless cpu, planes copy destination. */
+    xm::Array<uint8_t> mSinkBuffer;
     Locale mLocale;
-    std::optional<GlRender> mRender;
+    int mSessionCount = 1;
+    /** multi session, clicked view, -1 if none. */
+    int mFocusSession = -1;
+    /** multi session, latest paint-frame of session wait for next present. */
+    PaintFrame* mPendingFrames[MAX_SESSION] = {};
+    std::optional<GlRender> mRenders[MAX_SESSION];
+    std::optional<SwRender> mSwRenders[MAX_SESSION];
+    /** gl render only, drawn over views, toggle by key 'o'. */
+    std::optional<GlOverlay> mOverlay;
+    bool mOverlayVisible = false;
+    OverlaySums mOverlaySums;
+    clock::time_point mLastPresentTp;
+    /** multi session, frames replaced by newer before present. */
+    uint64_t mPresentDrops = 0;
+
+    bool mNetInline = false;
+    uint32_t mInlineOverBudget = 0;
+    int64_t mInlineFirstPts = 0;
+    /** pts origin restart when epoch changed(reconnected). */
+    uint32_t mInlineEpoch = 0;
+    clock::time_point mInlineFirstTp;
+    std::deque<InlineFrame> mInlineFrames;
 };
 }  // namespace ss
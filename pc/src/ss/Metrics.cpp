@@ -0,0 +1,132 @@
+#include <ss/Metrics.hpp>
+
+namespace ss {
+namespace {
+struct MetricInfo {
+    const char* name;
+    const char* help;
+    /** global metric stored in session 0, no session label. */
+    bool perSession;
+};
+
+const MetricInfo COUNTER_INFOS[Metrics::COUNTER_COUNT] = {
+    {"ss_net_frames_total", "frames received from sender.", true},
+    {"ss_net_bytes_total", "frame body bytes received from sender.", true},
+    {"ss_decoded_frames_total", "frames decoded to picture.", true},
+    {"ss_decode_dropped_frames_total",
+     "frames discarded by decoder, window hidden or waiting key frame.",
+     true},
+    {"ss_presented_frames_total", "frames presented.", true},
+    {"ss_reconnects_total", "reconnects after connection lost.", true},
+    {"ss_record_dropped_frames_total", "frames dropped by full record queue.", false},
+    {"ss_relay_dropped_frames_total", "frames dropped for slow relay clients.", false},
+};
+
+const MetricInfo GAUGE_INFOS[Metrics::GAUGE_COUNT] = {
+    {"ss_decode_queue_frames", "received frames wait for decode.", true},
+    {"ss_pts_queue_frames", "decoded frames wait for pts sync.", true},
+    {"ss_free_net_frames", "free frames of net frame pool.", true},
+    {"ss_free_paint_frames", "free frames of paint frame pool.", true},
+    {"ss_paint_frame_bytes", "decoded image bytes held by paint frames in flight.", true},
+    {"ss_fps", "frames presented in last second.", false},
+};
+
+const MetricInfo HISTOGRAM_INFOS[Metrics::HISTOGRAM_COUNT] = {
+    {"ss_decode_seconds", "decode time of frame.", true},
+    {"ss_latency_seconds", "net header received to swap buffers done.", true},
+};
+
+void AppendHeader(std::string& out, const MetricInfo& info, const char* type) {
+    out += "# HELP ";
+    out += info.name;
+    out += " ";
+    out += info.help;
+    out += "\n# TYPE ";
+    out += info.name;
+    out += " ";
+    out += type;
+    out += "\n";
+}
+
+void AppendSample(
+    std::string& out,
+    const MetricInfo& info,
+    const char* suffix,
+    int session,
+    const char* le,
+    const char* value) {
+    out += info.name;
+    out += suffix;
+    if (info.perSession || le) {
+        out += "{";
+        if (info.perSession) {
+            out += "session=\"" + std::to_string(session) + "\"";
+        }
+        if (le) {
+            out += info.perSession ? ",le=\"" : "le=\"";
+            out += le;
+            out += "\"";
+        }
+        out += "}";
+    }
+    out += " ";
+    out += value;
+    out += "\n";
+}
+}  // namespace
+
+std::string Metrics::render() const {
+    int sessionCount = Config::Singleton()->sessionCount();
+    std::string out;
+    out.reserve(8192);
+
+    for (int i = 0; i < COUNTER_COUNT; ++i) {
+        const MetricInfo& info = COUNTER_INFOS[i];
+        AppendHeader(out, info, "counter");
+        for (int s = 0; s < (info.perSession ? sessionCount : 1); ++s) {
+            uint64_t v = mCounters[i][s].load(std::memory_order_relaxed);
+            AppendSample(out, info, "", s, nullptr, std::to_string(v).c_str());
+        }
+    }
+
+    for (int i = 0; i < GAUGE_COUNT; ++i) {
+        const MetricInfo& info = GAUGE_INFOS[i];
+        AppendHeader(out, info, "gauge");
+        for (int s = 0; s < (info.perSession ? sessionCount : 1); ++s) {
+            int64_t v = mGauges[i][s].load(std::memory_order_relaxed);
+            AppendSample(out, info, "", s, nullptr, std::to_string(v).c_str());
+        }
+    }
+
+    char value[64];
+    char le[32];
+    for (int i = 0; i < HISTOGRAM_COUNT; ++i) {
+        const MetricInfo& info = HISTOGRAM_INFOS[i];
+        AppendHeader(out, info, "histogram");
+        for (int s = 0; s < (info.perSession ? sessionCount : 1); ++s) {
+            const HistogramData& h = mHistograms[i][s];
+            // buckets are cumulative, may be slightly behind count while updating.
+            uint64_t cumulative = 0;
+            for (int b = 0; b < BUCKET_COUNT; ++b) {
+                cumulative += h.buckets[b].load(std::memory_order_relaxed);
+                if (b < BUCKET_COUNT - 1) {
+                    snprintf(le, sizeof(le), "%g", BUCKET_BOUNDS_US[b] / 1e6);
+                } else {
+                    snprintf(le, sizeof(le), "+Inf");
+                }
+                snprintf(value, sizeof(value), "%llu", (unsigned long long)cumulative);
+                AppendSample(out, info, "_bucket", s, le, value);
+            }
+            snprintf(value, sizeof(value), "%.6f", h.sumUs.load(std::memory_order_relaxed) / 1e6);
+            AppendSample(out, info, "_sum", s, nullptr, value);
+            snprintf(
+                value,
+                sizeof(value),
+                "%llu",
+                (unsigned long long)h.count.load(std::memory_order_relaxed));
+            AppendSample(out, info, "_count", s, nullptr, value);
+        }
+    }
+    return out;
+}
+}  // namespace ss
@@ -0,0 +1,102 @@
+#pragma once
+#include <ss/Common.hpp>
+
+namespace ss {
+/**
+ * pipeline metrics of lock-free atomic counters, gauges and histograms, per session or global,
+ * exported in prometheus text format by `MetricsServer`(-metrics-port).
+ */
+class Metrics : public xm::SingletonBase<Metrics> {
+public:
+    enum Counter : int {
+        NET_FRAMES = 0,
+        NET_BYTES,
+        DECODED_FRAMES,
+        /** discarded by decoder, window hidden or waiting key frame. */
+        DECODE_DROPPED_FRAMES,
+        PRESENTED_FRAMES,
+        RECONNECTS,
+        /** global. */
+        RECORD_DROPPED_FRAMES,
+        RELAY_DROPPED_FRAMES,
+        COUNTER_COUNT,
+    };
+
+    enum Gauge : int {
+        DECODE_QUEUE = 0,
+        PTS_QUEUE,
+        FREE_NET_FRAMES,
+        FREE_PAINT_FRAMES,
+        /** decoded image bytes referenced by paint frames in flight. */
+        PAINT_FRAME_BYTES,
+        /** global, presented frames of last second. */
+        FPS,
+        GAUGE_COUNT,
+    };
+
+    enum Histogram : int {
+        DECODE_TIME = 0,
+        /** net header -> swap done. */
+        LATENCY,
+        HISTOGRAM_COUNT,
+    };
+
+    static void Add(Counter counter, int session, uint64_t value = 1) {
+        if (Metrics* self = Singleton()) {
+            self->mCounters[counter][session].fetch_add(value, std::memory_order_relaxed);
+        }
+    }
+
+    static void Add(Gauge gauge, int session, int64_t delta) {
+        if (Metrics* self = Singleton()) {
+            self->mGauges[gauge][session].fetch_add(delta, std::memory_order_relaxed);
+        }
+    }
+
+    static void Set(Gauge gauge, int session, int64_t value) {
+        if (Metrics* self = Singleton()) {
+            self->mGauges[gauge][session].store(value, std::memory_order_relaxed);
+        }
+    }
+
+    static void Observe(Histogram histogram, int session, chrono::nanoseconds d) {
+        if (Metrics* self = Singleton()) {
+            self->observe(histogram, session, d);
+        }
+    }
+
+    /** prometheus text exposition format. */
+    std::string render() const;
+
+private:
+    /** upper bounds(us) of histogram buckets, last bucket is +Inf. */
+    static constexpr int64_t BUCKET_BOUNDS_US[] = {
+        1000, 2000, 4000, 8000, 16000, 33000, 66000, 133000, 266000, 500000, 1000000};
+    static constexpr int BUCKET_COUNT =
+        (int)(sizeof(BUCKET_BOUNDS_US) / sizeof(BUCKET_BOUNDS_US[0])) + 1;
+
+    struct HistogramData {
+        std::atomic<uint64_t> buckets[BUCKET_COUNT] = {};
+        std::atomic<uint64_t> count = 0;
+        std::atomic<int64_t> sumUs = 0;
+    };
+
+    void observe(Histogram histogram, int session, chrono::nanoseconds d) {
+        int64_t us = chrono::duration_cast<chrono::microseconds>(d).count();
+        int bucket = 0;
+        while (bucket < BUCKET_COUNT - 1 && us > BUCKET_BOUNDS_US[bucket]) {
+            ++bucket;
+        }
+        HistogramData& h = mHistograms[histogram][session];
+        h.buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+        h.count.fetch_add(1, std::memory_order_relaxed);
+        h.sumUs.fetch_add(us, std::memory_order_relaxed);
+    }
+
+    // ----
+
+    std::atomic<uint64_t> mCounters[COUNTER_COUNT][MAX_SESSION] = {};
+    std::atomic<int64_t> mGauges[GAUGE_COUNT][MAX_SESSION] = {};
+    HistogramData mHistograms[HISTOGRAM_COUNT][MAX_SESSION];
+};
+}  // namespace ss
@@ -0,0 +1,59 @@
+#include <ss/MetricsServer.hpp>
+#include <ss/Metrics.hpp>
+
+namespace ss {
+MetricsServer::MetricsServer(uv_loop_t* loop, int port)
+    : mTcp(
+          loop,
+          "metrics",
+          "127.0.0.1",
+          port,
+          MAX_CLIENT,
+          {nullptr,
+           [this](Client& c, const char* data, size_t size) { onData(c, data, size); },
+           nullptr}) {
+    Log::I("metrics listen on: http://127.0.0.1:%d/metrics", port);
+}
+
+void MetricsServer::onData(Client& c, const char* data, size_t size) {
+    c.request.append(data, size);
+    if (c.request.find("\r\n\r\n") != std::string::npos) {
+        uv_read_stop((uv_stream_t*)&c.tcp);
+        respond(c);
+    } else if (c.request.size() > MAX_REQUEST) {
+        mTcp.closeClient(c);
+    }
+}
+
+void MetricsServer::respond(Client& c) {
+    // call by net loop(c code), so never throw from here.
+    try {
+        bool found = c.request.compare(0, 13, "GET /metrics ") == 0 ||
+                     c.request.compare(0, 6, "GET / ") == 0;
+        std::string body = found ? Metrics::Singleton()->render() : "not found\n";
+        c.response = found ? "HTTP/1.1 200 OK\r\n"
+                             "Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n"
+                           : "HTTP/1.1 404 Not Found\r\n"
+                             "Content-Type: text/plain; charset=utf-8\r\n";
+        c.response += "Content-Length: " + std::to_string(body.size()) + "\r\n";
+        c.response += "Connection: close\r\n\r\n";
+        c.response += body;
+    } catch (const std::exception& e) {
+        Log::E("metrics render fail: %s", e.what());
+        mTcp.closeClient(c);
+        return;
+    }
+
+    uv_buf_t buf = uv_buf_init(c.response.data(), (unsigned)c.response.size());
+    c.writeReq.data = this;
+    int r = uv_write(&c.writeReq, (uv_stream_t*)&c.tcp, &buf, 1, [](uv_write_t* req, int status) {
+        (void)status;
+        Client* c = (Client*)req->handle->data;
+        ((MetricsServer*)req->data)->mTcp.closeClient(*c);
+    });
+    if (r != 0) {
+        Log::E("'uv_write' fail: %s", uverror_tostring(r).c_str());
+        mTcp.closeClient(c);
+    }
+}
+}  // namespace ss
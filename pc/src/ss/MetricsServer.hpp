@@ -0,0 +1,36 @@
+#pragma once
+#include <ss/TcpServer.hpp>
+
+namespace ss {
+/**
+ * minimal http server on net loop, answer `GET /metrics` with `Metrics` in prometheus text
+ * format, e.g. `curl http://127.0.0.1:9464/metrics`. listen on loopback only, one request per
+ * connection.
+ */
+class MetricsServer : public xm::NonCopyable {
+public:
+    MetricsServer(uv_loop_t* loop, int port);
+
+private:
+    enum : int {
+        MAX_CLIENT = 8,
+        /** request larger than it closed without response. */
+        MAX_REQUEST = 4096,
+    };
+
+    struct Client : TcpClient {
+        uv_write_t writeReq = {};
+        std::string request;
+        std::string response;
+    };
+
+    void onData(Client& c, const char* data, size_t size);
+
+    /** write response, then close. */
+    void respond(Client& c);
+
+    // ----
+
+    TcpServer<Client> mTcp;
+};
+}  // namespace ss
@@ -1,12 +1,29 @@
 #include <ss/NetThread.hpp>
 #include <ss/MainThread.hpp>
 #include <ss/DecodeThread.hpp>
+#include <ss/HugePageAlloc.hpp>
+#include <ss/Metrics.hpp>
+#include <ss/RecordThread.hpp>
+#include <ss/StartupReport.hpp>
+#include <ss/Trace.hpp>
+#include <ss/Bench.hpp>
+#include <ss/ThreadPolicy.hpp>
 
 namespace ss {
 NetThread::NetThread() {
-    for (int i = 0; i < NET_FRAME_POOL_CAPACITY; ++i) {
-        mNetFramePool[i].emplace();
-        mFreeNetFrames.push_back(&*mNetFramePool[i]);
+    Config* cfg = Config::Singleton();
+    mSessionCount = cfg->sessionCount();
+    for (int i = 0; i < mSessionCount; ++i) {
+        Session& s = mSessions[i].emplace();
+        s.index = i;
+        if (!cfg->ips.empty()) {
+            s.remoteIp = cfg->ips[i];
+        }
+        for (int j = 0; j < NET_FRAME_POOL_CAPACITY; ++j) {
+            s.netFramePool[j].emplace();
+            s.netFramePool[j]->session = i;
+            s.freeNetFrames.push_back(&*s.netFramePool[j]);
+        }
     }
 
     mLoop.emplace();
@@ -25,6 +42,20 @@ NetThread::NetThread() {
             [](uv_async_t* handle) { NetThread::Singleton()->onAsyncRecycle(handle); }),
         "uv_async_init");
 
+    check_libuv(
+        uv_async_init(
+            &*mLoop,
+            &mAsyncKeyFrame,
+            [](uv_async_t* handle) { NetThread::Singleton()->onAsyncKeyFrame(handle); }),
+        "uv_async_init");
+
+    if (cfg->relay) {
+        mRelay.emplace(&*mLoop, cfg->relayPort);
+    }
+    if (cfg->metricsPort > 0) {
+        mMetricsServer.emplace(&*mLoop, cfg->metricsPort);
+    }
+
     try {
         mThread.emplace([]() { NetThread::Singleton()->run(); });
     } catch (std::exception& e) {
@@ -32,6 +63,62 @@ NetThread::NetThread() {
     }
 }
 
+void NetThread::closeSession(Session& s) {
+    if (s.closed) {
+        return;
+    }
+    s.closed = true;
+    Log::I("session %d closed", s.index);
+
+    for (uv_handle_t* handle :
+         {(uv_handle_t*)&s.client,
+          (uv_handle_t*)&s.connectTimer,
+          (uv_handle_t*)&s.writeTimer,
+          (uv_handle_t*)&s.reconnectTimer}) {
+        // type set by init, zero if not initialized.
+        if (handle->type != UV_UNKNOWN_HANDLE && !uv_is_closing(handle)) {
+            uv_close(handle, nullptr);
+        }
+    }
+
+    for (int i = 0; i < mSessionCount; ++i) {
+        if (!mSessions[i]->closed) {
+            return;
+        }
+    }
+    stop(true);
+}
+
+void NetThread::resumeRead(Session& s) {
+    if (s.closed || !s.connected || s.currentFrame) {
+        return;
+    }
+    s.currentFrame = ObtainNetFrame(s);
+    Metrics::Set(Metrics::FREE_NET_FRAMES, s.index, s.freeNetFrames.size());
+    if (s.currentFrame) {
+        s.readStage = ReadStage::HEAD;
+        s.readSize = 0;
+        int r = uv_read_start(
+            (uv_stream_t*)&s.client,
+            [](uv_handle_t* handle, size_t suggestedSize, uv_buf_t* buf) {
+                (void)suggestedSize;
+                NetThread::Singleton()->onReadAlloc(SessionOf(handle->data), buf);
+            },
+            [](uv_stream_t* stream, ssize_t nread, const uv_buf_t* buf) {
+                (void)buf;
+                NetThread::Singleton()->onRead(SessionOf(stream->data), nread);
+            });
+        if (r != 0) {
+            Log::E(
+                "'uv_read_start' fail: %s, at %s:%d",
+                uverror_tostring(r).c_str(),
+                __FILE__,
+                __LINE__);
+            reconnectSession(s);
+        }
+    }
+}
+
 void NetThread::onAsyncRecycle(uv_async_t* handle) {
     (void)handle;
 
@@ -42,33 +129,13 @@ void NetThread::onAsyncRecycle(uv_async_t* handle) {
     {
         std::lock_guard<std::mutex> lock(mCacheFreeNetFrameLock);
         for (const auto& i : mCacheFreeNetFrames) {
-            mFreeNetFrames.push_back(i);
+            mSessions[i->session]->freeNetFrames.push_back(i);
         }
         mCacheFreeNetFrames.clear();
     }
 
-    if (!mCurrentFrame) {
-        mCurrentFrame = obtainNetFrame();
-        if (mCurrentFrame) {
-            mReadStage = ReadStage::HEAD;
-            mReadSize = 0;
-            int r = uv_read_start(
-                (uv_stream_t*)&mClient,
-                [](uv_handle_t* handle, size_t suggestedSize, uv_buf_t* buf) {
-                    NetThread::Singleton()->onReadAlloc(handle, suggestedSize, buf);
-                },
-                [](uv_stream_t* stream, ssize_t nread, const uv_buf_t* buf) {
-                    NetThread::Singleton()->onRead(stream, nread, buf);
-                });
-            if (r != 0) {
-                Log::E(
-                    "'uv_read_start' fail: %s, at %s:%d",
-                    uverror_tostring(r).c_str(),
-                    __FILE__,
-                    __LINE__);
-                stop(true);
-            }
-        }
+    for (int i = 0; i < mSessionCount; ++i) {
+        resumeRead(*mSessions[i]);
     }
 }
 
@@ -78,12 +145,52 @@ void NetThread::onAsyncClose(uv_async_t* handle) {
     stop(true);
 }
 
+void NetThread::onAsyncKeyFrame(uv_async_t* handle) {
+    (void)handle;
+
+    if (isStopped()) {
+        return;
+    }
+
+    uint32_t requests = mKeyFrameRequests.exchange(0);
+    for (int i = 0; i < mSessionCount; ++i) {
+        Session& s = *mSessions[i];
+        if (!(requests & (1u << i)) || s.closed || !s.connected || s.keyFrameWriting) {
+            continue;
+        }
+
+        s.keyFrameWriteReq.data = &s;
+        int r = uv_write(
+            &s.keyFrameWriteReq,
+            (uv_stream_t*)&s.client,
+            &KEY_FRAME_BUF,
+            1,
+            [](uv_write_t* req, int status) {
+                Session& s = SessionOf(req->data);
+                s.keyFrameWriting = false;
+                if (status != 0 && !s.closed && s.resetting == 0 &&
+                    !NetThread::Singleton()->isStopped()) {
+                    Log::E("net write fail: %s", uverror_tostring(status).c_str());
+                    NetThread::Singleton()->reconnectSession(s);
+                }
+            });
+        if (r != 0) {
+            Log::E(
+                "'uv_write' fail: %s, at %s:%d", uverror_tostring(r).c_str(), __FILE__, __LINE__);
+            reconnectSession(s);
+            continue;
+        }
+        s.keyFrameWriting = true;
+        Log::I("session %d request key frame", s.index);
+    }
+}
+
 void NetThread::onBroadcastRead(
     uv_udp_t* handle, ssize_t nread, const uv_buf_t* buf, const sockaddr* addr, unsigned flags) {
     (void)handle;
     (void)flags;
 
-    if (isStopped()) {
+    if (isStopped() || !uv_is_active((uv_handle_t*)&mBroadcastTimer)) {
         return;
     }
 
@@ -91,8 +198,26 @@ void NetThread::onBroadcastRead(
         char remoteAddrStr[INET_ADDRSTRLEN] = {};
         uv_ip4_name((const sockaddr_in*)addr, remoteAddrStr, INET_ADDRSTRLEN);
         Log::I("get udp packet, remote address: %s", remoteAddrStr);
-        mRemoteIp = remoteAddrStr;
-        stop(false);
+        StartupReport::End(StartupReport::DISCOVERY);
+
+        stopBroadcast();
+
+        Session& s = *mSessions[0];
+        if (s.racing) {
+            s.racing = false;
+            if (s.remoteIp == remoteAddrStr) {
+                // cached sender is right, keep connecting.
+                return;
+            }
+            Log::I("session %d cached sender changed, abandon: %s", s.index, s.remoteIp.c_str());
+            resetConnect(s);
+        }
+        s.remoteIp = remoteAddrStr;
+        if (s.resetting > 0) {
+            s.connectAfterReset = true;
+        } else if (startConnect(s) != 0) {
+            retryConnect(s);
+        }
     }
 }
 
@@ -103,200 +228,435 @@ void NetThread::onBroadcastTimer(uv_timer_t* handle) {
         return;
     }
 
-    static int c = 25;
-    --c;
-    if (c >= 0) {
+    --mBroadcastTimerCount;
+    if (mBroadcastTimerCount >= 0) {
         Log::I("broadcast receiving...");
+    } else if (mSessions[0]->everConnected) {
+        // sender may come back any time.
+        Log::I("broadcast timeout, keep receiving for reconnect");
+        mBroadcastTimerCount = 25;
     } else {
         Log::I("broadcast timeout");
         stop(true);
     }
 }
 
-void NetThread::step0() {
-    if (Config::Singleton()->ip.empty()) {
-        check_libuv(uv_udp_init(&*mLoop, &mBroadcastClient), "uv_udp_init");
+int NetThread::startBroadcast() {
+    mBroadcastTimerCount = 25;
+    int r = uv_udp_init(&*mLoop, &mBroadcastClient);
+    if (r != 0) {
+        Log::E("'uv_udp_init' fail: %s", uverror_tostring(r).c_str());
+        return r;
+    }
 
-        check_libuv(uv_timer_init(&*mLoop, &mBroadcastTimer), "uv_timer_init");
+    r = uv_timer_init(&*mLoop, &mBroadcastTimer);
+    if (r != 0) {
+        Log::E("'uv_timer_init' fail: %s", uverror_tostring(r).c_str());
+        return r;
+    }
 
-        sockaddr_in localAddr;
-        uv_ip4_addr("0.0.0.0", Config::Singleton()->broadcastPort, &localAddr);
-        check_libuv(
-            uv_udp_bind(&mBroadcastClient, (const sockaddr*)&localAddr, UV_UDP_REUSEADDR),
-            "uv_udp_bind");
+    sockaddr_in localAddr;
+    uv_ip4_addr("0.0.0.0", Config::Singleton()->broadcastPort, &localAddr);
+    r = uv_udp_bind(&mBroadcastClient, (const sockaddr*)&localAddr, UV_UDP_REUSEADDR);
+    if (r != 0) {
+        Log::E("'uv_udp_bind' fail: %s", uverror_tostring(r).c_str());
+        return r;
+    }
 
-        uv_udp_recv_start(
-            &mBroadcastClient,
-            [](uv_handle_t* handle, size_t suggestedSize, uv_buf_t* buf) {
-                static char d[4] = {};
-                buf->base = d;
-                buf->len = 4;
-            },
-            [](uv_udp_t* handle,
-               ssize_t nread,
-               const uv_buf_t* buf,
-               const sockaddr* addr,
-               unsigned flags) {
-                NetThread::Singleton()->onBroadcastRead(handle, nread, buf, addr, flags);
-            });
+    uv_udp_recv_start(
+        &mBroadcastClient,
+        [](uv_handle_t* handle, size_t suggestedSize, uv_buf_t* buf) {
+            static char d[4] = {};
+            buf->base = d;
+            buf->len = 4;
+        },
+        [](uv_udp_t* handle,
+           ssize_t nread,
+           const uv_buf_t* buf,
+           const sockaddr* addr,
+           unsigned flags) {
+            NetThread::Singleton()->onBroadcastRead(handle, nread, buf, addr, flags);
+        });
 
-        check_libuv(
-            uv_timer_start(
-                &mBroadcastTimer,
-                [](uv_timer_t* handle) { NetThread::Singleton()->onBroadcastTimer(handle); },
-                0,
-                2000),
-            "uv_timer_start");
+    r = uv_timer_start(
+        &mBroadcastTimer,
+        [](uv_timer_t* handle) { NetThread::Singleton()->onBroadcastTimer(handle); },
+        0,
+        2000);
+    if (r != 0) {
+        Log::E("'uv_timer_start' fail: %s", uverror_tostring(r).c_str());
+    }
+    return r;
+}
 
-        uv_run(&*mLoop, UV_RUN_DEFAULT);
+void NetThread::stopBroadcast() {
+    for (uv_handle_t* handle : {(uv_handle_t*)&mBroadcastClient, (uv_handle_t*)&mBroadcastTimer}) {
+        if (handle->type != UV_UNKNOWN_HANDLE && !uv_is_closing(handle)) {
+            uv_close(handle, nullptr);
+        }
+    }
+}
 
-        uv_close((uv_handle_t*)&mBroadcastClient, nullptr);
-        uv_close((uv_handle_t*)&mBroadcastTimer, nullptr);
-    } else {
-        mRemoteIp = Config::Singleton()->ip;
+std::string NetThread::LoadSenderCache() {
+    const std::string& path = Config::Singleton()->senderCachePath;
+    if (path.empty()) {
+        return "";
+    }
+    FILE* f = ::fopen(path.c_str(), "rb");
+    if (!f) {
+        return "";
     }
+    char ip[INET_ADDRSTRLEN] = {};
+    size_t n = ::fread(ip, 1, INET_ADDRSTRLEN - 1, f);
+    ::fclose(f);
+    ip[n] = 0;
+    sockaddr_in tmpAddr = {};
+    if (uv_ip4_addr(ip, 0, &tmpAddr) != 0) {
+        Log::W("ignore invalid sender cache: %s", path.c_str());
+        return "";
+    }
+    return ip;
+}
 
-    if (mClose) {
-        throw TagExit {};
+void NetThread::SaveSenderCache(const std::string& ip) {
+    const std::string& path = Config::Singleton()->senderCachePath;
+    if (path.empty()) {
+        return;
     }
+    FILE* f = ::fopen(path.c_str(), "wb");
+    if (!f) {
+        Log::W("write sender cache fail: %s", path.c_str());
+        return;
+    }
+    ::fwrite(ip.data(), 1, ip.size(), f);
+    ::fclose(f);
 }
 
-void NetThread::onConnect(uv_connect_t* req, int status) {
-    (void)req;
+int NetThread::startConnect(Session& s) {
+    Log::I(
+        "session %d try to connect: %s%s",
+        s.index,
+        s.remoteIp.c_str(),
+        s.racing ? "(cached, race with broadcast)" : "");
+    s.connectTimerCount = 10;
+    StartupReport::Begin(StartupReport::CONNECT);
+
+    // handles initialized before fail closed by `resetConnect` or `closeSession`.
+    int r = uv_tcp_init(&*mLoop, &s.client);
+    if (r != 0) {
+        Log::E("session %d 'uv_tcp_init' fail: %s", s.index, uverror_tostring(r).c_str());
+        return r;
+    }
+    s.client.data = &s;
 
-    if (isStopped()) {
-        return;
+    r = uv_timer_init(&*mLoop, &s.connectTimer);
+    if (r != 0) {
+        Log::E("session %d 'uv_timer_init' fail: %s", s.index, uverror_tostring(r).c_str());
+        return r;
+    }
+    s.connectTimer.data = &s;
+
+    // all sessions can not share one local port.
+    if (mSessionCount == 1) {
+        sockaddr_in localAddr = {};
+        uv_ip4_addr("0.0.0.0", Config::Singleton()->port, &localAddr);
+        r = uv_tcp_bind(&s.client, (const sockaddr*)&localAddr, 0);
+        if (r != 0) {
+            Log::E("session %d 'uv_tcp_bind' fail: %s", s.index, uverror_tostring(r).c_str());
+            return r;
+        }
     }
 
-    if (status == 0) {
-        Log::I("connect success");
-        stop(false);
-    } else {
-        Log::I("connect fail: %s", uverror_tostring(status).c_str());
-        stop(true);
+    sockaddr_in remoteAddr = {};
+    uv_ip4_addr(s.remoteIp.c_str(), Config::Singleton()->port, &remoteAddr);
+
+    // network down(e.g. wifi off) fail here with ENETUNREACH, not in callback.
+    s.connectReq.data = &s;
+    r = uv_tcp_connect(
+        &s.connectReq,
+        &s.client,
+        (const sockaddr*)&remoteAddr,
+        [](uv_connect_t* req, int status) {
+            NetThread::Singleton()->onConnect(SessionOf(req->data), status);
+        });
+    if (r != 0) {
+        Log::I("session %d connect fail: %s", s.index, uverror_tostring(r).c_str());
+        return r;
     }
+
+    r = uv_timer_start(
+        &s.connectTimer,
+        [](uv_timer_t* handle) { NetThread::Singleton()->onConnectTimer(SessionOf(handle->data)); },
+        0,
+        2000);
+    if (r != 0) {
+        Log::E("session %d 'uv_timer_start' fail: %s", s.index, uverror_tostring(r).c_str());
+    }
+    return r;
 }
 
-void NetThread::onConnectTimer(uv_timer_t* handle) {
-    (void)handle;
+int NetThread::startDiscovery(Session& s) {
+    StartupReport::Begin(StartupReport::DISCOVERY);
+    if (!Config::Singleton()->ips.empty()) {
+        StartupReport::End(StartupReport::DISCOVERY);
+        return startConnect(s);
+    }
+    // try last sender directly, broadcast may take seconds.
+    s.remoteIp = LoadSenderCache();
+    if (!s.remoteIp.empty()) {
+        s.racing = true;
+        if (startConnect(s) != 0) {
+            // broadcast may still find sender.
+            s.racing = false;
+            resetConnect(s);
+        }
+    }
+    return startBroadcast();
+}
 
-    if (isStopped()) {
+void NetThread::retryConnect(Session& s) {
+    if (!Config::Singleton()->reconnect || !s.everConnected) {
+        stopBroadcast();
+        closeSession(s);
         return;
     }
-
-    static int c = 10;
-    --c;
-    if (c >= 0) {
-        Log::I("connecting...");
-    } else {
-        Log::I("connect timeout");
-        stop(true);
+    // same backoff as lost connection, by `onConnectReset`.
+    s.reconnecting = true;
+    s.racing = false;
+    s.connectAfterReset = false;
+    if (s.index == 0) {
+        stopBroadcast();
     }
+    resetConnect(s);
 }
 
-void NetThread::step1() {
-    Log::I("try to connect: %s", mRemoteIp.c_str());
+void NetThread::resetConnect(Session& s) {
+    // previous reset continue by flags.
+    if (s.resetting > 0) {
+        return;
+    }
+    for (uv_handle_t* handle :
+         {(uv_handle_t*)&s.client, (uv_handle_t*)&s.connectTimer, (uv_handle_t*)&s.writeTimer}) {
+        if (handle->type == UV_UNKNOWN_HANDLE || uv_is_closing(handle)) {
+            continue;
+        }
+        ++s.resetting;
+        uv_close(handle, [](uv_handle_t* handle) {
+            Session& s = SessionOf(handle->data);
+            if (--s.resetting == 0) {
+                NetThread::Singleton()->onConnectReset(s);
+            }
+        });
+    }
+    if (s.resetting == 0) {
+        onConnectReset(s);
+    }
+}
 
-    check_libuv(uv_tcp_init(&*mLoop, &mClient), "uv_tcp_init");
+void NetThread::onConnectReset(Session& s) {
+    if (isStopped() || s.closed) {
+        return;
+    }
 
-    check_libuv(uv_timer_init(&*mLoop, &mConnectTimer), "uv_timer_init");
+    // call by net loop(c code), so never throw from here.
+    if (s.connectAfterReset) {
+        s.connectAfterReset = false;
+        if (startConnect(s) != 0) {
+            retryConnect(s);
+        }
+    } else if (s.reconnecting) {
+        if (s.reconnectTimer.type == UV_UNKNOWN_HANDLE) {
+            int r = uv_timer_init(&*mLoop, &s.reconnectTimer);
+            if (r != 0) {
+                Log::E("session %d 'uv_timer_init' fail: %s", s.index, uverror_tostring(r).c_str());
+                closeSession(s);
+                return;
+            }
+            s.reconnectTimer.data = &s;
+        }
+        int delay = std::min(
+            (int)RECONNECT_DELAY_MS << std::min(s.reconnectAttempts, 8),
+            (int)RECONNECT_DELAY_MAX_MS);
+        ++s.reconnectAttempts;
+        Log::I("session %d reconnect in %dms", s.index, delay);
+        int r = uv_timer_start(
+            &s.reconnectTimer,
+            [](uv_timer_t* handle) {
+                NetThread::Singleton()->onReconnectTimer(SessionOf(handle->data));
+            },
+            delay,
+            0);
+        if (r != 0) {
+            Log::E("session %d 'uv_timer_start' fail: %s", s.index, uverror_tostring(r).c_str());
+            closeSession(s);
+        }
+    }
+}
 
-    sockaddr_in localAddr = {};
-    uv_ip4_addr("0.0.0.0", Config::Singleton()->port, &localAddr);
-    check_libuv(uv_tcp_bind(&mClient, (const sockaddr*)&localAddr, 0), "uv_tcp_bind");
+void NetThread::reconnectSession(Session& s) {
+    if (s.closed || s.reconnecting) {
+        return;
+    }
+    // never connected, e.g. wrong address, give up as before.
+    if (!Config::Singleton()->reconnect || !s.everConnected) {
+        closeSession(s);
+        return;
+    }
 
-    sockaddr_in remoteAddr = {};
-    uv_ip4_addr(mRemoteIp.c_str(), Config::Singleton()->port, &remoteAddr);
+    Log::I("session %d disconnected, keep last frame and reconnect", s.index);
+    Metrics::Add(Metrics::RECONNECTS, s.index);
+    s.reconnecting = true;
+    s.connected = false;
+    s.racing = false;
+    s.connectAfterReset = false;
+    s.firstFrameReceived = false;
+    s.disconnectTp = chrono::high_resolution_clock::now();
+    // decoder and pts sync restart when frame of new epoch come.
+    ++s.epoch;
+    if (s.currentFrame) {
+        s.freeNetFrames.push_back(s.currentFrame);
+        s.currentFrame = nullptr;
+    }
+    resetConnect(s);
+}
 
-    check_libuv(
-        uv_tcp_connect(
-            &mConnectReq,
-            &mClient,
-            (const sockaddr*)&remoteAddr,
-            [](uv_connect_t* req, int status) { NetThread::Singleton()->onConnect(req, status); }),
-        "uv_tcp_connect");
+void NetThread::onReconnectTimer(Session& s) {
+    if (isStopped() || s.closed) {
+        return;
+    }
 
-    check_libuv(
-        uv_timer_start(
-            &mConnectTimer,
-            [](uv_timer_t* handle) { NetThread::Singleton()->onConnectTimer(handle); },
-            0,
-            2000),
-        "uv_timer_start");
+    s.reconnecting = false;
+    ++s.reconnects;
+    if (startDiscovery(s) != 0) {
+        retryConnect(s);
+    }
+}
 
-    uv_run(&*mLoop, UV_RUN_DEFAULT);
+void NetThread::onConnect(Session& s, int status) {
+    // canceled by `resetConnect`.
+    if (isStopped() || s.closed || s.resetting > 0) {
+        return;
+    }
 
-    uv_close((uv_handle_t*)&mConnectTimer, nullptr);
+    if (status != 0) {
+        Log::I("session %d connect fail: %s", s.index, uverror_tostring(status).c_str());
+        if (s.racing) {
+            // broadcast still receiving.
+            s.racing = false;
+            resetConnect(s);
+        } else {
+            reconnectSession(s);
+        }
+        return;
+    }
 
-    if (mClose) {
-        throw TagExit {};
+    Log::I(
+        "session %d connect success, %lldms after start",
+        s.index,
+        (long long)chrono::duration_cast<chrono::milliseconds>(
+            chrono::high_resolution_clock::now() - mStartTp)
+            .count());
+    s.connectedTp = chrono::high_resolution_clock::now();
+    s.everConnected = true;
+    // cached sender connected also end discovery.
+    StartupReport::End(StartupReport::DISCOVERY, s.connectedTp);
+    StartupReport::End(StartupReport::CONNECT, s.connectedTp);
+    StartupReport::Begin(StartupReport::FIRST_PACKET, s.connectedTp);
+    uv_close((uv_handle_t*)&s.connectTimer, nullptr);
+    if (s.racing) {
+        s.racing = false;
+        Log::I("session %d cached sender win, stop broadcast", s.index);
+        stopBroadcast();
+    }
+    if (Config::Singleton()->ips.empty()) {
+        SaveSenderCache(s.remoteIp);
+    }
+    if (Config::Singleton()->pipeline == PipelineMode::INLINE && !mInlineStarted) {
+        // hand over loop to main thread, see `run`.
+        stop(false);
+    } else {
+        startRead(s);
     }
 }
 
-void NetThread::onWriteTimer(uv_timer_t* handle) {
-    (void)handle;
+void NetThread::onConnectTimer(Session& s) {
+    if (isStopped() || s.closed) {
+        return;
+    }
 
-    if (isStopped()) {
+    --s.connectTimerCount;
+    if (s.connectTimerCount >= 0) {
+        Log::I("session %d connecting...", s.index);
+    } else if (s.racing) {
+        Log::I("session %d cached sender connect timeout, wait broadcast", s.index);
+        s.racing = false;
+        resetConnect(s);
+    } else {
+        Log::I("session %d connect timeout", s.index);
+        reconnectSession(s);
+    }
+}
+
+void NetThread::onWriteTimer(Session& s) {
+    if (isStopped() || s.closed) {
         return;
     }
 
+    s.writeReq.data = &s;
     int r = uv_write(
-        &mWriteReq, (uv_stream_t*)&mClient, &WRITE_BUF, 1, [](uv_write_t* req, int status) {
-            NetThread::Singleton()->onWrite(req, status);
+        &s.writeReq, (uv_stream_t*)&s.client, &WRITE_BUF, 1, [](uv_write_t* req, int status) {
+            NetThread::Singleton()->onWrite(SessionOf(req->data), status);
         });
     if (r != 0) {
         Log::E("'uv_write' fail: %s, at %s:%d", uverror_tostring(r).c_str(), __FILE__, __LINE__);
-        stop(true);
+        reconnectSession(s);
     }
 }
 
-void NetThread::onWrite(uv_write_t* req, int status) {
-    (void)req;
-
-    if (isStopped()) {
+void NetThread::onWrite(Session& s, int status) {
+    // canceled by `resetConnect`.
+    if (isStopped() || s.closed || s.resetting > 0) {
         return;
     }
 
     if (status != 0) {
-        Log::E("net write fail: %s", uverror_tostring(status).c_str());
-        stop(true);
+        Log::E("session %d net write fail: %s", s.index, uverror_tostring(status).c_str());
+        reconnectSession(s);
         return;
     }
 
+    StartupReport::End(StartupReport::KEEP_ALIVE);
     if (Config::Singleton()->debugNet) {
-        Log::I_STR("write 1 byte");
+        Log::I("session %d write 1 byte", s.index);
     }
 
     int r = uv_timer_start(
-        (uv_timer_t*)&mWriteTimer,
-        [](uv_timer_t* handle) { NetThread::Singleton()->onWriteTimer(handle); },
+        &s.writeTimer,
+        [](uv_timer_t* handle) { NetThread::Singleton()->onWriteTimer(SessionOf(handle->data)); },
         2000,
         0);
     if (r != 0) {
         Log::E(
             "'uv_timer_start' fail: %s, at %s:%d", uverror_tostring(r).c_str(), __FILE__, __LINE__);
-        stop(true);
+        reconnectSession(s);
     }
 }
 
-void NetThread::onReadAlloc(uv_handle_t* handle, size_t suggestedSize, uv_buf_t* buf) {
-    (void)handle;
-    (void)suggestedSize;
-    assert(mCurrentFrame);
+void NetThread::onReadAlloc(Session& s, uv_buf_t* buf) {
+    assert(s.currentFrame);
 
-    if (mReadStage == ReadStage::HEAD) {
-        buf->base = mHeader + mReadSize;
-        buf->len = 12 - mReadSize;
+    if (s.readStage == ReadStage::HEAD) {
+        buf->base = s.header + s.readSize;
+        buf->len = 12 - s.readSize;
     } else {
-        buf->base = (char*)mCurrentFrame->body->data + mReadSize;
-        buf->len = mCurrentFrame->body->size - mReadSize;
+        buf->base = (char*)s.currentFrame->body->data + s.readSize;
+        buf->len = s.currentFrame->body->size - s.readSize;
     }
 }
 
-void NetThread::onRead(uv_stream_t* stream, ssize_t nread, const uv_buf_t* buf) {
-    (void)stream;
-
-    if (isStopped()) {
+void NetThread::onRead(Session& s, ssize_t nread) {
+    TraceZone zone("net read");
+    if (isStopped() || s.closed) {
         return;
     }
 
@@ -305,96 +665,180 @@ void NetThread::onRead(uv_stream_t* stream, ssize_t nread, const uv_buf_t* buf)
     }
 
     if (nread < 0) {
-        Log::E("net read fail: %s", uverror_tostring(nread).c_str());
-        stop(true);
+        Log::E("session %d net read fail: %s", s.index, uverror_tostring(nread).c_str());
+        reconnectSession(s);
         return;
     }
 
-    mReadSize += nread;
-    if (mReadStage == ReadStage::HEAD) {
-        assert(mReadSize <= 12);
-        if (mReadSize == 12) {
-            uint32_t size = GetJavaData<uint32_t>(mHeader);
-            int64_t pts = GetJavaData<int64_t>(mHeader + 4);
+    NetFrame* frame = s.currentFrame;
+    s.readSize += nread;
+    if (s.readStage == ReadStage::HEAD) {
+        assert(s.readSize <= 12);
+        if (s.readSize == 12) {
+            frame->headerTp = chrono::high_resolution_clock::now();
+            uint32_t size = GetJavaData<uint32_t>(s.header);
+            int64_t pts = GetJavaData<int64_t>(s.header + 4);
             if (Config::Singleton()->debugNet) {
-                Log::I("read header, body size: %u, pts: %lld", (unsigned)size, (long long)pts);
+                SS_LOG_I_DEFER(
+                    "session %d read header, body size: %u, pts: %lld",
+                    s.index,
+                    (unsigned)size,
+                    (long long)pts);
             }
 
-            if (mCurrentFrame->body->buf &&
-                av_buffer_get_ref_count(mCurrentFrame->body->buf) == 1 &&
-                mCurrentFrame->body->buf->size >= size) {
+            if (frame->body->buf && av_buffer_get_ref_count(frame->body->buf) == 1 &&
+                frame->body->buf->size >= size) {
                 // we can reuse buffer:
                 // - if buffer not null.
                 // - if ref_count == 1, no use by outside.
                 // - if buffer capacity big than required size.
-                AVBufferRef* tmp = av_buffer_ref(mCurrentFrame->body->buf);
-                av_packet_unref(mCurrentFrame->body);
-                mCurrentFrame->body->buf = tmp;
-                mCurrentFrame->body->data = tmp->data;
-                mCurrentFrame->body->size = size;
+                AVBufferRef* tmp = av_buffer_ref(frame->body->buf);
+                av_packet_unref(frame->body);
+                frame->body->buf = tmp;
+                frame->body->data = tmp->data;
+                frame->body->size = size;
+            } else if (AVBufferRef* buf = HugePageAlloc::Alloc(
+                           HugePageAlloc::DECODE, (size_t)size + AV_INPUT_BUFFER_PADDING_SIZE)) {
+                // large key frame, capacity rounded to huge pages, reused by later frames.
+                av_packet_unref(frame->body);
+                frame->body->buf = buf;
+                frame->body->data = buf->data;
+                frame->body->size = size;
             } else {
-                av_packet_unref(mCurrentFrame->body);
-                av_new_packet(mCurrentFrame->body, size);
+                av_packet_unref(frame->body);
+                av_new_packet(frame->body, size);
             }
 
-            mCurrentFrame->pts = pts;
-            mReadStage = ReadStage::BODY;
-            mReadSize = 0;
+            frame->pts = pts;
+            frame->epoch = s.epoch;
+            s.readStage = ReadStage::BODY;
+            s.readSize = 0;
         }
     } else {
-        assert(mReadSize <= mCurrentFrame->body->size);
-        if (mReadSize == mCurrentFrame->body->size) {
+        assert(s.readSize <= frame->body->size);
+        if (s.readSize == frame->body->size) {
             if (Config::Singleton()->debugNet) {
-                Log::I("read body, pts: %lld", (long long)mCurrentFrame->pts);
+                SS_LOG_I_DEFER("session %d read body, pts: %lld", s.index, (long long)frame->pts);
             }
 
-            DecodeThread::Singleton()->notifyDecodeFrame(mCurrentFrame);
+            frame->recvTp = chrono::high_resolution_clock::now();
+            Metrics::Add(Metrics::NET_FRAMES, s.index);
+            Metrics::Add(Metrics::NET_BYTES, s.index, (uint64_t)frame->body->size);
+            if (!s.firstFrameReceived && frame->pts != -1 && s.reconnects > 0) {
+                s.firstFrameReceived = true;
+                s.reconnectAttempts = 0;
+                Log::I(
+                    "session %d reconnect to first frame: %lldms, reconnects: %d",
+                    s.index,
+                    (long long)chrono::duration_cast<chrono::milliseconds>(
+                        frame->recvTp - s.disconnectTp)
+                        .count(),
+                    s.reconnects);
+            } else if (!s.firstFrameReceived && frame->pts != -1) {
+                s.firstFrameReceived = true;
+                StartupReport::End(StartupReport::FIRST_PACKET, frame->recvTp);
+                Log::I(
+                    "session %d time to first frame: %lldms, after connected: %lldms",
+                    s.index,
+                    (long long)chrono::duration_cast<chrono::milliseconds>(
+                        frame->recvTp - mStartTp)
+                        .count(),
+                    (long long)chrono::duration_cast<chrono::milliseconds>(
+                        frame->recvTp - s.connectedTp)
+                        .count());
+            }
+            // relay and record both need it, scan body once.
+            if (mRelay || RecordThread::Singleton()) {
+                frame->keyFrame = frame->pts != -1 && frame->scanKeyFrame();
+            }
+            if (mRelay) {
+                mRelay->publish(*frame);
+            }
+            if (RecordThread::Singleton()) {
+                RecordThread::Singleton()->notifyRecordFrame(*frame);
+            }
+            if (Config::Singleton()->pipeline == PipelineMode::INLINE) {
+                MainThread::Singleton()->notifyInlineNetFrame(frame);
+            } else {
+                DecodeThread::Singleton()->notifyDecodeFrame(frame);
+            }
 
-            mCurrentFrame = obtainNetFrame();
-            if (mCurrentFrame) {
-                mReadStage = ReadStage::HEAD;
-                mReadSize = 0;
+            s.currentFrame = ObtainNetFrame(s);
+            Metrics::Set(Metrics::FREE_NET_FRAMES, s.index, s.freeNetFrames.size());
+            if (s.currentFrame) {
+                s.readStage = ReadStage::HEAD;
+                s.readSize = 0;
             } else {
-                uv_read_stop((uv_stream_t*)&mClient);
+                uv_read_stop((uv_stream_t*)&s.client);
             }
         }
     }
 }
 
-void NetThread::step2() {
-    check_libuv(uv_timer_init(&*mLoop, &mWriteTimer), "uv_timer_init");
+void NetThread::startRead(Session& s) {
+    int r = uv_timer_init(&*mLoop, &s.writeTimer);
+    if (r != 0) {
+        Log::E(
+            "'uv_timer_init' fail: %s, at %s:%d",
+            uverror_tostring(r).c_str(),
+            __FILE__,
+            __LINE__);
+        reconnectSession(s);
+        return;
+    }
+    s.writeTimer.data = &s;
+    s.connected = true;
+
+    resumeRead(s);
+    if (s.closed || s.reconnecting) {
+        return;
+    }
 
-    mReadStage = ReadStage::HEAD;
-    mReadSize = 0;
-    mCurrentFrame = obtainNetFrame();
-    check_libuv(
-        uv_read_start(
-            (uv_stream_t*)&mClient,
-            [](uv_handle_t* handle, size_t suggestedSize, uv_buf_t* buf) {
-                NetThread::Singleton()->onReadAlloc(handle, suggestedSize, buf);
-            },
-            [](uv_stream_t* stream, ssize_t nread, const uv_buf_t* buf) {
-                NetThread::Singleton()->onRead(stream, nread, buf);
-            }),
-        "uv_read_start");
+    StartupReport::Begin(StartupReport::KEEP_ALIVE);
+    s.writeReq.data = &s;
+    r = uv_write(
+        &s.writeReq, (uv_stream_t*)&s.client, &WRITE_BUF, 1, [](uv_write_t* req, int status) {
+            NetThread::Singleton()->onWrite(SessionOf(req->data), status);
+        });
+    if (r != 0) {
+        Log::E("'uv_write' fail: %s, at %s:%d", uverror_tostring(r).c_str(), __FILE__, __LINE__);
+        reconnectSession(s);
+    }
+}
 
-    check_libuv(
-        uv_write(
-            &mWriteReq,
-            (uv_stream_t*)&mClient,
-            &WRITE_BUF,
-            1,
-            [](uv_write_t* req, int status) { NetThread::Singleton()->onWrite(req, status); }),
-        "uv_write");
+void NetThread::startInline() {
+    mInlineStarted = true;
+    startRead(*mSessions[0]);
+}
 
-    uv_run(&*mLoop, UV_RUN_DEFAULT);
+bool NetThread::pumpInline() {
+    if (!mClose) {
+        uv_run(&*mLoop, UV_RUN_NOWAIT);
+    }
+    return !mClose;
 }
 
 void NetThread::run() {
+    Trace::SetThreadName("net");
+    Bench::RegisterThread("net");
+    ApplyThreadPolicy(ThreadRole::NET);
     try {
-        step0();
-        step1();
-        step2();
+        mStartTp = chrono::high_resolution_clock::now();
+        for (int i = 0; i < mSessionCount; ++i) {
+            if (startDiscovery(*mSessions[i]) != 0) {
+                retryConnect(*mSessions[i]);
+            }
+        }
+
+        uv_run(&*mLoop, UV_RUN_DEFAULT);
+        if (mClose) {
+            throw TagExit {};
+        }
+
+        // only inline pipeline stop loop without close, after connected.
+        MainThread::Singleton()->notifyNetConnected();
+        Log::I_STR("net thread exit, loop hand over to main thread");
+        return;
     } catch (const TagExit&) {  //
     } catch (const Error& e) {
         Log::PrintError(e);
@@ -406,4 +850,4 @@ void NetThread::run() {
 
     Log::I_STR("net thread exit");
 }
-}  // namespace ss
\ No newline at end of file
+}  // namespace ss
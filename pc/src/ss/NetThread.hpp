@@ -1,8 +1,10 @@
 #pragma once
 #include <ss/Common.hpp>
+#include <ss/RelayServer.hpp>
+#include <ss/MetricsServer.hpp>
 
 namespace ss {
-/** net thread, handle net read/write. */
+/** net thread, handle net read/write of all sessions on one loop. */
 class NetThread : public xm::SingletonBase<NetThread> {
 public:
     NetThread();
@@ -19,15 +21,53 @@ public:
         uv_async_send(&mAsyncClose);
     }
 
+    /** ask sender of session to encode key frame now, ignored by sender not support it. */
+    void notifyRequestKeyFrame(int session) {
+        mKeyFrameRequests.fetch_or(1u << session);
+        uv_async_send(&mAsyncKeyFrame);
+    }
+
     void join() {
         mThread->join();
     }
 
+    /**
+     * inline pipeline only(one session), call on main thread after net thread handed over
+     * (connected). start read and keep-alive write, then loop is driven by `pumpInline`.
+     */
+    void startInline();
+
+    /** inline pipeline only, run loop without wait, return false if net closed. */
+    bool pumpInline();
+
+    /** inline pipeline only, fd to poll for loop events. */
+    int inlineBackendFd() {
+        return uv_backend_fd(&*mLoop);
+    }
+
+    /** inline pipeline only, return timeout(ms) of loop's next timer, -1 if no timer. */
+    int inlineBackendTimeout() {
+        return uv_backend_timeout(&*mLoop);
+    }
+
+    /** inline pipeline only, recycle net-frame on loop's thread without async wakeup. */
+    void recycleNetFrameInline(NetFrame* netFrame) {
+        Session& s = *mSessions[netFrame->session];
+        s.freeNetFrames.push_back(netFrame);
+        resumeRead(s);
+    }
+
 private:
     enum : uint8_t {
         NET_FRAME_POOL_CAPACITY = 20,
     };
 
+    enum : int {
+        /** reconnect delay, doubled by each failed attempt. */
+        RECONNECT_DELAY_MS = 250,
+        RECONNECT_DELAY_MAX_MS = 4000,
+    };
+
     enum class ReadStage {
         HEAD,
         BODY,
@@ -58,26 +98,63 @@ private:
         }
     };
 
-    /** java data is big endian, we need check and convert. */
-    template <typename T>
-    static T GetJavaData(const char* p) {
-#if defined(SS_IS_LITTLE)
-        alignas(T) char tmp[sizeof(T)];
-        for (int i = 0, e = sizeof(T); i < e; ++i) {
-            tmp[i] = p[e - i - 1];
-        }
-        return *(const T*)tmp;
-#else
-        return *(const T*)p;
-#endif
+    /** connection of one session, handles' data point to it. */
+    struct Session : xm::NonCopyable {
+        int index = 0;
+        std::string remoteIp;
+        /** closed by net error or timeout, other sessions keep going. */
+        bool closed = false;
+        /** read started, can write to sender. */
+        bool connected = false;
+        bool keyFrameWriting = false;
+        int connectTimerCount = 10;
+        /** connecting to cached sender while broadcast receiving, first success wins. */
+        bool racing = false;
+        /** connect handles closing, then connect again if `connectAfterReset`. */
+        int resetting = 0;
+        bool connectAfterReset = false;
+        /** first non-config frame received, of current connection. */
+        bool firstFrameReceived = false;
+        chrono::high_resolution_clock::time_point connectedTp;
+        /** connected once, net error then reconnect instead of close. */
+        bool everConnected = false;
+        /** connection lost, wait handles closed and reconnect timer. */
+        bool reconnecting = false;
+        int reconnects = 0;
+        /** failed attempts since last frame received, for backoff. */
+        int reconnectAttempts = 0;
+        /** connection generation, set to net-frames. */
+        uint32_t epoch = 0;
+        chrono::high_resolution_clock::time_point disconnectTp;
+
+        std::optional<NetFrame> netFramePool[NET_FRAME_POOL_CAPACITY];
+        xm::Array<NetFrame*> freeNetFrames;
+
+        /** first 4 bytes for packet size, after 8 bytes for pts. */
+        char header[12] = {};
+        ReadStage readStage = ReadStage::HEAD;
+        ssize_t readSize = 0;
+        NetFrame* currentFrame = nullptr;
+
+        uv_connect_t connectReq = {};
+        uv_write_t writeReq = {};
+        uv_write_t keyFrameWriteReq = {};
+        uv_timer_t connectTimer = {};
+        uv_timer_t writeTimer = {};
+        uv_timer_t reconnectTimer = {};
+        uv_tcp_t client = {};
+    };
+
+    static Session& SessionOf(void* data) {
+        return *(Session*)data;
     }
 
-    NetFrame* obtainNetFrame() {
-        if (mFreeNetFrames.empty()) {
+    static NetFrame* ObtainNetFrame(Session& s) {
+        if (s.freeNetFrames.empty()) {
             return nullptr;
         } else {
-            NetFrame* netFrame = mFreeNetFrames.back();
-            mFreeNetFrames.pop_back();
+            NetFrame* netFrame = s.freeNetFrames.back();
+            s.freeNetFrames.pop_back();
             return netFrame;
         }
     }
@@ -93,10 +170,26 @@ private:
         return mLoop->stop_flag == 1;
     }
 
+    /** close session's handles, stop loop if all sessions closed. */
+    void closeSession(Session& s);
+
+    /**
+     * net error of session, close connection and find sender again, decoder and window kept.
+     * close session if reconnect disabled or never connected.
+     */
+    void reconnectSession(Session& s);
+
+    void onReconnectTimer(Session& s);
+
+    /** if read stopped by net-frame pool exhausted, obtain one and restart read. */
+    void resumeRead(Session& s);
+
     void onAsyncRecycle(uv_async_t* handle);
 
     void onAsyncClose(uv_async_t* handle);
 
+    void onAsyncKeyFrame(uv_async_t* handle);
+
     void onBroadcastRead(
         uv_udp_t* handle,
         ssize_t nread,
@@ -106,55 +199,80 @@ private:
 
     void onBroadcastTimer(uv_timer_t* handle);
 
-    void step0();
+    /** find sender of session 0 by broadcast, then connect. libuv error, never throw. */
+    int startBroadcast();
+
+    void stopBroadcast();
+
+    /** last sender found by broadcast, empty if none. */
+    static std::string LoadSenderCache();
 
-    void onConnect(uv_connect_t* req, int status);
+    static void SaveSenderCache(const std::string& ip);
 
-    void onConnectTimer(uv_timer_t* handle);
+    /**
+     * connect to configured ip, or cached sender racing with broadcast. libuv error(e.g.
+     * ENETUNREACH), never throw, caller `retryConnect` on fail.
+     */
+    int startDiscovery(Session& s);
 
-    void step1();
+    /** libuv error, never throw. */
+    int startConnect(Session& s);
 
-    void onWriteTimer(uv_timer_t* handle);
+    /** start connect fail, reconnect after backoff, or close session if never connected. */
+    void retryConnect(Session& s);
 
-    void onWrite(uv_write_t* req, int status);
+    /** close connection handles, then `onConnectReset`. */
+    void resetConnect(Session& s);
 
-    void onReadAlloc(uv_handle_t* handle, size_t suggestedSize, uv_buf_t* buf);
+    /** connect again if `connectAfterReset`, or start reconnect timer if reconnecting. */
+    void onConnectReset(Session& s);
 
-    void onRead(uv_stream_t* stream, ssize_t nread, const uv_buf_t* buf);
+    void onConnect(Session& s, int status);
 
-    void step2();
+    void onConnectTimer(Session& s);
+
+    void onWriteTimer(Session& s);
+
+    void onWrite(Session& s, int status);
+
+    void onReadAlloc(Session& s, uv_buf_t* buf);
+
+    void onRead(Session& s, ssize_t nread);
+
+    void startRead(Session& s);
 
     void run();
 
     // ----
 
     bool mClose = false;
+    /** inline pipeline only, loop handed over to main thread. */
+    bool mInlineStarted = false;
+    int mSessionCount = 1;
 
-    std::optional<NetFrame> mNetFramePool[NET_FRAME_POOL_CAPACITY];
-    xm::Array<NetFrame*> mFreeNetFrames;
     std::mutex mCacheFreeNetFrameLock;
     xm::Array<NetFrame*> mCacheFreeNetFrames;  // guard by mCacheFreeNetFrameLock.
+    /** bit of session index. */
+    std::atomic<uint32_t> mKeyFrameRequests = 0;
 
-    std::string mRemoteIp;
-
+    /** keep alive, sender ignore content except key frame request. */
     const uv_buf_t WRITE_BUF = uv_buf_init((char*)"a", 1);
-    /** first 4 bytes for packet size, after 8 bytes for pts. */
-    char mHeader[12] = {};
-    ReadStage mReadStage = ReadStage::HEAD;
-    ssize_t mReadSize = 0;
-    NetFrame* mCurrentFrame = nullptr;
-
-	uv_connect_t mConnectReq = {};
-    uv_write_t mWriteReq = {};
+    const uv_buf_t KEY_FRAME_BUF = uv_buf_init((char*)"k", 1);
+
+    int mBroadcastTimerCount = 25;
+    /** for time to first frame. */
+    chrono::high_resolution_clock::time_point mStartTp;
     uv_async_t mAsyncRecycle = {};
     uv_async_t mAsyncClose = {};
+    uv_async_t mAsyncKeyFrame = {};
     uv_udp_t mBroadcastClient = {};
     uv_timer_t mBroadcastTimer = {};
-    uv_timer_t mConnectTimer = {};
-    uv_timer_t mWriteTimer = {};
-    uv_tcp_t mClient = {};
+    std::optional<Session> mSessions[MAX_SESSION];
+    /** before mLoop, outlive handles closed by loop. */
+    std::optional<RelayServer> mRelay;
+    std::optional<MetricsServer> mMetricsServer;
     std::optional<RaiiUvLoop> mLoop;
 
     std::optional<std::thread> mThread;
 };
-}  // namespace ss
\ No newline at end of file
+}  // namespace ss
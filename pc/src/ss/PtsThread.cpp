@@ -1,6 +1,10 @@
 #include <ss/PtsThread.hpp>
 #include <ss/MainThread.hpp>
 #include <ss/DecodeThread.hpp>
+#include <ss/Metrics.hpp>
+#include <ss/Trace.hpp>
+#include <ss/Bench.hpp>
+#include <ss/ThreadPolicy.hpp>
 
 #if defined(XM_OS_WINDOWS)
     #include <timeapi.h>
@@ -20,51 +24,77 @@ PtsThread::PtsThread() {
     }
 }
 
+void PtsThread::schedule(PaintFrame* paintFrame) {
+    int session = paintFrame->session;
+    clock::time_point now = clock::now();
+    Scheduled item = {now, now, paintFrame};
+    if (mFirstPts[session] == 0 || paintFrame->epoch != mEpoch[session]) {
+        // reconnected sender may restart pts.
+        mEpoch[session] = paintFrame->epoch;
+        mFirstPts[session] = paintFrame->pts;
+        mFirstTp[session] = now;
+    } else {
+        item.dueTp = mFirstTp[session] +
+                     chrono::microseconds(paintFrame->pts - mFirstPts[session]);
+    }
+
+    auto pos = std::upper_bound(
+        mScheduled.begin(),
+        mScheduled.end(),
+        item.dueTp,
+        [](const clock::time_point& tp, const Scheduled& i) { return tp < i.dueTp; });
+    mScheduled.insert(pos, item);
+    Metrics::Add(Metrics::PTS_QUEUE, session, 1);
+}
+
+chrono::milliseconds PtsThread::dispatch() {
+    while (!mScheduled.empty()) {
+        const Scheduled& item = mScheduled.front();
+        clock::time_point now = clock::now();
+        if (item.dueTp > now) {
+            return chrono::ceil<chrono::milliseconds>(item.dueTp - now);
+        }
+
+        if (Config::Singleton()->debugPts) {
+            SS_LOG_I_DEFER(
+                "expect wait: %lldms, real wait: %lldms, pts: %lld, session: %d",
+                (long long)chrono::duration_cast<chrono::milliseconds>(
+                    item.dueTp - item.scheduleTp)
+                    .count(),
+                (long long)chrono::duration_cast<chrono::milliseconds>(now - item.scheduleTp)
+                    .count(),
+                (long long)item.paintFrame->pts,
+                item.paintFrame->session);
+        }
+
+        item.paintFrame->releaseTp = now;
+        Metrics::Add(Metrics::PTS_QUEUE, item.paintFrame->session, -1);
+        MainThread::Singleton()->notifyPaintFrame(item.paintFrame);
+        mScheduled.pop_front();
+    }
+    return chrono::milliseconds(2000);
+}
+
 void PtsThread::run() {
     Log::I_STR("pts thread run");
+    Trace::SetThreadName("pts");
+    Bench::RegisterThread("pts");
+    ApplyThreadPolicy(ThreadRole::PTS);
 
     struct TagExit {};
 
     try {
+        chrono::milliseconds wait(2000);
         while (!mClose) {
-            PaintFrame* paintFrame = nullptr;
-            std::optional<PaintFrame*> tmp =
-                mPendingPaintFrames.pop_front(std::chrono::milliseconds(2000));
-            if (!tmp) {
-                continue;
-            } else {
-                paintFrame = *tmp;
-                if (!paintFrame) {
+            std::optional<PaintFrame*> tmp = mPendingPaintFrames.pop_front(wait);
+            TraceZone zone("pts dispatch");
+            if (tmp) {
+                if (!*tmp) {
                     throw TagExit {};
                 }
+                schedule(*tmp);
             }
-
-            if (mFirstPts == 0) {
-                mFirstPts = paintFrame->pts;
-                mFirstTp = clock::now();
-                MainThread::Singleton()->notifyPaintFrame(paintFrame);
-            } else {
-                clock::time_point now0 = clock::now();
-                chrono::milliseconds expectWait = chrono::duration_cast<chrono::milliseconds>(
-                    mFirstTp + chrono::microseconds(paintFrame->pts - mFirstPts) - now0);
-
-                if (expectWait > chrono::milliseconds(0)) {
-                    std::this_thread::sleep_for(expectWait);
-                }
-
-                if (Config::Singleton()->debugPts) {
-                    clock::time_point now1 = clock::now();
-                    chrono::milliseconds realWait =
-                        chrono::duration_cast<chrono::milliseconds>(now1 - now0);
-                    Log::I(
-                        "expect wait: %lldms, real wait: %lldms, pts: %lld",
-                        (long long)expectWait.count(),
-                        (long long)realWait.count(),
-                        (long long)paintFrame->pts);
-                }
-
-                MainThread::Singleton()->notifyPaintFrame(paintFrame);
-            }
+            wait = dispatch();
         }
     } catch (const TagExit&) {  //
     } catch (const Error& e) {
@@ -77,4 +107,4 @@ void PtsThread::run() {
 
     Log::I_STR("pts thread exit");
 }
-}  // namespace ss
\ No newline at end of file
+}  // namespace ss
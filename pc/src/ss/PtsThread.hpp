@@ -2,7 +2,10 @@
 #include <ss/Common.hpp>
 
 namespace ss {
-/** pts thread, handle frame sync with present timestamp. */
+/**
+ * pts thread, handle frame sync with present timestamp. each session has own pts origin,
+ * frames of all sessions wait in one schedule ordered by due time.
+ */
 class PtsThread : public xm::SingletonBase<PtsThread> {
 public:
     PtsThread();
@@ -23,13 +26,29 @@ public:
 private:
     using clock = std::chrono::high_resolution_clock;
 
+    struct Scheduled {
+        clock::time_point dueTp;
+        /** for debug pts. */
+        clock::time_point scheduleTp;
+        PaintFrame* paintFrame;
+    };
+
+    void schedule(PaintFrame* paintFrame);
+
+    /** notify main thread frames due, return wait time until next due. */
+    chrono::milliseconds dispatch();
+
     void run();
 
     // ----
 
     bool mClose = false;
-    int64_t mFirstPts = 0;
-    clock::time_point mFirstTp;
+    int64_t mFirstPts[MAX_SESSION] = {};
+    /** pts origin restart when epoch changed(reconnected). */
+    uint32_t mEpoch[MAX_SESSION] = {};
+    clock::time_point mFirstTp[MAX_SESSION];
+    /** ordered by dueTp, pts thread only. */
+    std::deque<Scheduled> mScheduled;
     BlockingQueue<PaintFrame*> mPendingPaintFrames;
     std::optional<std::thread> mThread;
 };
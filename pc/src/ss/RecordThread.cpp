@@ -0,0 +1,248 @@
+#include <ss/RecordThread.hpp>
+#include <ss/Metrics.hpp>
+#include <ss/Trace.hpp>
+#include <ss/Bench.hpp>
+#include <ss/ThreadPolicy.hpp>
+
+namespace ss {
+RecordThread::RecordThread() {
+    try {
+        mThread.emplace([this]() { run(); });
+    } catch (const std::exception& e) {
+        SS_THROW(0, "create thread fail: %s", e.what());
+    }
+}
+
+RecordThread::~RecordThread() {
+    // drop items queued after close.
+    while (std::optional<Item> item = mPendingItems.pop_front(chrono::milliseconds(0))) {
+        av_packet_free(&item->packet);
+    }
+}
+
+void RecordThread::notifyRecordFrame(const NetFrame& frame) {
+    int session = frame.session;
+    bool config = frame.pts == -1;
+    bool keyFrame = frame.keyFrame;
+    // new connection may start from any frame, reference of previous stream not valid.
+    if (frame.epoch != mEpochs[session]) {
+        mEpochs[session] = frame.epoch;
+        mWaitKeyFrame[session] = true;
+    }
+    if (keyFrame) {
+        mWaitKeyFrame[session] = false;
+    }
+    // config never dropped, it is small and required by next segment.
+    if (!config && (mWaitKeyFrame[session] || mQueued >= QUEUE_LIMIT)) {
+        if (!mWaitKeyFrame[session]) {
+            mWaitKeyFrame[session] = true;
+            Log::W("record queue full, skip to next key frame, session: %d", session);
+        }
+        ++mDropFrames;
+        Metrics::Add(Metrics::RECORD_DROPPED_FRAMES, 0);
+        return;
+    }
+
+    AVPacket* packet = av_packet_alloc();
+    if (!packet || av_packet_ref(packet, frame.body) != 0) {
+        Log::E("record ref packet fail, session: %d", session);
+        av_packet_free(&packet);
+        return;
+    }
+    ++mQueued;
+    mPendingItems.push_back(Item {session, frame.epoch, frame.pts, keyFrame, packet});
+}
+
+std::string RecordThread::makePath(int session, int segment) {
+    const std::string& path = Config::Singleton()->recordPath;
+    size_t dot = path.rfind('.');
+    size_t slash = path.find_last_of("/\\");
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) {
+        dot = path.size();
+    }
+    std::string suffix;
+    if (Config::Singleton()->sessionCount() > 1) {
+        suffix += "_" + std::to_string(session);
+    }
+    if (segment > 0) {
+        suffix += "_" + std::to_string(segment);
+    }
+    return path.substr(0, dot) + suffix + path.substr(dot);
+}
+
+void RecordThread::open(Muxer& m, int session, const AVPacket* keyPacket) {
+    std::string path = makePath(session, m.segment);
+
+    // size only in sps, parse config and key frame once per segment.
+    int width = 0;
+    int height = 0;
+    {
+        AVCodecParserContext* parser = av_parser_init(AV_CODEC_ID_H264);
+        AVCodecContext* ctx = avcodec_alloc_context3(nullptr);
+        if (parser && ctx) {
+            parser->flags |= PARSER_FLAG_COMPLETE_FRAMES;
+            xm::Array<uint8_t> data(m.config.begin(), m.config.end());
+            data.insert(data.end(), keyPacket->data, keyPacket->data + keyPacket->size);
+            uint8_t* out = nullptr;
+            int outSize = 0;
+            av_parser_parse2(
+                parser,
+                ctx,
+                &out,
+                &outSize,
+                data.data(),
+                (int)data.size(),
+                AV_NOPTS_VALUE,
+                AV_NOPTS_VALUE,
+                0);
+            width = parser->width;
+            height = parser->height;
+        }
+        avcodec_free_context(&ctx);
+        if (parser) {
+            av_parser_close(parser);
+        }
+    }
+    if (width <= 0 || height <= 0) {
+        Log::W("record parse video size fail, session: %d", session);
+    }
+
+    check_libav(
+        avformat_alloc_output_context2(&m.formatCtx, nullptr, nullptr, path.c_str()),
+        "avformat_alloc_output_context2");
+    m.stream = avformat_new_stream(m.formatCtx, nullptr);
+    SS_THROW(m.stream, "'avformat_new_stream' fail");
+    m.stream->time_base = av_make_q(1, 1000000);
+    AVCodecParameters* par = m.stream->codecpar;
+    par->codec_type = AVMEDIA_TYPE_VIDEO;
+    par->codec_id = AV_CODEC_ID_H264;
+    par->width = width;
+    par->height = height;
+    // annex b extradata, converted to avcC by muxer.
+    par->extradata = (uint8_t*)av_mallocz(m.config.size() + AV_INPUT_BUFFER_PADDING_SIZE);
+    SS_THROW(par->extradata, "'av_mallocz' fail");
+    ::memcpy(par->extradata, m.config.data(), m.config.size());
+    par->extradata_size = (int)m.config.size();
+
+    if (!(m.formatCtx->oformat->flags & AVFMT_NOFILE)) {
+        check_libav(avio_open(&m.formatCtx->pb, path.c_str(), AVIO_FLAG_WRITE), "avio_open");
+    }
+
+    AVDictionary* options = nullptr;
+    // fragmented mp4 keep playable if app killed before trailer written.
+    if (::strcmp(m.formatCtx->oformat->name, "mp4") == 0 ||
+        ::strcmp(m.formatCtx->oformat->name, "mov") == 0) {
+        av_dict_set(&options, "movflags", "frag_keyframe+empty_moov", 0);
+    }
+    int r = avformat_write_header(m.formatCtx, &options);
+    av_dict_free(&options);
+    check_libav(r, "avformat_write_header");
+    m.headerWritten = true;
+    m.firstPts = -1;
+    Log::I("record start: %s, size: %dx%d", path.c_str(), width, height);
+}
+
+void RecordThread::close(Muxer& m) {
+    if (!m.formatCtx) {
+        return;
+    }
+    if (m.headerWritten) {
+        int r = av_write_trailer(m.formatCtx);
+        if (r != 0) {
+            Log::E("'av_write_trailer' fail: %s", averror_tostring(r).c_str());
+        }
+    }
+    if (!(m.formatCtx->oformat->flags & AVFMT_NOFILE)) {
+        avio_closep(&m.formatCtx->pb);
+    }
+    avformat_free_context(m.formatCtx);
+    m.formatCtx = nullptr;
+    m.stream = nullptr;
+    m.headerWritten = false;
+}
+
+void RecordThread::write(const Item& item) {
+    Muxer& m = mMuxers[item.session];
+    AVPacket* packet = item.packet;
+    if (m.failed) {
+        return;
+    }
+
+    if (item.pts == -1) {
+        bool same = m.config.size() == (size_t)packet->size &&
+                    ::memcmp(m.config.data(), packet->data, packet->size) == 0;
+        if (!same) {
+            if (m.formatCtx) {
+                close(m);
+                ++m.segment;
+            }
+            m.config.assign(packet->data, packet->data + packet->size);
+        }
+        return;
+    }
+
+    if (!m.formatCtx) {
+        // file start from key frame with config.
+        if (m.config.empty() || !item.keyFrame) {
+            return;
+        }
+        open(m, item.session, packet);
+    }
+
+    if (m.firstPts == -1) {
+        m.epoch = item.epoch;
+        m.firstPts = item.pts;
+        m.lastPts = -1;
+        m.lastDuration = 0;
+    } else if (item.epoch != m.epoch) {
+        // sender pts restart after reconnect, continue one frame after last.
+        m.epoch = item.epoch;
+        m.firstPts = item.pts - (m.lastPts + std::max<int64_t>(m.lastDuration, 1));
+    }
+    // muxer require increasing timestamps.
+    int64_t pts = std::max(item.pts - m.firstPts, m.lastPts + 1);
+    if (m.lastPts >= 0) {
+        m.lastDuration = pts - m.lastPts;
+    }
+    m.lastPts = pts;
+    packet->pts = pts;
+    packet->dts = pts;
+    packet->stream_index = m.stream->index;
+    packet->flags = item.keyFrame ? AV_PKT_FLAG_KEY : 0;
+    av_packet_rescale_ts(packet, av_make_q(1, 1000000), m.stream->time_base);
+    check_libav(av_write_frame(m.formatCtx, packet), "av_write_frame");
+}
+
+void RecordThread::run() {
+    Log::I_STR("record thread run");
+    Trace::SetThreadName("record");
+    Bench::RegisterThread("record");
+    ApplyThreadPolicy(ThreadRole::RECORD);
+
+    while (true) {
+        std::optional<Item> item = mPendingItems.pop_front(chrono::milliseconds(-1));
+        if (!item->packet) {
+            break;
+        }
+        --mQueued;
+        try {
+            TraceZone zone("record write");
+            write(*item);
+        } catch (const Error& e) {
+            Log::PrintError(e);
+            Log::E("record stop, session: %d", item->session);
+            close(mMuxers[item->session]);
+            mMuxers[item->session].failed = true;
+        }
+        av_packet_free(&item->packet);
+    }
+
+    for (Muxer& m : mMuxers) {
+        close(m);
+    }
+    if (mDropFrames > 0) {
+        Log::W("record drop frames: %llu", (unsigned long long)mDropFrames.load());
+    }
+    Log::I_STR("record thread exit");
+}
+}  // namespace ss
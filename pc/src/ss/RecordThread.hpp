@@ -0,0 +1,91 @@
+#pragma once
+#include <ss/Common.hpp>
+
+extern "C" {
+#include <libavformat/avformat.h>
+}
+
+namespace ss {
+/**
+ * record thread, remux received h264 packets to mp4/mkv(by extension of `Config::recordPath`)
+ * without re-encoding. packets are referenced(no copy) to a bounded queue, net thread never
+ * blocked, if queue full drop packets until next key frame. a new file segment is started when
+ * stream config(sps/pps) changes, e.g. resolution change.
+ */
+class RecordThread : public xm::SingletonBase<RecordThread> {
+public:
+    RecordThread();
+
+    ~RecordThread();
+
+    /** queue frame to record, never block, call on net loop before frame recycled. */
+    void notifyRecordFrame(const NetFrame& frame);
+
+    void notifyClose() {
+        mPendingItems.push_back(Item {});
+    }
+
+    void join() {
+        mThread->join();
+    }
+
+private:
+    enum : int {
+        /** queued packets of all sessions, about 2s of one 60fps stream. */
+        QUEUE_LIMIT = 120,
+    };
+
+    struct Item {
+        int session = 0;
+        /** `NetFrame::epoch`, pts restart when changed(reconnected). */
+        uint32_t epoch = 0;
+        int64_t pts = 0;
+        bool keyFrame = false;
+        /** nullptr means close. */
+        AVPacket* packet = nullptr;
+    };
+
+    struct Muxer {
+        AVFormatContext* formatCtx = nullptr;
+        AVStream* stream = nullptr;
+        bool headerWritten = false;
+        /** file segment, increase when config changed. */
+        int segment = 0;
+        /** last config(sps/pps) frame, become extradata of stream. */
+        xm::Array<uint8_t> config;
+        /** epoch of `firstPts`, rebased to continue after `lastPts` when epoch changed. */
+        uint32_t epoch = 0;
+        int64_t firstPts = 0;
+        int64_t lastPts = 0;
+        /** last frame duration, gap between epochs. */
+        int64_t lastDuration = 0;
+        /** write fail, stop record the session. */
+        bool failed = false;
+    };
+
+    /** output path of session's segment, e.g. "a.mp4" -> "a_1_2.mp4" for session 1 segment 2. */
+    std::string makePath(int session, int segment);
+
+    void open(Muxer& m, int session, const AVPacket* keyPacket);
+
+    /** write trailer and close file. */
+    void close(Muxer& m);
+
+    void write(const Item& item);
+
+    void run();
+
+    // ----
+
+    /** net thread only, queue full or reconnected, skip to next key frame. */
+    bool mWaitKeyFrame[MAX_SESSION] = {};
+    /** net thread only, epoch of last queued frame. */
+    uint32_t mEpochs[MAX_SESSION] = {};
+    std::atomic<uint64_t> mDropFrames = 0;
+    std::atomic<int> mQueued = 0;
+    BlockingQueue<Item> mPendingItems;
+    /** record thread only. */
+    Muxer mMuxers[MAX_SESSION];
+    std::optional<std::thread> mThread;
+};
+}  // namespace ss
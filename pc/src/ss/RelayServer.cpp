@@ -0,0 +1,161 @@
+#include <ss/RelayServer.hpp>
+#include <ss/NetThread.hpp>
+#include <ss/Metrics.hpp>
+
+namespace ss {
+RelayServer::RelayServer(uv_loop_t* loop, int port)
+    : mTcp(
+          loop,
+          "relay",
+          "0.0.0.0",
+          port,
+          MAX_CLIENT,
+          {[this](Client& c) { onConnected(c); },
+           [this](Client& c, const char* data, size_t size) { onData(c, data, size); },
+           [this](Client& c) {
+               (void)c;
+               Log::I("relay client removed, clients: %d", (int)mTcp.clients().size());
+           }}) {
+    Log::I("relay listen on port: %d", port);
+}
+
+RelayServer::~RelayServer() {
+    if (mConfig) {
+        av_buffer_unref(&mConfig->buf);
+    }
+}
+
+RelayServer::Packet RelayServer::RefPacket(const Packet& packet) {
+    Packet r = packet;
+    r.buf = av_buffer_ref(packet.buf);
+    SS_THROW(r.buf, "'av_buffer_ref' fail");
+    return r;
+}
+
+void RelayServer::publish(const NetFrame& frame) {
+    // call by net loop(c code), so never throw from here.
+    try {
+        Packet packet = {frame.body->buf, frame.body->data, frame.body->size, frame.pts};
+        if (frame.pts == -1) {
+            if (mConfig) {
+                av_buffer_unref(&mConfig->buf);
+            }
+            mConfig = RefPacket(packet);
+            // config change, clients need it even if waiting key frame.
+            for (std::unique_ptr<Client>& c : mTcp.clients()) {
+                push(*c, packet);
+            }
+            return;
+        }
+
+        bool keyFrame = frame.keyFrame;
+        for (std::unique_ptr<Client>& c : mTcp.clients()) {
+            if (c->closing) {
+                continue;
+            }
+            if ((int)c->queue.size() >= QUEUE_LIMIT) {
+                dropQueue(*c);
+                if (!keyFrame) {
+                    NetThread::Singleton()->notifyRequestKeyFrame(0);
+                }
+            }
+            if (keyFrame) {
+                c->waitKeyFrame = false;
+            }
+            if (c->waitKeyFrame) {
+                ++c->dropFrames;
+                Metrics::Add(Metrics::RELAY_DROPPED_FRAMES, 0);
+                continue;
+            }
+            push(*c, packet);
+        }
+    } catch (const Error& e) {
+        Log::PrintError(e);
+    }
+}
+
+void RelayServer::onConnected(Client& c) {
+    uv_tcp_nodelay(&c.tcp, 1);
+    Log::I("relay client connected, clients: %d", (int)mTcp.clients().size());
+    if (mConfig) {
+        push(c, *mConfig);
+    }
+    // new client start from key frame.
+    NetThread::Singleton()->notifyRequestKeyFrame(0);
+}
+
+void RelayServer::push(Client& c, const Packet& packet) {
+    if (c.closing) {
+        return;
+    }
+    c.queue.push_back(RefPacket(packet));
+    writeNext(c);
+}
+
+void RelayServer::dropQueue(Client& c) {
+    std::deque<Packet> kept;
+    for (size_t i = 0; i < c.queue.size(); ++i) {
+        Packet& packet = c.queue[i];
+        // keep writing one and config.
+        if ((i == 0 && c.writing) || packet.pts == -1) {
+            kept.push_back(packet);
+        } else {
+            av_buffer_unref(&packet.buf);
+            ++c.dropFrames;
+            Metrics::Add(Metrics::RELAY_DROPPED_FRAMES, 0);
+        }
+    }
+    c.queue.swap(kept);
+    c.waitKeyFrame = true;
+    Log::W("relay client slow, drop frames: %llu", (unsigned long long)c.dropFrames);
+}
+
+void RelayServer::writeNext(Client& c) {
+    if (c.writing || c.closing || c.queue.empty()) {
+        return;
+    }
+
+    const Packet& packet = c.queue.front();
+    PutJavaData<uint32_t>(c.header, (uint32_t)packet.size);
+    PutJavaData<int64_t>(c.header + 4, packet.pts);
+    uv_buf_t bufs[2] = {
+        uv_buf_init(c.header, sizeof(c.header)),
+        uv_buf_init((char*)packet.data, (unsigned)packet.size),
+    };
+    c.writeReq.data = this;
+    int r = uv_write(
+        &c.writeReq, (uv_stream_t*)&c.tcp, bufs, 2, [](uv_write_t* req, int status) {
+            ((RelayServer*)req->data)->onWrite(*(Client*)req->handle->data, status);
+        });
+    if (r != 0) {
+        Log::E("'uv_write' fail: %s", uverror_tostring(r).c_str());
+        mTcp.closeClient(c);
+        return;
+    }
+    c.writing = true;
+}
+
+void RelayServer::onWrite(Client& c, int status) {
+    c.writing = false;
+    if (!c.queue.empty()) {
+        av_buffer_unref(&c.queue.front().buf);
+        c.queue.pop_front();
+    }
+    if (status != 0) {
+        if (!c.closing) {
+            Log::E("relay write fail: %s", uverror_tostring(status).c_str());
+            mTcp.closeClient(c);
+        }
+        return;
+    }
+    writeNext(c);
+}
+
+void RelayServer::onData(Client& c, const char* data, size_t size) {
+    (void)c;
+    // viewer only write keep alive, and key frame request after hidden.
+    if (::memchr(data, 'k', size)) {
+        NetThread::Singleton()->notifyRequestKeyFrame(0);
+    }
+}
+}  // namespace ss
@@ -0,0 +1,74 @@
+#pragma once
+#include <ss/TcpServer.hpp>
+
+#include <deque>
+
+namespace ss {
+/**
+ * relay received frames to downstream viewers(share_screen -ip=[relay] -port=[relayPort]), same
+ * framing as sender. run on net loop, frame body shared by AVBufferRef without copy. each client
+ * has own send queue, slow client drop queued frames and skip to next key frame.
+ */
+class RelayServer : public xm::NonCopyable {
+public:
+    RelayServer(uv_loop_t* loop, int port);
+
+    ~RelayServer();
+
+    /** queue frame to all clients, call on net loop before frame recycled. */
+    void publish(const NetFrame& frame);
+
+private:
+    enum : int {
+        MAX_CLIENT = 32,
+        /** client is slow if queued frames exceed it. */
+        QUEUE_LIMIT = 30,
+    };
+
+    /** reference of frame body. */
+    struct Packet {
+        AVBufferRef* buf;
+        const uint8_t* data;
+        int size;
+        int64_t pts;
+    };
+
+    struct Client : TcpClient {
+        uv_write_t writeReq = {};
+        char header[12] = {};
+        bool writing = false;
+        /** frames dropped until key frame, for new or slow client. */
+        bool waitKeyFrame = true;
+        uint64_t dropFrames = 0;
+        /** front is writing if `writing`. */
+        std::deque<Packet> queue;
+
+        ~Client() {
+            for (Packet& i : queue) {
+                av_buffer_unref(&i.buf);
+            }
+        }
+    };
+
+    static Packet RefPacket(const Packet& packet);
+
+    void onConnected(Client& c);
+
+    void push(Client& c, const Packet& packet);
+
+    /** drop queued frames except writing one and config, wait next key frame. */
+    void dropQueue(Client& c);
+
+    void writeNext(Client& c);
+
+    void onWrite(Client& c, int status);
+
+    void onData(Client& c, const char* data, size_t size);
+
+    // ----
+
+    /** last config frame(pts == -1), sent first to new client. */
+    std::optional<Packet> mConfig;
+    TcpServer<Client> mTcp;
+};
+}  // namespace ss
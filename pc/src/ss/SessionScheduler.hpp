@@ -0,0 +1,234 @@
+#pragma once
+#include <xm/NonCopyable.hpp>
+
+#include <atomic>
+#include <cassert>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+
+namespace ss {
+/**
+ * work-stealing scheduler of per-session ordered work. a session runs on at most one worker at
+ * a time, so work of one session keeps order. runnable sessions wait in deque of home
+ * worker(`session % workerCount`), idle worker steal whole session from others. in one deque,
+ * session of higher priority runs first.
+ */
+class SessionScheduler : public xm::NonCopyable {
+public:
+    enum : int {
+        MAX_SESSION = 64,
+        MAX_WORKER = 64,
+    };
+
+    /**
+     * run a slice of session's work on worker, return true if session may have more work.
+     * must not throw.
+     */
+    using SliceFn = std::function<bool(int session, int worker)>;
+
+    struct WorkerStats {
+        /** slices run. */
+        uint64_t slices = 0;
+        /** slices run of session stolen from other worker. */
+        uint64_t steals = 0;
+    };
+
+    SessionScheduler(int sessionCount, int workerCount, SliceFn slice)
+        : mSessionCount(sessionCount), mWorkerCount(workerCount), mSlice(std::move(slice)) {
+        for (int i = 0; i < mWorkerCount; ++i) {
+            mWorkers[i].emplace();
+        }
+        try {
+            for (int i = 0; i < mWorkerCount; ++i) {
+                mWorkers[i]->thread.emplace([this, i]() { run(i); });
+            }
+        } catch (...) {
+            // destructor not called on throw, joinable thread terminate on destroy.
+            stop();
+            join();
+            throw;
+        }
+    }
+
+    ~SessionScheduler() {
+        stop();
+        join();
+    }
+
+    int workerCount() const {
+        return mWorkerCount;
+    }
+
+    /** session may have new work, thread safe. */
+    void notifyRunnable(int session) {
+        assert(session >= 0 && session < mSessionCount);
+        std::atomic<int>& state = mSessions[session].state;
+        int s = state.load();
+        while (true) {
+            if (s == IDLE) {
+                if (state.compare_exchange_weak(s, QUEUED)) {
+                    enqueue(session % mWorkerCount, session);
+                    return;
+                }
+            } else if (s == RUNNING) {
+                // worker check it after slice.
+                if (state.compare_exchange_weak(s, RUNNING_AGAIN)) {
+                    return;
+                }
+            } else {
+                return;
+            }
+        }
+    }
+
+    /** higher run first, thread safe. */
+    void setPriority(int session, int priority) {
+        mSessions[session].priority = priority;
+    }
+
+    int priority(int session) const {
+        return mSessions[session].priority;
+    }
+
+    /** stop workers, pending work is dropped. */
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(mSleepLock);
+            mQuit = true;
+        }
+        mSleepCondition.notify_all();
+    }
+
+    void join() {
+        for (int i = 0; i < mWorkerCount; ++i) {
+            if (mWorkers[i]->thread && mWorkers[i]->thread->joinable()) {
+                mWorkers[i]->thread->join();
+            }
+        }
+    }
+
+    WorkerStats workerStats(int worker) const {
+        return {mWorkers[worker]->slices.load(), mWorkers[worker]->steals.load()};
+    }
+
+private:
+    /** session state. */
+    enum : int {
+        IDLE = 0,
+        /** in deque of worker. */
+        QUEUED,
+        RUNNING,
+        /** new work notified while running, queue again after slice. */
+        RUNNING_AGAIN,
+    };
+
+    struct Session {
+        std::atomic<int> state = IDLE;
+        std::atomic<int> priority = 0;
+    };
+
+    struct Worker {
+        std::mutex lock;
+        std::deque<int> sessions;  // guard by lock.
+        std::atomic<uint64_t> slices = 0;
+        std::atomic<uint64_t> steals = 0;
+        std::optional<std::thread> thread;
+    };
+
+    void enqueue(int worker, int session) {
+        {
+            std::lock_guard<std::mutex> lock(mWorkers[worker]->lock);
+            mWorkers[worker]->sessions.push_back(session);
+        }
+        {
+            std::lock_guard<std::mutex> lock(mSleepLock);
+            ++mQueued;
+        }
+        mSleepCondition.notify_one();
+    }
+
+    /** take session of highest priority from worker's deque, -1 if empty. */
+    int take(int worker) {
+        int session = -1;
+        {
+            std::lock_guard<std::mutex> lock(mWorkers[worker]->lock);
+            std::deque<int>& sessions = mWorkers[worker]->sessions;
+            if (sessions.empty()) {
+                return -1;
+            }
+            auto best = sessions.begin();
+            for (auto i = sessions.begin(); i != sessions.end(); ++i) {
+                if (mSessions[*i].priority > mSessions[*best].priority) {
+                    best = i;
+                }
+            }
+            session = *best;
+            sessions.erase(best);
+        }
+        std::lock_guard<std::mutex> lock(mSleepLock);
+        --mQueued;
+        return session;
+    }
+
+    void run(int worker) {
+        Worker& self = *mWorkers[worker];
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(mSleepLock);
+                mSleepCondition.wait(lock, [this]() { return mQuit || mQueued > 0; });
+                if (mQuit) {
+                    return;
+                }
+            }
+
+            bool stolen = false;
+            int session = take(worker);
+            for (int i = 1; session < 0 && i < mWorkerCount; ++i) {
+                session = take((worker + i) % mWorkerCount);
+                stolen = session >= 0;
+            }
+            if (session < 0) {
+                // taken by other worker between wakeup and take.
+                std::this_thread::yield();
+                continue;
+            }
+
+            ++self.slices;
+            if (stolen) {
+                ++self.steals;
+            }
+
+            std::atomic<int>& state = mSessions[session].state;
+            state = RUNNING;
+            bool more = mSlice(session, worker);
+            int s = RUNNING;
+            if (more || !state.compare_exchange_strong(s, IDLE)) {
+                // requeue at back, let other sessions of this worker run.
+                state = QUEUED;
+                enqueue(worker, session);
+            }
+        }
+    }
+
+    // ----
+
+    int mSessionCount = 1;
+    int mWorkerCount = 1;
+    SliceFn mSlice;
+
+    Session mSessions[MAX_SESSION];
+    std::optional<Worker> mWorkers[MAX_WORKER];
+
+    std::mutex mSleepLock;
+    std::condition_variable mSleepCondition;
+    /** guard by mSleepLock. */
+    bool mQuit = false;
+    int mQueued = 0;
+};
+}  // namespace ss
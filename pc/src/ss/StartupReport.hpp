@@ -0,0 +1,128 @@
+#pragma once
+#include <ss/Common.hpp>
+
+namespace ss {
+/**
+ * startup phases of first connection, begin/end time relative to process start. phases may
+ * overlap(window/gl init run with discovery and connect), report compare time to first frame
+ * with serial sum of phases. only first begin/end of phase recorded, reconnect ignored.
+ */
+class StartupReport : public xm::SingletonBase<StartupReport> {
+public:
+    using clock = chrono::high_resolution_clock;
+
+    enum Phase : int {
+        /** process start -> command line parsed. */
+        CONFIG = 0,
+        DECODER_OPEN,
+        WINDOW_GL,
+        /** sender address known, by -ip, broadcast or cached sender connected. */
+        DISCOVERY,
+        CONNECT,
+        /** first keep alive write, inside FIRST_PACKET. */
+        KEEP_ALIVE,
+        /** connected -> first image frame received. */
+        FIRST_PACKET,
+        FIRST_DECODE,
+        FIRST_PRESENT,
+        PHASE_COUNT,
+    };
+
+    StartupReport() : mStartTp(clock::now()) {
+        for (int i = 0; i < PHASE_COUNT; ++i) {
+            mBegin[i] = -1;
+            mEnd[i] = -1;
+        }
+        mBegin[CONFIG] = 0;
+    }
+
+    /** thread safe, no-op if not instanced. */
+    static void Begin(Phase phase, clock::time_point tp = clock::now()) {
+        if (StartupReport* self = Singleton()) {
+            self->set(self->mBegin[phase], tp);
+        }
+    }
+
+    /** thread safe, ignored if phase not begin. */
+    static void End(Phase phase, clock::time_point tp = clock::now()) {
+        if (StartupReport* self = Singleton(); self && self->mBegin[phase] >= 0) {
+            self->set(self->mEnd[phase], tp);
+        }
+    }
+
+    /** print report once, call after first frame presented or at exit. */
+    void report() {
+        if (mReported.exchange(true)) {
+            return;
+        }
+
+        static const char* const NAMES[PHASE_COUNT] = {
+            "config",
+            "decoder open",
+            "window/gl",
+            "discovery",
+            "connect",
+            "keep alive",
+            "first packet",
+            "first decode",
+            "first present",
+        };
+
+        std::string str = "startup report(ms since process start):";
+        char line[128];
+        double serial = 0;
+        for (int i = 0; i < PHASE_COUNT; ++i) {
+            int64_t begin = mBegin[i];
+            int64_t end = mEnd[i];
+            if (begin < 0) {
+                snprintf(line, sizeof(line), "\n- %-14s not run", NAMES[i]);
+            } else if (end < 0) {
+                snprintf(
+                    line, sizeof(line), "\n- %-14s %8.1f -> unfinished", NAMES[i], begin / 1e3);
+            } else {
+                snprintf(
+                    line,
+                    sizeof(line),
+                    "\n- %-14s %8.1f -> %8.1f, %8.1f",
+                    NAMES[i],
+                    begin / 1e3,
+                    end / 1e3,
+                    (end - begin) / 1e3);
+                // keep alive is part of first packet.
+                serial += i == KEEP_ALIVE ? 0 : (end - begin) / 1e3;
+            }
+            str += line;
+        }
+
+        int64_t firstFrame = mEnd[FIRST_PRESENT];
+        if (firstFrame >= 0) {
+            snprintf(
+                line,
+                sizeof(line),
+                "\ntime to first frame: %.1f, serial sum of phases: %.1f, saved by overlap: %.1f",
+                firstFrame / 1e3,
+                serial,
+                serial - firstFrame / 1e3);
+            str += line;
+        } else {
+            str += "\nno frame presented";
+        }
+        Log::I_STR(str.c_str());
+    }
+
+private:
+    void set(std::atomic<int64_t>& slot, clock::time_point tp) {
+        int64_t expect = -1;
+        int64_t us = chrono::duration_cast<chrono::microseconds>(tp - mStartTp).count();
+        slot.compare_exchange_strong(expect, us);
+    }
+
+    // ----
+
+    clock::time_point mStartTp;
+    /** microseconds since start, -1 if not set. */
+    std::atomic<int64_t> mBegin[PHASE_COUNT];
+    std::atomic<int64_t> mEnd[PHASE_COUNT];
+    std::atomic<bool> mReported = false;
+};
+}  // namespace ss
@@ -0,0 +1,159 @@
+#include <ss/SwRender.hpp>
+
+namespace ss {
+SwRender::SwRender(int threadCount) {
+    mLastFrame = av_frame_alloc();
+    SS_THROW(mLastFrame, "'av_frame_alloc' fail");
+
+    mBandCount = std::clamp(threadCount, 1, (int)MAX_THREAD);
+    // band 0 convert by caller thread.
+    for (int i = 1; i < mBandCount; ++i) {
+        mWorkers[i].emplace([this, i]() { runWorker(i); });
+    }
+    Log::I(
+        "software render, yuv to bgra: %s, threads: %d",
+        YuvToBgra::BestKernelName(),
+        mBandCount);
+}
+
+SwRender::~SwRender() {
+    {
+        std::lock_guard<std::mutex> lock(mLock);
+        mQuit = true;
+    }
+    mJobCondition.notify_all();
+    for (std::optional<std::thread>& worker : mWorkers) {
+        if (worker) {
+            worker->join();
+        }
+    }
+    av_frame_free(&mLastFrame);
+}
+
+void SwRender::paint(PaintFrame* paintFrame, const Target& target) {
+    if (paintFrame) {
+        AVFrame* decodeF = paintFrame->decodeFrame;
+        if (decodeF->format != AV_PIX_FMT_YUV420P && decodeF->format != AV_PIX_FMT_YUVJ420P) {
+            const char* formatName = av_get_pix_fmt_name((AVPixelFormat)decodeF->format);
+            if (!formatName)
+                formatName = "unknown";
+            SS_THROW(
+                0,
+                "format not supported, expect: AV_PIX_FMT_YUV420P/YUVJ420P, now: %s",
+                formatName);
+        }
+        // keep frame buffers for repaint, paint-frame recycle after paint.
+        av_frame_unref(mLastFrame);
+        check_libav(av_frame_ref(mLastFrame, decodeF), "av_frame_ref");
+    }
+
+    if (!mLastFrame->data[0]) {
+        for (int y = 0; y < target.h; ++y) {
+            ::memset(target.data + (size_t)y * target.stride, 0x7f, (size_t)target.w * 4);
+        }
+        return;
+    }
+
+    const AVFrame* f = mLastFrame;
+    int key[3] = {f->format, f->colorspace, f->color_range};
+    if (::memcmp(key, mColorKey, sizeof(key)) != 0) {
+        ::memcpy(mColorKey, key, sizeof(key));
+        // same as GlRender, unspecified as bt.601 limited range.
+        float kr = 0.299f;
+        float kb = 0.114f;
+        if (f->colorspace == AVCOL_SPC_BT709) {
+            kr = 0.2126f;
+            kb = 0.0722f;
+        } else if (f->colorspace == AVCOL_SPC_BT2020_NCL || f->colorspace == AVCOL_SPC_BT2020_CL) {
+            kr = 0.2627f;
+            kb = 0.0593f;
+        }
+        bool fullRange = f->format == AV_PIX_FMT_YUVJ420P || f->color_range == AVCOL_RANGE_JPEG;
+        mCoeffs = YuvToBgra::MakeCoeffs(kr, kb, fullRange);
+    }
+
+    if (f->width != target.w && (f->width != mMapSrcW || (int)mMapX.size() != target.w)) {
+        mMapSrcW = f->width;
+        mMapX.resize((size_t)target.w);
+        for (int x = 0; x < target.w; ++x) {
+            mMapX[x] = (int)((int64_t)x * f->width / target.w);
+        }
+        for (int i = 0; i < mBandCount; ++i) {
+            mRowBuffers[i].resize((size_t)f->width);
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mLock);
+        mJob.frame = f;
+        mJob.target = target;
+        mJob.coeffs = mCoeffs;
+        mPendingBands = mBandCount - 1;
+        ++mJobGeneration;
+    }
+    mJobCondition.notify_all();
+
+    convertBand(0);
+
+    std::unique_lock<std::mutex> lock(mLock);
+    mDoneCondition.wait(lock, [this]() { return mPendingBands == 0; });
+}
+
+void SwRender::runWorker(int band) {
+    uint64_t generation = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mLock);
+            mJobCondition.wait(lock, [&]() { return mQuit || mJobGeneration != generation; });
+            if (mQuit) {
+                return;
+            }
+            generation = mJobGeneration;
+        }
+
+        convertBand(band);
+
+        bool done;
+        {
+            std::lock_guard<std::mutex> lock(mLock);
+            done = --mPendingBands == 0;
+        }
+        if (done) {
+            mDoneCondition.notify_one();
+        }
+    }
+}
+
+void SwRender::convertBand(int band) {
+    const AVFrame* f = mJob.frame;
+    const Target& t = mJob.target;
+    int beginY = (int)((int64_t)t.h * band / mBandCount);
+    int endY = (int)((int64_t)t.h * (band + 1) / mBandCount);
+    bool scaleX = f->width != t.w;
+    uint32_t* rowBuffer = mRowBuffers[band].data();
+    int lastSrcY = -1;
+
+    for (int y = beginY; y < endY; ++y) {
+        int srcY = (int)((int64_t)y * f->height / t.h);
+        const uint8_t* srcRowY = f->data[0] + (ptrdiff_t)srcY * f->linesize[0];
+        const uint8_t* srcRowU = f->data[1] + (ptrdiff_t)(srcY / 2) * f->linesize[1];
+        const uint8_t* srcRowV = f->data[2] + (ptrdiff_t)(srcY / 2) * f->linesize[2];
+        uint32_t* dst = (uint32_t*)(t.data + (ptrdiff_t)y * t.stride);
+
+        if (!scaleX) {
+            YuvToBgra::ConvertRow(mJob.coeffs, srcRowY, srcRowU, srcRowV, dst, t.w);
+            continue;
+        }
+
+        // upscale repeat source rows, convert once.
+        if (srcY != lastSrcY) {
+            YuvToBgra::ConvertRow(mJob.coeffs, srcRowY, srcRowU, srcRowV, rowBuffer, f->width);
+            lastSrcY = srcY;
+        }
+        const int* mapX = mMapX.data();
+        for (int x = 0; x < t.w; ++x) {
+            dst[x] = rowBuffer[mapX[x]];
+        }
+    }
+}
+}  // namespace ss
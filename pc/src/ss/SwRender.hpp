@@ -0,0 +1,70 @@
+#pragma once
+#include <ss/Common.hpp>
+#include <ss/YuvToBgra.hpp>
+
+#include <condition_variable>
+
+namespace ss {
+/**
+ * software render for missing/broken gl driver, convert AV_PIX_FMT_YUV420P/YUVJ420P to bgra
+ * memory, nearest scale to target size, rows split to bands converted by worker threads.
+ */
+class SwRender : public xm::NonCopyable {
+public:
+    /** bgra(uint32 0xAARRGGBB) destination, e.g. XImage data. */
+    struct Target {
+        uint8_t* data;
+        int stride;
+        int w;
+        int h;
+    };
+
+    /** `threadCount` include caller thread. */
+    explicit SwRender(int threadCount);
+
+    ~SwRender();
+
+    /** paintFrame nullptr to repaint last frame(e.g. target resize). */
+    void paint(PaintFrame* paintFrame, const Target& target);
+
+private:
+    enum : int {
+        MAX_THREAD = 16,
+    };
+
+    /** one paint, read only for workers. */
+    struct Job {
+        const AVFrame* frame = nullptr;
+        Target target = {};
+        YuvToBgra::Coeffs coeffs = {};
+    };
+
+    void runWorker(int band);
+
+    void convertBand(int band);
+
+    // ----
+
+    int mBandCount = 1;
+    /** ref of last painted frame. */
+    AVFrame* mLastFrame = nullptr;
+    /** pixFmt/colorspace/color_range of mCoeffs. */
+    int mColorKey[3] = {-1, -1, -1};
+    YuvToBgra::Coeffs mCoeffs = {};
+    /** scale only, source x of target x, build for source width mMapSrcW. */
+    int mMapSrcW = 0;
+    xm::Array<int> mMapX;
+    /** scale only, converted source row of band. */
+    xm::Array<uint32_t> mRowBuffers[MAX_THREAD];
+
+    std::optional<std::thread> mWorkers[MAX_THREAD];
+    std::mutex mLock;
+    std::condition_variable mJobCondition;
+    std::condition_variable mDoneCondition;
+    /** guard by mLock. */
+    bool mQuit = false;
+    uint64_t mJobGeneration = 0;
+    int mPendingBands = 0;
+    Job mJob;
+};
+}  // namespace ss
@@ -0,0 +1,159 @@
+#pragma once
+#include <ss/Common.hpp>
+
+#include <functional>
+
+namespace ss {
+/** base of client accepted by `TcpServer`, handle data point to client. */
+struct TcpClient : xm::NonCopyable {
+    uv_tcp_t tcp = {};
+    /** no more write or callback after close requested. */
+    bool closing = false;
+    /** owner `TcpServer`. */
+    void* owner = nullptr;
+};
+
+/**
+ * listen socket and accepted clients of server on net loop(relay, metrics). `Client` derive
+ * `TcpClient`, freed in close callback of its handle, or by destructor if loop closed handles on
+ * exit. callbacks run on loop(c code), so never throw from them.
+ */
+template <typename Client>
+class TcpServer : public xm::NonCopyable {
+public:
+    struct Callbacks {
+        /** accepted and reading, optional. */
+        std::function<void(Client& c)> onConnected;
+        /** data received, client closed on read error or eof. */
+        std::function<void(Client& c, const char* data, size_t size)> onData;
+        /** handle closed, client freed after return, optional. */
+        std::function<void(Client& c)> onClosed;
+    };
+
+    /** `name` for log, must be string literal. */
+    TcpServer(
+        uv_loop_t* loop,
+        const char* name,
+        const char* ip,
+        int port,
+        int maxClient,
+        Callbacks callbacks)
+        : mLoop(loop), mName(name), mMaxClient(maxClient), mCallbacks(std::move(callbacks)) {
+        check_libuv(uv_tcp_init(mLoop, &mServer), "uv_tcp_init");
+        mServer.data = this;
+
+        sockaddr_in localAddr = {};
+        uv_ip4_addr(ip, port, &localAddr);
+        check_libuv(uv_tcp_bind(&mServer, (const sockaddr*)&localAddr, 0), "uv_tcp_bind");
+        check_libuv(
+            uv_listen(
+                (uv_stream_t*)&mServer,
+                mMaxClient,
+                [](uv_stream_t* server, int status) {
+                    ((TcpServer*)server->data)->onConnection(status);
+                }),
+            "uv_listen");
+    }
+
+    ~TcpServer() {
+        // handles closed by loop before.
+        mClients.clear();
+    }
+
+    xm::Array<std::unique_ptr<Client>>& clients() {
+        return mClients;
+    }
+
+    void closeClient(Client& c) {
+        // also closed by loop on exit, client freed by destructor then.
+        if (c.closing || uv_is_closing((uv_handle_t*)&c.tcp)) {
+            c.closing = true;
+            return;
+        }
+        c.closing = true;
+        uv_close((uv_handle_t*)&c.tcp, [](uv_handle_t* handle) {
+            Client* c = (Client*)handle->data;
+            TcpServer* self = (TcpServer*)c->owner;
+            for (auto i = self->mClients.begin(); i != self->mClients.end(); ++i) {
+                if (&**i == c) {
+                    std::unique_ptr<Client> closed = std::move(*i);
+                    self->mClients.erase(i);
+                    if (self->mCallbacks.onClosed) {
+                        self->mCallbacks.onClosed(*closed);
+                    }
+                    break;
+                }
+            }
+        });
+    }
+
+private:
+    void onConnection(int status) {
+        if (status != 0) {
+            Log::E("%s accept fail: %s", mName, uverror_tostring(status).c_str());
+            return;
+        }
+
+        std::unique_ptr<Client> c = std::make_unique<Client>();
+        c->owner = this;
+        int r = uv_tcp_init(mLoop, &c->tcp);
+        if (r != 0) {
+            Log::E("'uv_tcp_init' fail: %s", uverror_tostring(r).c_str());
+            return;
+        }
+        c->tcp.data = &*c;
+        Client& client = *c;
+        mClients.push_back(std::move(c));
+
+        r = uv_accept((uv_stream_t*)&mServer, (uv_stream_t*)&client.tcp);
+        if (r != 0 || (int)mClients.size() > mMaxClient) {
+            Log::E("%s accept fail: %s", mName, r != 0 ? uverror_tostring(r).c_str() : "too many");
+            closeClient(client);
+            return;
+        }
+
+        r = uv_read_start(
+            (uv_stream_t*)&client.tcp,
+            [](uv_handle_t* handle, size_t suggestedSize, uv_buf_t* buf) {
+                (void)suggestedSize;
+                // data consumed in read callback, one buffer for all clients.
+                TcpServer* self = (TcpServer*)((Client*)handle->data)->owner;
+                buf->base = self->mReadBuf;
+                buf->len = sizeof(self->mReadBuf);
+            },
+            [](uv_stream_t* stream, ssize_t nread, const uv_buf_t* buf) {
+                Client* c = (Client*)stream->data;
+                ((TcpServer*)c->owner)->onRead(*c, nread, buf);
+            });
+        if (r != 0) {
+            Log::E("'uv_read_start' fail: %s", uverror_tostring(r).c_str());
+            closeClient(client);
+            return;
+        }
+        if (mCallbacks.onConnected) {
+            mCallbacks.onConnected(client);
+        }
+    }
+
+    void onRead(Client& c, ssize_t nread, const uv_buf_t* buf) {
+        if (nread == 0 || c.closing) {
+            return;
+        }
+        if (nread < 0) {
+            closeClient(c);
+            return;
+        }
+        mCallbacks.onData(c, buf->base, (size_t)nread);
+    }
+
+    // ----
+
+    uv_loop_t* mLoop = nullptr;
+    const char* mName = "";
+    int mMaxClient = 1;
+    Callbacks mCallbacks;
+    uv_tcp_t mServer = {};
+    char mReadBuf[1024] = {};
+    xm::Array<std::unique_ptr<Client>> mClients;
+};
+}  // namespace ss
@@ -0,0 +1,138 @@
+#include <ss/ThreadPolicy.hpp>
+#include <ss/HugePageAlloc.hpp>
+
+#if defined(XM_OS_LINUX)
+    #include <pthread.h>
+    #include <sched.h>
+    #include <sys/resource.h>
+    #include <sys/syscall.h>
+#elif defined(XM_OS_MAC)
+    #include <pthread.h>
+#endif
+
+namespace ss {
+namespace {
+#if defined(XM_OS_LINUX)
+/** above normal threads, below kernel and audio threads(usually 50+). */
+constexpr int FIFO_PRIORITY = 2;
+constexpr int NICE_LEVEL = -10;
+
+void PinThread(ThreadRole role, uint64_t cpus) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    xm::StringStream cpusStr;
+    for (int i = 0; i < 64; ++i) {
+        if (cpus & ((uint64_t)1 << i)) {
+            CPU_SET(i, &set);
+            cpusStr.appendFormat(cpusStr.size() == 0 ? "%d" : ",%d", i);
+        }
+    }
+    int r = ::pthread_setaffinity_np(::pthread_self(), sizeof(set), &set);
+    if (r != 0) {
+        Log::W(
+            "thread %s pin to cpus %s fail: %s, not pinned",
+            ThreadRoleName(role),
+            cpusStr.data(),
+            ::strerror(r));
+        return;
+    }
+    Log::I("thread %s pinned to cpus %s", ThreadRoleName(role), cpusStr.data());
+}
+
+bool SetNice(ThreadRole role) {
+    // nice of thread by tid on linux, not whole process.
+    if (::setpriority(PRIO_PROCESS, (id_t)::syscall(SYS_gettid), NICE_LEVEL) != 0) {
+        Log::W(
+            "thread %s set nice %d fail: %s, need CAP_SYS_NICE or RLIMIT_NICE",
+            ThreadRoleName(role),
+            NICE_LEVEL,
+            ::strerror(errno));
+        return false;
+    }
+    Log::I("thread %s nice %d", ThreadRoleName(role), NICE_LEVEL);
+    return true;
+}
+
+void RaisePriority(ThreadRole role, ThreadPriority priority) {
+    if (priority == ThreadPriority::FIFO) {
+        sched_param param = {};
+        param.sched_priority = FIFO_PRIORITY;
+        int r = ::pthread_setschedparam(::pthread_self(), SCHED_FIFO, &param);
+        if (r == 0) {
+            Log::I("thread %s SCHED_FIFO priority %d", ThreadRoleName(role), FIFO_PRIORITY);
+            return;
+        }
+        Log::W(
+            "thread %s set SCHED_FIFO fail: %s, need CAP_SYS_NICE or RLIMIT_RTPRIO, fallback to "
+            "nice",
+            ThreadRoleName(role),
+            ::strerror(r));
+    }
+    if (!SetNice(role)) {
+        Log::W("thread %s keep normal priority", ThreadRoleName(role));
+    }
+}
+#endif
+
+void NameThread(ThreadRole role) {
+    if (role == ThreadRole::MAIN) {
+        return;
+    }
+    // 15 chars max.
+    char name[16];
+    snprintf(name, sizeof(name), "ss-%s", ThreadRoleName(role));
+#if defined(XM_OS_LINUX)
+    ::pthread_setname_np(::pthread_self(), name);
+#elif defined(XM_OS_MAC)
+    ::pthread_setname_np(name);
+#else
+    (void)name;
+#endif
+}
+}  // namespace
+
+const char* ThreadRoleName(ThreadRole role) {
+    switch (role) {
+        case ThreadRole::NET:
+            return "net";
+        case ThreadRole::DECODE:
+            return "decode";
+        case ThreadRole::PTS:
+            return "pts";
+        case ThreadRole::MAIN:
+            return "main";
+        case ThreadRole::RECORD:
+            return "record";
+        default:
+            return "unknown";
+    }
+}
+
+void ApplyThreadPolicy(ThreadRole role) {
+    thread_local bool applied = false;
+    if (applied) {
+        return;
+    }
+    applied = true;
+
+    NameThread(role);
+    Config* cfg = Config::Singleton();
+#if defined(XM_OS_LINUX)
+    if (uint64_t cpus = cfg->threadCpus[(int)role]) {
+        PinThread(role, cpus);
+    }
+    if (cfg->threadPriority != ThreadPriority::NORMAL &&
+        (role == ThreadRole::PTS || role == ThreadRole::MAIN)) {
+        RaisePriority(role, cfg->threadPriority);
+    }
+#endif
+    // after pinned, node of consumer stable.
+    if (role == ThreadRole::DECODE ||
+        (role == ThreadRole::MAIN && cfg->pipeline == PipelineMode::INLINE)) {
+        HugePageAlloc::SetConsumerThread(HugePageAlloc::DECODE);
+    }
+    if (role == ThreadRole::MAIN) {
+        HugePageAlloc::SetConsumerThread(HugePageAlloc::PAINT);
+    }
+}
+}  // namespace ss
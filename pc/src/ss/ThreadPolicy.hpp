@@ -0,0 +1,15 @@
+#pragma once
+#include <ss/Common.hpp>
+
+namespace ss {
+/**
+ * name calling thread for profilers(ss-net, ss-decode...; main thread keep process name), pin it
+ * to cpus of `role` and raise priority of pts/main thread by config. once per thread, first role
+ * win(e.g. inline pipeline decode on main thread). fail logged as warning, thread keep running
+ * with default scheduling.
+ */
+void ApplyThreadPolicy(ThreadRole role);
+
+/** lower case name of role, as -pin arg. */
+const char* ThreadRoleName(ThreadRole role);
+}  // namespace ss
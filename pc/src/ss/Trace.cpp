@@ -0,0 +1,80 @@
+#include <ss/Trace.hpp>
+
+#include <csignal>
+
+namespace ss {
+Trace::Trace(std::string path) : mPath(std::move(path)), mStartTp(clock::now()) {
+#if !defined(XM_OS_WINDOWS)
+    // only set flag in handler, dump by main thread.
+    ::signal(SIGUSR1, [](int) {
+        if (Trace* self = Singleton()) {
+            self->mDumpRequested.store(true, std::memory_order_relaxed);
+        }
+    });
+#endif
+    Log::I("trace enabled, dump to: %s", mPath.c_str());
+}
+
+Trace::~Trace() {
+#if !defined(XM_OS_WINDOWS)
+    ::signal(SIGUSR1, SIG_DFL);
+#endif
+}
+
+Trace::ThreadBuffer* Trace::registerThread() {
+    std::unique_ptr<ThreadBuffer> buffer = std::make_unique<ThreadBuffer>();
+    std::lock_guard<std::mutex> lock(mLock);
+    buffer->tid = (int)mBuffers.size() + 1;
+    mBuffers.push_back(std::move(buffer));
+    return &*mBuffers.back();
+}
+
+void Trace::dump() {
+    FILE* file = ::fopen(mPath.c_str(), "wb");
+    if (!file) {
+        Log::E("open trace file fail: %s", mPath.c_str());
+        return;
+    }
+
+    uint64_t events = 0;
+    uint64_t overwritten = 0;
+    ::fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+    const char* separator = "\n";
+    std::lock_guard<std::mutex> lock(mLock);
+    for (const std::unique_ptr<ThreadBuffer>& b : mBuffers) {
+        ::fprintf(
+            file,
+            "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,"
+            "\"args\":{\"name\":\"%s\"}}",
+            separator,
+            b->tid,
+            b->name ? b->name : "unnamed");
+        separator = ",\n";
+
+        uint64_t end = b->writeIndex.load(std::memory_order_acquire);
+        uint64_t begin = 0;
+        if (end > BUFFER_CAPACITY) {
+            begin = end - BUFFER_CAPACITY + DUMP_SKIP_WRAPPED;
+            overwritten += begin;
+        }
+        for (uint64_t i = begin; i < end; ++i) {
+            const Event& e = b->events[i & (BUFFER_CAPACITY - 1)];
+            ::fprintf(
+                file,
+                ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%lld,\"dur\":%lld}",
+                e.name,
+                b->tid,
+                (long long)e.beginUs,
+                (long long)e.durationUs);
+        }
+        events += end - begin;
+    }
+    ::fprintf(file, "\n]}\n");
+    ::fclose(file);
+    Log::I(
+        "trace dump: %s, events: %llu, overwritten: %llu",
+        mPath.c_str(),
+        (unsigned long long)events,
+        (unsigned long long)overwritten);
+}
+}  // namespace ss
@@ -0,0 +1,110 @@
+#pragma once
+#include <ss/Common.hpp>
+
+namespace ss {
+/**
+ * thread activity tracing, dump chrome trace json(open by chrome://tracing or perfetto ui).
+ * each thread append complete events to own ring buffer without lock, oldest events
+ * overwritten when full.
+ */
+class Trace : public xm::SingletonBase<Trace> {
+public:
+    using clock = chrono::high_resolution_clock;
+
+    /** create before pipeline threads, dump to `path` at exit and on SIGUSR1(not windows). */
+    explicit Trace(std::string path);
+
+    ~Trace();
+
+    /** name of calling thread in trace, no-op if not instanced or named. */
+    static void SetThreadName(const char* name) {
+        if (Trace* self = Singleton()) {
+            self->bufferOfThread()->name = name;
+        }
+    }
+
+    /** `name` must be string literal, it is referenced until dump. */
+    void complete(const char* name, clock::time_point beginTp, clock::time_point endTp) {
+        ThreadBuffer& b = *bufferOfThread();
+        uint64_t index = b.writeIndex.load(std::memory_order_relaxed);
+        Event& e = b.events[index & (BUFFER_CAPACITY - 1)];
+        e.name = name;
+        e.beginUs = chrono::duration_cast<chrono::microseconds>(beginTp - mStartTp).count();
+        e.durationUs = chrono::duration_cast<chrono::microseconds>(endTp - beginTp).count();
+        b.writeIndex.store(index + 1, std::memory_order_release);
+    }
+
+    /** call periodically on main thread, dump if SIGUSR1 received. */
+    void dumpIfRequested() {
+        if (mDumpRequested.exchange(false, std::memory_order_relaxed)) {
+            dump();
+        }
+    }
+
+    /** write events of all threads, while threads running latest events may be torn. */
+    void dump();
+
+private:
+    enum : uint32_t {
+        /** per thread, power of 2, about 1MB. */
+        BUFFER_CAPACITY = 1 << 15,
+        /** events may be rewriting while dump, skip oldest of wrapped buffer. */
+        DUMP_SKIP_WRAPPED = 256,
+    };
+
+    struct Event {
+        const char* name;
+        int64_t beginUs;
+        int64_t durationUs;
+    };
+
+    struct ThreadBuffer {
+        const char* name = nullptr;
+        int tid = 0;
+        /** only owner thread write, dump read. */
+        std::atomic<uint64_t> writeIndex = 0;
+        Event events[BUFFER_CAPACITY];
+    };
+
+    /** register on first use of thread, lock only once per thread. */
+    ThreadBuffer* bufferOfThread() {
+        thread_local ThreadBuffer* tBuffer = nullptr;
+        if (!tBuffer) {
+            tBuffer = registerThread();
+        }
+        return tBuffer;
+    }
+
+    ThreadBuffer* registerThread();
+
+    // ----
+
+    std::string mPath;
+    clock::time_point mStartTp;
+    std::atomic<bool> mDumpRequested = false;
+    std::mutex mLock;
+    xm::Array<std::unique_ptr<ThreadBuffer>> mBuffers;  // guard by mLock.
+};
+
+/** record scope as complete event if trace instanced, `name` must be string literal. */
+class TraceZone : xm::NonCopyable {
+public:
+    explicit TraceZone(const char* name) : mTrace(Trace::Singleton()) {
+        if (mTrace) {
+            mName = name;
+            mBeginTp = Trace::clock::now();
+        }
+    }
+
+    ~TraceZone() {
+        if (mTrace) {
+            mTrace->complete(mName, mBeginTp, Trace::clock::now());
+        }
+    }
+
+private:
+    Trace* mTrace;
+    const char* mName = nullptr;
+    Trace::clock::time_point mBeginTp;
+};
+}  // namespace ss
@@ -0,0 +1,361 @@
+#pragma once
+#include <xm/PlatformDefine.hpp>
+
+#include <cstdint>
+#include <cstddef>
+#include <cmath>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    #include <immintrin.h>
+    #define SS_YUV_X86
+    #define SS_YUV_TARGET(t) __attribute__((target(t)))
+#elif defined(_MSC_VER) && defined(_M_X64)
+    #include <immintrin.h>
+    #include <intrin.h>
+    #define SS_YUV_X86
+    #define SS_YUV_TARGET(t)
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+    #include <arm_neon.h>
+    #define SS_YUV_NEON
+#endif
+
+namespace ss {
+/**
+ * yuv420 row -> bgra(uint32 0xAARRGGBB) row, int16 fixed point: samples << 7, coefficients Q13,
+ * result Q5. avx2/sse4.1/neon/scalar give same result.
+ */
+struct YuvToBgra {
+    struct Coeffs {
+        int16_t yOffset;
+        int16_t yScale;
+        int16_t vr;
+        int16_t ug;
+        int16_t vg;
+        int16_t ub;
+    };
+
+    /** convert `w` pixels from `x`, return end x, u/v are half width(pixel x use u[x / 2]). */
+    using Kernel = int (*)(
+        const Coeffs& c,
+        const uint8_t* y,
+        const uint8_t* u,
+        const uint8_t* v,
+        uint32_t* dst,
+        int x,
+        int w);
+
+    /** kr/kb: luma coefficients of matrix, e.g. bt601: 0.299/0.114. */
+    static Coeffs MakeCoeffs(float kr, float kb, bool fullRange) {
+        float kg = 1.0f - kr - kb;
+        float yScale = fullRange ? 1.0f : 255.0f / 219.0f;
+        float cScale = fullRange ? 1.0f : 255.0f / 224.0f;
+        Coeffs c;
+        c.yOffset = fullRange ? 0 : 16;
+        c.yScale = Q13(yScale);
+        c.vr = Q13(2.0f * (1.0f - kr) * cScale);
+        c.ug = Q13(2.0f * kb * (1.0f - kb) / kg * cScale);
+        c.vg = Q13(2.0f * kr * (1.0f - kr) / kg * cScale);
+        c.ub = Q13(2.0f * (1.0f - kb) * cScale);
+        return c;
+    }
+
+    /** convert one row by best kernel of current cpu. */
+    static void ConvertRow(
+        const Coeffs& c,
+        const uint8_t* y,
+        const uint8_t* u,
+        const uint8_t* v,
+        uint32_t* dst,
+        int w) {
+        static const Kernel kernel = BestKernel();
+        int x = kernel(c, y, u, v, dst, 0, w);
+        ConvertScalar(c, y, u, v, dst, x, w);
+    }
+
+    static const char* BestKernelName() {
+#if defined(SS_YUV_X86)
+        return HasAvx2() ? "avx2" : HasSse41() ? "sse4.1" : "scalar";
+#elif defined(SS_YUV_NEON)
+        return "neon";
+#else
+        return "scalar";
+#endif
+    }
+
+    static int ConvertScalar(
+        const Coeffs& c,
+        const uint8_t* y,
+        const uint8_t* u,
+        const uint8_t* v,
+        uint32_t* dst,
+        int x,
+        int w) {
+        for (; x < w; ++x) {
+            int16_t yy = MulHrs((int16_t)((y[x] - c.yOffset) * 128), c.yScale);
+            int16_t uu = (int16_t)((u[x >> 1] - 128) * 128);
+            int16_t vv = (int16_t)((v[x >> 1] - 128) * 128);
+            int16_t b = MulHrs(uu, c.ub);
+            int16_t g = (int16_t)(MulHrs(uu, c.ug) + MulHrs(vv, c.vg));
+            int16_t r = MulHrs(vv, c.vr);
+            dst[x] = 0xff000000u | ((uint32_t)Q5ToU8(yy + r) << 16) |
+                     ((uint32_t)Q5ToU8(yy - g) << 8) | Q5ToU8(yy + b);
+        }
+        return x;
+    }
+
+#if defined(SS_YUV_X86)
+    static bool HasSse41() {
+    #if defined(_MSC_VER)
+        int info[4];
+        __cpuid(info, 1);
+        return (info[2] & (1 << 19)) != 0;
+    #else
+        return __builtin_cpu_supports("sse4.1");
+    #endif
+    }
+
+    static bool HasAvx2() {
+    #if defined(_MSC_VER)
+        int info[4];
+        __cpuid(info, 1);
+        // os save ymm registers(osxsave + xcr0).
+        if ((info[2] & (1 << 27)) == 0 || (_xgetbv(0) & 6) != 6) {
+            return false;
+        }
+        __cpuidex(info, 7, 0);
+        return (info[1] & (1 << 5)) != 0;
+    #else
+        return __builtin_cpu_supports("avx2");
+    #endif
+    }
+
+    /** (y + c + 16) >> 5 of Q5, same as `Q5ToU8` before saturate. */
+    SS_YUV_TARGET("sse4.1")
+    static __m128i AddQ5Sse41(__m128i y, __m128i c) {
+        return _mm_srai_epi16(_mm_add_epi16(_mm_add_epi16(y, c), _mm_set1_epi16(16)), 5);
+    }
+
+    SS_YUV_TARGET("sse4.1")
+    static __m128i SubQ5Sse41(__m128i y, __m128i c) {
+        return _mm_srai_epi16(_mm_add_epi16(_mm_sub_epi16(y, c), _mm_set1_epi16(16)), 5);
+    }
+
+    SS_YUV_TARGET("avx2")
+    static __m256i AddQ5Avx2(__m256i y, __m256i c) {
+        __m256i sum = _mm256_add_epi16(y, c);
+        return _mm256_srai_epi16(_mm256_add_epi16(sum, _mm256_set1_epi16(16)), 5);
+    }
+
+    SS_YUV_TARGET("avx2")
+    static __m256i SubQ5Avx2(__m256i y, __m256i c) {
+        __m256i sum = _mm256_sub_epi16(y, c);
+        return _mm256_srai_epi16(_mm256_add_epi16(sum, _mm256_set1_epi16(16)), 5);
+    }
+
+    /** 16 pixels per step. */
+    SS_YUV_TARGET("sse4.1")
+    static int ConvertSse41(
+        const Coeffs& c,
+        const uint8_t* y,
+        const uint8_t* u,
+        const uint8_t* v,
+        uint32_t* dst,
+        int x,
+        int w) {
+        const __m128i yOffset = _mm_set1_epi16(c.yOffset);
+        const __m128i yScale = _mm_set1_epi16(c.yScale);
+        const __m128i vr = _mm_set1_epi16(c.vr);
+        const __m128i ug = _mm_set1_epi16(c.ug);
+        const __m128i vg = _mm_set1_epi16(c.vg);
+        const __m128i ub = _mm_set1_epi16(c.ub);
+        const __m128i c128 = _mm_set1_epi16(128);
+        const __m128i alpha = _mm_set1_epi8((char)0xff);
+        for (; x + 16 <= w; x += 16) {
+            __m128i ys = _mm_loadu_si128((const __m128i*)(y + x));
+            __m128i y0 = _mm_cvtepu8_epi16(ys);
+            __m128i y1 = _mm_cvtepu8_epi16(_mm_srli_si128(ys, 8));
+            y0 = _mm_mulhrs_epi16(_mm_slli_epi16(_mm_sub_epi16(y0, yOffset), 7), yScale);
+            y1 = _mm_mulhrs_epi16(_mm_slli_epi16(_mm_sub_epi16(y1, yOffset), 7), yScale);
+
+            __m128i uu = _mm_cvtepu8_epi16(_mm_loadl_epi64((const __m128i*)(u + x / 2)));
+            __m128i vv = _mm_cvtepu8_epi16(_mm_loadl_epi64((const __m128i*)(v + x / 2)));
+            uu = _mm_slli_epi16(_mm_sub_epi16(uu, c128), 7);
+            vv = _mm_slli_epi16(_mm_sub_epi16(vv, c128), 7);
+            __m128i bc = _mm_mulhrs_epi16(uu, ub);
+            __m128i gc = _mm_add_epi16(_mm_mulhrs_epi16(uu, ug), _mm_mulhrs_epi16(vv, vg));
+            __m128i rc = _mm_mulhrs_epi16(vv, vr);
+
+            // one chroma sample for 2 pixels.
+            __m128i b = _mm_packus_epi16(
+                AddQ5Sse41(y0, _mm_unpacklo_epi16(bc, bc)),
+                AddQ5Sse41(y1, _mm_unpackhi_epi16(bc, bc)));
+            __m128i g = _mm_packus_epi16(
+                SubQ5Sse41(y0, _mm_unpacklo_epi16(gc, gc)),
+                SubQ5Sse41(y1, _mm_unpackhi_epi16(gc, gc)));
+            __m128i r = _mm_packus_epi16(
+                AddQ5Sse41(y0, _mm_unpacklo_epi16(rc, rc)),
+                AddQ5Sse41(y1, _mm_unpackhi_epi16(rc, rc)));
+
+            __m128i bgLo = _mm_unpacklo_epi8(b, g);
+            __m128i bgHi = _mm_unpackhi_epi8(b, g);
+            __m128i raLo = _mm_unpacklo_epi8(r, alpha);
+            __m128i raHi = _mm_unpackhi_epi8(r, alpha);
+            __m128i* out = (__m128i*)(dst + x);
+            _mm_storeu_si128(out + 0, _mm_unpacklo_epi16(bgLo, raLo));
+            _mm_storeu_si128(out + 1, _mm_unpackhi_epi16(bgLo, raLo));
+            _mm_storeu_si128(out + 2, _mm_unpacklo_epi16(bgHi, raHi));
+            _mm_storeu_si128(out + 3, _mm_unpackhi_epi16(bgHi, raHi));
+        }
+        return x;
+    }
+
+    /** 32 pixels per step. */
+    SS_YUV_TARGET("avx2")
+    static int ConvertAvx2(
+        const Coeffs& c,
+        const uint8_t* y,
+        const uint8_t* u,
+        const uint8_t* v,
+        uint32_t* dst,
+        int x,
+        int w) {
+        const __m256i yOffset = _mm256_set1_epi16(c.yOffset);
+        const __m256i yScale = _mm256_set1_epi16(c.yScale);
+        const __m256i vr = _mm256_set1_epi16(c.vr);
+        const __m256i ug = _mm256_set1_epi16(c.ug);
+        const __m256i vg = _mm256_set1_epi16(c.vg);
+        const __m256i ub = _mm256_set1_epi16(c.ub);
+        const __m256i c128 = _mm256_set1_epi16(128);
+        const __m256i alpha = _mm256_set1_epi8((char)0xff);
+        for (; x + 32 <= w; x += 32) {
+            __m256i y0 = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)(y + x)));
+            __m256i y1 = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)(y + x + 16)));
+            y0 = _mm256_mulhrs_epi16(_mm256_slli_epi16(_mm256_sub_epi16(y0, yOffset), 7), yScale);
+            y1 = _mm256_mulhrs_epi16(_mm256_slli_epi16(_mm256_sub_epi16(y1, yOffset), 7), yScale);
+
+            __m256i uu = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)(u + x / 2)));
+            __m256i vv = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)(v + x / 2)));
+            uu = _mm256_slli_epi16(_mm256_sub_epi16(uu, c128), 7);
+            vv = _mm256_slli_epi16(_mm256_sub_epi16(vv, c128), 7);
+            // unpack works in 128 bits lanes, reorder 64 bits blocks to (0, 2, 1, 3) first, then
+            // unpacklo dup chroma of pixels 0~15, unpackhi of 16~31.
+            __m256i bc = _mm256_permute4x64_epi64(_mm256_mulhrs_epi16(uu, ub), 0xD8);
+            __m256i gc = _mm256_permute4x64_epi64(
+                _mm256_add_epi16(_mm256_mulhrs_epi16(uu, ug), _mm256_mulhrs_epi16(vv, vg)), 0xD8);
+            __m256i rc = _mm256_permute4x64_epi64(_mm256_mulhrs_epi16(vv, vr), 0xD8);
+
+            // pack also works in lanes, reorder to pixels 0~31.
+            __m256i b = _mm256_permute4x64_epi64(
+                _mm256_packus_epi16(
+                    AddQ5Avx2(y0, _mm256_unpacklo_epi16(bc, bc)),
+                    AddQ5Avx2(y1, _mm256_unpackhi_epi16(bc, bc))),
+                0xD8);
+            __m256i g = _mm256_permute4x64_epi64(
+                _mm256_packus_epi16(
+                    SubQ5Avx2(y0, _mm256_unpacklo_epi16(gc, gc)),
+                    SubQ5Avx2(y1, _mm256_unpackhi_epi16(gc, gc))),
+                0xD8);
+            __m256i r = _mm256_permute4x64_epi64(
+                _mm256_packus_epi16(
+                    AddQ5Avx2(y0, _mm256_unpacklo_epi16(rc, rc)),
+                    AddQ5Avx2(y1, _mm256_unpackhi_epi16(rc, rc))),
+                0xD8);
+
+            // lane0: pixels 0~7/8~15, lane1: 16~23/24~31.
+            __m256i bgLo = _mm256_unpacklo_epi8(b, g);
+            __m256i bgHi = _mm256_unpackhi_epi8(b, g);
+            __m256i raLo = _mm256_unpacklo_epi8(r, alpha);
+            __m256i raHi = _mm256_unpackhi_epi8(r, alpha);
+            __m256i p0 = _mm256_unpacklo_epi16(bgLo, raLo);
+            __m256i p1 = _mm256_unpackhi_epi16(bgLo, raLo);
+            __m256i p2 = _mm256_unpacklo_epi16(bgHi, raHi);
+            __m256i p3 = _mm256_unpackhi_epi16(bgHi, raHi);
+            __m256i* out = (__m256i*)(dst + x);
+            _mm256_storeu_si256(out + 0, _mm256_permute2x128_si256(p0, p1, 0x20));
+            _mm256_storeu_si256(out + 1, _mm256_permute2x128_si256(p2, p3, 0x20));
+            _mm256_storeu_si256(out + 2, _mm256_permute2x128_si256(p0, p1, 0x31));
+            _mm256_storeu_si256(out + 3, _mm256_permute2x128_si256(p2, p3, 0x31));
+        }
+        return ConvertSse41(c, y, u, v, dst, x, w);
+    }
+#endif
+
+#if defined(SS_YUV_NEON)
+    /** 16 pixels per step. */
+    static int ConvertNeon(
+        const Coeffs& c,
+        const uint8_t* y,
+        const uint8_t* u,
+        const uint8_t* v,
+        uint32_t* dst,
+        int x,
+        int w) {
+        const int16x8_t yOffset = vdupq_n_s16(c.yOffset);
+        const int16x8_t c128 = vdupq_n_s16(128);
+        const int16x8_t round = vdupq_n_s16(16);
+        for (; x + 16 <= w; x += 16) {
+            uint8x16_t ys = vld1q_u8(y + x);
+            int16x8_t y0 = vreinterpretq_s16_u16(vmovl_u8(vget_low_u8(ys)));
+            int16x8_t y1 = vreinterpretq_s16_u16(vmovl_u8(vget_high_u8(ys)));
+            // vqrdmulh: (2 * a * b + (1 << 15)) >> 16, same as mulhrs.
+            y0 = vqrdmulhq_n_s16(vshlq_n_s16(vsubq_s16(y0, yOffset), 7), c.yScale);
+            y1 = vqrdmulhq_n_s16(vshlq_n_s16(vsubq_s16(y1, yOffset), 7), c.yScale);
+
+            int16x8_t uu = vreinterpretq_s16_u16(vmovl_u8(vld1_u8(u + x / 2)));
+            int16x8_t vv = vreinterpretq_s16_u16(vmovl_u8(vld1_u8(v + x / 2)));
+            uu = vshlq_n_s16(vsubq_s16(uu, c128), 7);
+            vv = vshlq_n_s16(vsubq_s16(vv, c128), 7);
+            int16x8x2_t bc = vzipq_s16(vqrdmulhq_n_s16(uu, c.ub), vqrdmulhq_n_s16(uu, c.ub));
+            int16x8_t gc0 = vaddq_s16(vqrdmulhq_n_s16(uu, c.ug), vqrdmulhq_n_s16(vv, c.vg));
+            int16x8x2_t gc = vzipq_s16(gc0, gc0);
+            int16x8x2_t rc = vzipq_s16(vqrdmulhq_n_s16(vv, c.vr), vqrdmulhq_n_s16(vv, c.vr));
+
+            uint8x16x4_t px;
+            px.val[0] = vcombine_u8(
+                vqmovun_s16(vshrq_n_s16(vaddq_s16(vaddq_s16(y0, bc.val[0]), round), 5)),
+                vqmovun_s16(vshrq_n_s16(vaddq_s16(vaddq_s16(y1, bc.val[1]), round), 5)));
+            px.val[1] = vcombine_u8(
+                vqmovun_s16(vshrq_n_s16(vaddq_s16(vsubq_s16(y0, gc.val[0]), round), 5)),
+                vqmovun_s16(vshrq_n_s16(vaddq_s16(vsubq_s16(y1, gc.val[1]), round), 5)));
+            px.val[2] = vcombine_u8(
+                vqmovun_s16(vshrq_n_s16(vaddq_s16(vaddq_s16(y0, rc.val[0]), round), 5)),
+                vqmovun_s16(vshrq_n_s16(vaddq_s16(vaddq_s16(y1, rc.val[1]), round), 5)));
+            px.val[3] = vdupq_n_u8(0xff);
+            vst4q_u8((uint8_t*)(dst + x), px);
+        }
+        return x;
+    }
+#endif
+
+private:
+    static int16_t Q13(float v) {
+        return (int16_t)std::lround(v * 8192.0f);
+    }
+
+    /** (a * b + (1 << 14)) >> 15, same as _mm_mulhrs_epi16. */
+    static int16_t MulHrs(int16_t a, int16_t b) {
+        return (int16_t)(((int32_t)a * b + 0x4000) >> 15);
+    }
+
+    static uint8_t Q5ToU8(int v) {
+        int r = (int16_t)(v + 16) >> 5;
+        return (uint8_t)(r < 0 ? 0 : r > 255 ? 255 : r);
+    }
+
+    static Kernel BestKernel() {
+#if defined(SS_YUV_X86)
+        if (HasAvx2()) {
+            return &ConvertAvx2;
+        }
+        if (HasSse41()) {
+            return &ConvertSse41;
+        }
+        return &ConvertScalar;
+#elif defined(SS_YUV_NEON)
+        return &ConvertNeon;
+#else
+        return &ConvertScalar;
+#endif
+    }
+};
+}  // namespace ss
@@ -3,6 +3,29 @@
 #define GLAD_GLX_IMPLEMENTATION
 #include <glad/glx.h>
 
+#include <ss/GlExt.hpp>
+
+// load egl by dlopen, so no link dependency for non headless.
+#define EGL_EGL_PROTOTYPES 0
+// glad already include khrplatform but not define KHRONOS_APIENTRY.
+#ifndef EGLAPIENTRY
+    #define EGLAPIENTRY
+#endif
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <dlfcn.h>
+#include <X11/Xatom.h>
+#include <sys/ipc.h>
+#include <sys/shm.h>
+
+// 'GLX_ARB_create_context_profile', not generate in glad.
+#ifndef GLX_CONTEXT_PROFILE_MASK_ARB
+    #define GLX_CONTEXT_PROFILE_MASK_ARB 0x9126
+#endif
+#ifndef GLX_CONTEXT_CORE_PROFILE_BIT_ARB
+    #define GLX_CONTEXT_CORE_PROFILE_BIT_ARB 0x00000001
+#endif
+
 #define _NET_WM_STATE_REMOVE 0
 #define _NET_WM_STATE_ADD 1
 #define _NET_WM_STATE_TOGGLE 2
@@ -10,18 +33,149 @@
 namespace ss::detail {
 static GLADapiproc (*s_glXGetProcAddressARB)(const char* name) = nullptr;
 
+/**
+ * 'glXCreateContextAttribsARB'/'XShmAttach' report fail by x error, default handler will exit
+ * process.
+ */
+static int s_xErrorCode = 0;
+
+static int on_x_error(Display*, XErrorEvent* e) {
+    s_xErrorCode = e->error_code;
+    return 0;
+}
+
+/** headless egl entry points. */
+static struct {
+    PFNEGLGETPROCADDRESSPROC GetProcAddress;
+    PFNEGLGETERRORPROC GetError;
+    PFNEGLGETDISPLAYPROC GetDisplay;
+    PFNEGLINITIALIZEPROC Initialize;
+    PFNEGLTERMINATEPROC Terminate;
+    PFNEGLQUERYSTRINGPROC QueryString;
+    PFNEGLBINDAPIPROC BindAPI;
+    PFNEGLCHOOSECONFIGPROC ChooseConfig;
+    PFNEGLCREATEPBUFFERSURFACEPROC CreatePbufferSurface;
+    PFNEGLDESTROYSURFACEPROC DestroySurface;
+    PFNEGLCREATECONTEXTPROC CreateContext;
+    PFNEGLDESTROYCONTEXTPROC DestroyContext;
+    PFNEGLMAKECURRENTPROC MakeCurrent;
+} s_egl = {};
+
+MainThreadImpl::RaiiEgl::~RaiiEgl() {
+    if (ctx) {
+        s_egl.MakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        s_egl.DestroyContext(display, ctx);
+    }
+    if (surface) {
+        s_egl.DestroySurface(display, surface);
+    }
+    if (display) {
+        s_egl.Terminate(display);
+    }
+    if (lib) {
+        ::dlclose(lib);
+    }
+}
+
+MainThreadImpl::RaiiSwImage::RaiiSwImage(
+    Display* display,
+    XVisualInfo* visualInfo,
+    int w,
+    int h,
+    bool tryShm)
+    : display(display) {
+    if (tryShm) {
+        image = XShmCreateImage(
+            display, visualInfo->visual, visualInfo->depth, ZPixmap, nullptr, &shm, w, h);
+    }
+    if (image) {
+        shm.shmid = ::shmget(IPC_PRIVATE, (size_t)image->bytes_per_line * h, IPC_CREAT | 0600);
+        if (shm.shmid != -1) {
+            shm.shmaddr = (char*)::shmat(shm.shmid, nullptr, 0);
+            if (shm.shmaddr != (char*)-1) {
+                image->data = shm.shmaddr;
+                shm.readOnly = False;
+
+                // fail if x server is remote.
+                s_xErrorCode = 0;
+                XSync(display, False);
+                int (*oldHandler)(Display*, XErrorEvent*) = XSetErrorHandler(on_x_error);
+                Bool attached = XShmAttach(display, &shm);
+                XSync(display, False);
+                XSetErrorHandler(oldHandler);
+                shared = attached && !s_xErrorCode;
+            } else {
+                shm.shmaddr = nullptr;
+            }
+            // removed after all detach.
+            ::shmctl(shm.shmid, IPC_RMID, nullptr);
+        }
+        if (!shared) {
+            Log::W("'XShmAttach' fail, x error: %d, use 'XPutImage'", s_xErrorCode);
+            if (shm.shmaddr) {
+                ::shmdt(shm.shmaddr);
+                shm.shmaddr = nullptr;
+            }
+            image->data = nullptr;
+            XDestroyImage(image);
+            image = nullptr;
+        }
+    }
+    if (!image) {
+        char* data = (char*)::malloc((size_t)w * h * 4);
+        SS_THROW(data, "malloc sw image fail");
+        image = XCreateImage(
+            display, visualInfo->visual, visualInfo->depth, ZPixmap, 0, data, w, h, 32, w * 4);
+        if (!image) {
+            ::free(data);
+        }
+        SS_THROW(image, "'XCreateImage' fail");
+        // pixels always write as little endian uint32, xlib swap for server if need.
+        image->byte_order = LSBFirst;
+    }
+}
+
+MainThreadImpl::RaiiSwImage::~RaiiSwImage() {
+    if (shared) {
+        XShmDetach(display, &shm);
+        XSync(display, False);
+        // not owned by image.
+        image->data = nullptr;
+    }
+    XDestroyImage(image);
+    if (shm.shmaddr) {
+        ::shmdt(shm.shmaddr);
+    }
+}
+
 MainThreadImpl::MainThreadImpl() {
     int _eventFd = ::eventfd(0, EFD_NONBLOCK);
     check_errno(_eventFd != -1, "eventfd");
     mEventFd.emplace(_eventFd);
 
+    if (Config::Singleton()->render != RenderBackend::WINDOW) {
+        mHeadless = true;
+        mSoftware = Config::Singleton()->render == RenderBackend::HEADLESS_SW;
+        return;
+    }
+
     Display* _display = XOpenDisplay(nullptr);
     SS_THROW(_display, "'XOpenDisplay' fail");
     mDisplay.reset(_display);
 
     mDefaultScreen = DefaultScreen(mDisplay.get());
-    mGlxLoader.emplace(mDisplay.get(), mDefaultScreen);
     mRootWindow = RootWindow(mDisplay.get(), mDefaultScreen);
+    if (Config::Singleton()->swRender) {
+        mSoftware = true;
+        return;
+    }
+    try {
+        mGlxLoader.emplace(mDisplay.get(), mDefaultScreen);
+    } catch (const Error& e) {
+        Log::PrintError(e);
+        Log::W_STR("glx not available, fallback to software render");
+        mSoftware = true;
+    }
 }
 
 std::string MainThreadImpl::queryUserLanguageName() {
@@ -37,6 +191,38 @@ std::string MainThreadImpl::queryUserLanguageName() {
 }
 
 void MainThreadImpl::initWindowAndGl() {
+    if (mHeadless) {
+        Config* cfg = Config::Singleton();
+        if (cfg->render == RenderBackend::HEADLESS_EGL) {
+            initHeadlessEgl();
+        }
+        // fixed size render target, report as window size.
+        mPendingEvents.push_back(Event {
+            EVENT_TYPE_WIN_RESIZE,
+            (void*)(size_t)cfg->headlessWidth,
+            (void*)(size_t)cfg->headlessHeight});
+        return;
+    }
+
+    if (!mSoftware) {
+        try {
+            initGlx();
+            return;
+        } catch (const Error& e) {
+            // e.g. "miss 'glGetString'" on machine without graphics driver.
+            Log::PrintError(e);
+            Log::W_STR("opengl not available, fallback to software render");
+        }
+        mCtx = nullptr;
+        mWin.reset();
+        mColormap.reset();
+        mVisualInfo = nullptr;
+        mSoftware = true;
+    }
+    initSoftware();
+}
+
+void MainThreadImpl::initGlx() {
     // clang-format off
     static int visualAttribs[] = {
         GLX_RGBA,
@@ -52,43 +238,7 @@ void MainThreadImpl::initWindowAndGl() {
     SS_THROW(_visualInfo, "'glXChooseVisual' fail");
     mVisualInfo.reset(_visualInfo);
 
-    Colormap _colormap =
-        XCreateColormap(mDisplay.get(), mRootWindow, mVisualInfo->visual, AllocNone);
-    mColormap.emplace(mDisplay.get(), _colormap);
-
-    XSetWindowAttributes swa = {};
-    swa.colormap = mColormap->id();
-    swa.background_pixmap = None;
-    swa.border_pixel = 0;
-    swa.event_mask = StructureNotifyMask;
-    Window _win = XCreateWindow(
-        mDisplay.get(),
-        mRootWindow,
-        0,
-        0,
-        400,
-        400,
-        0,
-        mVisualInfo->depth,
-        InputOutput,
-        mVisualInfo->visual,
-        CWColormap | CWEventMask,
-        &swa);
-    mWin.emplace(mDisplay.get(), _win);
-
-    XMapWindow(mDisplay.get(), mWin->id());
-
-    m_WM_DELETE_WINDOW = XInternAtom(mDisplay.get(), "WM_DELETE_WINDOW", False);
-    m_NET_WM_STATE = XInternAtom(mDisplay.get(), "_NET_WM_STATE", False);
-    m_NET_WM_STATE_MAXIMIZED_HORZ =
-        XInternAtom(mDisplay.get(), "_NET_WM_STATE_MAXIMIZED_HORZ", False);
-    m_NET_WM_STATE_MAXIMIZED_VERT =
-        XInternAtom(mDisplay.get(), "_NET_WM_STATE_MAXIMIZED_VERT", False);
-    m_NET_WM_NAME = XInternAtom(mDisplay.get(), "_NET_WM_NAME", False);
-    m_NET_WM_ICON_NAME = XInternAtom(mDisplay.get(), "_NET_WM_ICON_NAME", False);
-    m_UTF8_STRING = XInternAtom(mDisplay.get(), "UTF8_STRING", False);
-
-    XSetWMProtocols(mDisplay.get(), mWin->id(), &m_WM_DELETE_WINDOW, 1);
+    createWindow();
 
     GLXContext _tmpCtx = glXCreateContext(mDisplay.get(), mVisualInfo.get(), 0, 1);
     SS_THROW(_tmpCtx, "'glXCreateContext' fail");
@@ -108,7 +258,13 @@ void MainThreadImpl::initWindowAndGl() {
     int tmpGlMajor = 0;
     int tmpGlMinor = 0;
     (void)sscanf(tmpGlVersion, "%d.%d", &tmpGlMajor, &tmpGlMinor);
-    if (tmpGlMajor > 2 || (tmpGlMajor == 2 && tmpGlMinor >= 1)) {
+    // prefer 3.3 core context, then GlRender use vao/vbo and immutable texture.
+    if (!Config::Singleton()->glLegacy && GLAD_GLX_ARB_create_context) {
+        mCtx = tryCreateCoreContext();
+    }
+    if (mCtx) {
+        Log::I("use opengl 3.3 core context");
+    } else if (tmpGlMajor > 2 || (tmpGlMajor == 2 && tmpGlMinor >= 1)) {
         mCtx = std::move(tmpCtx);
     } else {
         SS_THROW(GLAD_GLX_ARB_create_context, "miss 'GLX_ARB_create_context'");
@@ -149,6 +305,7 @@ void MainThreadImpl::initWindowAndGl() {
     tmpCtx = nullptr;
     SS_THROW(glXMakeCurrent(mDisplay.get(), mWin->id(), mCtx->ctx()), "'glXMakeCurrent' fail");
     Log::I("opengl version: %s", (const char*)glGetString(GL_VERSION));
+    GlExt::Load(s_glXGetProcAddressARB);
 
     // try to disable vsync.
     if (GLAD_GLX_EXT_swap_control) {
@@ -159,6 +316,78 @@ void MainThreadImpl::initWindowAndGl() {
         Log::I("miss 'GLX_EXT_swap_control'");
     }
 
+    showWindow();
+}
+
+void MainThreadImpl::initSoftware() {
+    XVisualInfo visualTemplate = {};
+    visualTemplate.visualid = XVisualIDFromVisual(DefaultVisual(mDisplay.get(), mDefaultScreen));
+    int nVisual = 0;
+    XVisualInfo* _visualInfo =
+        XGetVisualInfo(mDisplay.get(), VisualIDMask, &visualTemplate, &nVisual);
+    SS_THROW(_visualInfo && nVisual > 0, "'XGetVisualInfo' fail");
+    mVisualInfo.reset(_visualInfo);
+    // SwRender output 0xAARRGGBB pixels.
+    SS_THROW(
+        mVisualInfo->c_class == TrueColor && mVisualInfo->depth >= 24 &&
+            mVisualInfo->red_mask == 0xff0000 && mVisualInfo->green_mask == 0xff00 &&
+            mVisualInfo->blue_mask == 0xff,
+        "software render not support default visual, depth: %d",
+        mVisualInfo->depth);
+
+    // shm image data is raw server layout, need same byte order.
+    mShmAvailable = XShmQueryExtension(mDisplay.get()) &&
+                    ImageByteOrder(mDisplay.get()) == LSBFirst;
+    Log::I("software render, MIT-SHM: %s", mShmAvailable ? "true" : "false");
+
+    createWindow();
+    showWindow();
+}
+
+void MainThreadImpl::createWindow() {
+    Colormap _colormap =
+        XCreateColormap(mDisplay.get(), mRootWindow, mVisualInfo->visual, AllocNone);
+    mColormap.emplace(mDisplay.get(), _colormap);
+
+    XSetWindowAttributes swa = {};
+    swa.colormap = mColormap->id();
+    swa.background_pixmap = None;
+    swa.border_pixel = 0;
+    swa.event_mask =
+        StructureNotifyMask | VisibilityChangeMask | PropertyChangeMask | ButtonPressMask |
+        KeyPressMask;
+    Window _win = XCreateWindow(
+        mDisplay.get(),
+        mRootWindow,
+        0,
+        0,
+        400,
+        400,
+        0,
+        mVisualInfo->depth,
+        InputOutput,
+        mVisualInfo->visual,
+        CWColormap | CWEventMask,
+        &swa);
+    mWin.emplace(mDisplay.get(), _win);
+
+    XMapWindow(mDisplay.get(), mWin->id());
+
+    m_WM_DELETE_WINDOW = XInternAtom(mDisplay.get(), "WM_DELETE_WINDOW", False);
+    m_NET_WM_STATE = XInternAtom(mDisplay.get(), "_NET_WM_STATE", False);
+    m_NET_WM_STATE_MAXIMIZED_HORZ =
+        XInternAtom(mDisplay.get(), "_NET_WM_STATE_MAXIMIZED_HORZ", False);
+    m_NET_WM_STATE_MAXIMIZED_VERT =
+        XInternAtom(mDisplay.get(), "_NET_WM_STATE_MAXIMIZED_VERT", False);
+    m_NET_WM_STATE_HIDDEN = XInternAtom(mDisplay.get(), "_NET_WM_STATE_HIDDEN", False);
+    m_NET_WM_NAME = XInternAtom(mDisplay.get(), "_NET_WM_NAME", False);
+    m_NET_WM_ICON_NAME = XInternAtom(mDisplay.get(), "_NET_WM_ICON_NAME", False);
+    m_UTF8_STRING = XInternAtom(mDisplay.get(), "UTF8_STRING", False);
+
+    XSetWMProtocols(mDisplay.get(), mWin->id(), &m_WM_DELETE_WINDOW, 1);
+}
+
+void MainThreadImpl::showWindow() {
     XEvent maxShowEvent;
     memset(&maxShowEvent, 0, sizeof(maxShowEvent));
     maxShowEvent.type = ClientMessage;
@@ -173,7 +402,188 @@ void MainThreadImpl::initWindowAndGl() {
     XFlush(mDisplay.get());
 }
 
+std::unique_ptr<MainThreadImpl::RaiiContext> MainThreadImpl::tryCreateCoreContext() {
+    // window already created with visual, so fb config must match it.
+    int nFbCfg = 0;
+    GLXFBConfig* fbCfgs = glXGetFBConfigs(mDisplay.get(), mDefaultScreen, &nFbCfg);
+    GLXFBConfig fbCfg = nullptr;
+    for (int i = 0; i < nFbCfg; ++i) {
+        int visualId = 0;
+        glXGetFBConfigAttrib(mDisplay.get(), fbCfgs[i], GLX_VISUAL_ID, &visualId);
+        if ((VisualID)visualId == mVisualInfo->visualid) {
+            fbCfg = fbCfgs[i];
+            break;
+        }
+    }
+    if (fbCfgs) {
+        XFree(fbCfgs);
+    }
+    if (!fbCfg) {
+        Log::W("no 'GLXFBConfig' match window visual, skip opengl core context");
+        return nullptr;
+    }
+
+    // clang-format off
+    int ctxAttribs[] = {
+        GLX_CONTEXT_MAJOR_VERSION_ARB, 3,
+        GLX_CONTEXT_MINOR_VERSION_ARB, 3,
+        GLX_CONTEXT_PROFILE_MASK_ARB, GLX_CONTEXT_CORE_PROFILE_BIT_ARB,
+        None,
+    };
+    // clang-format on
+    s_xErrorCode = 0;
+    XSync(mDisplay.get(), False);
+    int (*oldHandler)(Display*, XErrorEvent*) = XSetErrorHandler(on_x_error);
+    GLXContext _ctx = glXCreateContextAttribsARB(mDisplay.get(), fbCfg, 0, True, ctxAttribs);
+    XSync(mDisplay.get(), False);
+    XSetErrorHandler(oldHandler);
+
+    if (!_ctx || s_xErrorCode) {
+        Log::W("create opengl 3.3 core context fail, x error: %d", s_xErrorCode);
+        if (_ctx) {
+            glXDestroyContext(mDisplay.get(), _ctx);
+        }
+        return nullptr;
+    }
+    return std::make_unique<RaiiContext>(mDisplay.get(), _ctx);
+}
+
+void MainThreadImpl::initHeadlessEgl() {
+    Config* cfg = Config::Singleton();
+    mEgl.emplace();
+
+    void* lib = ::dlopen("libEGL.so.1", RTLD_NOW | RTLD_LOCAL);
+    if (!lib) {
+        lib = ::dlopen("libEGL.so", RTLD_NOW | RTLD_LOCAL);
+    }
+    SS_THROW(lib, "load libEGL fail: %s", ::dlerror());
+    mEgl->lib = lib;
+
+    auto load = [lib](auto& fn, const char* name) {
+        fn = (std::decay_t<decltype(fn)>)::dlsym(lib, name);
+        SS_THROW(fn, "miss '%s'", name);
+    };
+    load(s_egl.GetProcAddress, "eglGetProcAddress");
+    load(s_egl.GetError, "eglGetError");
+    load(s_egl.GetDisplay, "eglGetDisplay");
+    load(s_egl.Initialize, "eglInitialize");
+    load(s_egl.Terminate, "eglTerminate");
+    load(s_egl.QueryString, "eglQueryString");
+    load(s_egl.BindAPI, "eglBindAPI");
+    load(s_egl.ChooseConfig, "eglChooseConfig");
+    load(s_egl.CreatePbufferSurface, "eglCreatePbufferSurface");
+    load(s_egl.DestroySurface, "eglDestroySurface");
+    load(s_egl.CreateContext, "eglCreateContext");
+    load(s_egl.DestroyContext, "eglDestroyContext");
+    load(s_egl.MakeCurrent, "eglMakeCurrent");
+
+    // prefer mesa surfaceless platform, work without x/wayland/gpu(llvmpipe).
+    EGLDisplay display = EGL_NO_DISPLAY;
+    const char* clientExts = s_egl.QueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+    if (clientExts && ::strstr(clientExts, "EGL_MESA_platform_surfaceless")) {
+        auto getPlatformDisplay =
+            (PFNEGLGETPLATFORMDISPLAYEXTPROC)s_egl.GetProcAddress("eglGetPlatformDisplayEXT");
+        if (getPlatformDisplay) {
+            display =
+                getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+        }
+    }
+    if (display == EGL_NO_DISPLAY) {
+        Log::I_STR("egl surfaceless platform not found, use default display");
+        display = s_egl.GetDisplay(EGL_DEFAULT_DISPLAY);
+    }
+    SS_THROW(display != EGL_NO_DISPLAY, "'eglGetDisplay' fail");
+
+    EGLint major = 0;
+    EGLint minor = 0;
+    SS_THROW(
+        s_egl.Initialize(display, &major, &minor),
+        "'eglInitialize' fail: 0x%x",
+        s_egl.GetError());
+    mEgl->display = display;
+    Log::I(
+        "egl version: %d.%d, vendor: %s",
+        major,
+        minor,
+        s_egl.QueryString(display, EGL_VENDOR));
+
+    SS_THROW(s_egl.BindAPI(EGL_OPENGL_API), "'eglBindAPI' fail: 0x%x", s_egl.GetError());
+
+    // clang-format off
+    static const EGLint configAttribs[] = {
+        EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_RED_SIZE, 8,
+        EGL_GREEN_SIZE, 8,
+        EGL_BLUE_SIZE, 8,
+        EGL_ALPHA_SIZE, 8,
+        EGL_NONE,
+    };
+    // clang-format on
+    EGLConfig config = nullptr;
+    EGLint nConfig = 0;
+    SS_THROW(
+        s_egl.ChooseConfig(display, configAttribs, &config, 1, &nConfig) && nConfig > 0,
+        "'eglChooseConfig' fail, no pbuffer config found");
+
+    // clang-format off
+    const EGLint surfaceAttribs[] = {
+        EGL_WIDTH, cfg->headlessWidth,
+        EGL_HEIGHT, cfg->headlessHeight,
+        EGL_NONE,
+    };
+    // clang-format on
+    EGLSurface surface = s_egl.CreatePbufferSurface(display, config, surfaceAttribs);
+    SS_THROW(
+        surface != EGL_NO_SURFACE,
+        "'eglCreatePbufferSurface' fail: 0x%x",
+        s_egl.GetError());
+    mEgl->surface = surface;
+
+    EGLContext ctx = EGL_NO_CONTEXT;
+    if (!cfg->glLegacy) {
+        // clang-format off
+        static const EGLint coreAttribs[] = {
+            EGL_CONTEXT_MAJOR_VERSION, 3,
+            EGL_CONTEXT_MINOR_VERSION, 3,
+            EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+            EGL_NONE,
+        };
+        // clang-format on
+        ctx = s_egl.CreateContext(display, config, EGL_NO_CONTEXT, coreAttribs);
+        if (ctx == EGL_NO_CONTEXT) {
+            Log::W("create opengl 3.3 core context fail: 0x%x", s_egl.GetError());
+        } else {
+            Log::I_STR("use opengl 3.3 core context");
+        }
+    }
+    if (ctx == EGL_NO_CONTEXT) {
+        ctx = s_egl.CreateContext(display, config, EGL_NO_CONTEXT, nullptr);
+    }
+    SS_THROW(ctx != EGL_NO_CONTEXT, "'eglCreateContext' fail: 0x%x", s_egl.GetError());
+    mEgl->ctx = ctx;
+
+    SS_THROW(
+        s_egl.MakeCurrent(display, surface, surface, ctx),
+        "'eglMakeCurrent' fail: 0x%x",
+        s_egl.GetError());
+
+    GLADloadfunc glLoad = [](const char* name) -> GLADapiproc {
+        return (GLADapiproc)s_egl.GetProcAddress(name);
+    };
+    gladLoadGL(glLoad);
+    SS_THROW(glGetString != nullptr, "miss 'glGetString', you may not install graphics driver");
+    Log::I(
+        "opengl version: %s, renderer: %s",
+        (const char*)glGetString(GL_VERSION),
+        (const char*)glGetString(GL_RENDERER));
+    GlExt::Load(glLoad);
+}
+
 void MainThreadImpl::setWindowTitle(const char* utf8Str) {
+    if (mHeadless) {
+        return;
+    }
     int len = (int)strlen(utf8Str);
     XChangeProperty(
         mDisplay.get(),
@@ -197,9 +607,64 @@ void MainThreadImpl::setWindowTitle(const char* utf8Str) {
 }
 
 void MainThreadImpl::swapBuffers() {
+    if (mSoftware) {
+        if (!mHeadless && mSwImage) {
+            XImage* image = mSwImage->image;
+            if (mSwImage->shared) {
+                XShmPutImage(
+                    mDisplay.get(),
+                    mWin->id(),
+                    DefaultGC(mDisplay.get(), mDefaultScreen),
+                    image,
+                    0,
+                    0,
+                    0,
+                    0,
+                    image->width,
+                    image->height,
+                    False);
+            } else {
+                XPutImage(
+                    mDisplay.get(),
+                    mWin->id(),
+                    DefaultGC(mDisplay.get(), mDefaultScreen),
+                    image,
+                    0,
+                    0,
+                    0,
+                    0,
+                    image->width,
+                    image->height);
+            }
+            // next frame write to image after server read done.
+            XSync(mDisplay.get(), False);
+        }
+        return;
+    }
+    if (mHeadless) {
+        // pbuffer not present, wait gpu done so paint cost is measurable.
+        if (mEgl) {
+            glFinish();
+        }
+        return;
+    }
     glXSwapBuffers(mDisplay.get(), mWin->id());
 }
 
+uint8_t* MainThreadImpl::obtainSwImage(int w, int h, int* stride) {
+    *stride = w * 4;
+    if (mHeadless) {
+        mSwBuffer.resize((size_t)w * h * 4);
+        return mSwBuffer.data();
+    }
+    if (!mSwImage || mSwImage->image->width != w || mSwImage->image->height != h) {
+        mSwImage.reset();
+        mSwImage.emplace(mDisplay.get(), mVisualInfo.get(), w, h, mShmAvailable);
+    }
+    *stride = mSwImage->image->bytes_per_line;
+    return (uint8_t*)mSwImage->image->data;
+}
+
 void MainThreadImpl::postEvent(const Event& e) {
     {
         std::lock_guard<std::mutex> lock(mCacheEventLock);
@@ -210,19 +675,23 @@ void MainThreadImpl::postEvent(const Event& e) {
 }
 
 void MainThreadImpl::pollEvent(chrono::milliseconds timeout) {
-    int displayFd = ConnectionNumber(mDisplay.get());
+    // headless has no display, poll event fd only.
+    int displayFd = mDisplay ? ConnectionNumber(mDisplay.get()) : -1;
     pollfd fds[] = {
         pollfd {displayFd, POLLIN, 0},
         pollfd {mEventFd->fd(), POLLIN, 0},
+        pollfd {mExtraPollFd, POLLIN, 0},
     };
-    int r = ::poll(fds, 2, timeout.count());
+    // events may already read to xlib queue by 'XSync', fd not readable for them.
+    bool queued = mDisplay && XQLength(mDisplay.get()) > 0;
+    int r = ::poll(fds, mExtraPollFd >= 0 ? 3 : 2, queued ? 0 : timeout.count());
     check_errno(r >= 0, "poll");
 
-    if (!r) {
+    if (!r && !queued) {
         return;
     }
 
-    if (fds[0].revents & POLLIN) {
+    if (mDisplay && (queued || (fds[0].revents & POLLIN))) {
         while (XPending(mDisplay.get())) {
             XEvent event;
             XNextEvent(mDisplay.get(), &event);
@@ -235,6 +704,29 @@ void MainThreadImpl::pollEvent(chrono::milliseconds timeout) {
                 event.type == ClientMessage &&  //
                 event.xclient.data.l[0] == m_WM_DELETE_WINDOW) {
                 mPendingEvents.push_back(Event {EVENT_TYPE_WIN_CLOSE, nullptr, nullptr});
+            } else if (event.type == MapNotify || event.type == UnmapNotify) {
+                mWinMapped = event.type == MapNotify;
+                updateVisibility();
+            } else if (event.type == VisibilityNotify) {
+                mWinObscured = event.xvisibility.state == VisibilityFullyObscured;
+                updateVisibility();
+            } else if (
+                event.type == PropertyNotify &&  //
+                event.xproperty.atom == m_NET_WM_STATE) {
+                mWinNetHidden = queryNetWmHidden();
+                updateVisibility();
+            } else if (event.type == ButtonPress && event.xbutton.button == Button1) {
+                mPendingEvents.push_back(Event {
+                    EVENT_TYPE_WIN_CLICK,
+                    (void*)(size_t)event.xbutton.x,
+                    (void*)(size_t)event.xbutton.y});
+            } else if (event.type == KeyPress) {
+                char chars[8];
+                int n = XLookupString(&event.xkey, chars, sizeof(chars), nullptr, nullptr);
+                if (n == 1 && (unsigned char)chars[0] < 128) {
+                    mPendingEvents.push_back(
+                        Event {EVENT_TYPE_WIN_KEY, (void*)(size_t)chars[0], nullptr});
+                }
             }
         }
     }
@@ -253,6 +745,53 @@ void MainThreadImpl::pollEvent(chrono::milliseconds timeout) {
     }
 }
 
+bool MainThreadImpl::queryNetWmHidden() {
+    Atom type = None;
+    int format = 0;
+    unsigned long n = 0;
+    unsigned long remain = 0;
+    unsigned char* data = nullptr;
+    int r = XGetWindowProperty(
+        mDisplay.get(),
+        mWin->id(),
+        m_NET_WM_STATE,
+        0,
+        1024,
+        False,
+        XA_ATOM,
+        &type,
+        &format,
+        &n,
+        &remain,
+        &data);
+    bool hidden = false;
+    if (r == Success && type == XA_ATOM && format == 32) {
+        const Atom* atoms = (const Atom*)data;
+        for (unsigned long i = 0; i < n; ++i) {
+            if (atoms[i] == m_NET_WM_STATE_HIDDEN) {
+                hidden = true;
+                break;
+            }
+        }
+    }
+    if (data) {
+        XFree(data);
+    }
+    return hidden;
+}
+
+void MainThreadImpl::updateVisibility() {
+    // unmap: iconified(most wm) or workspace switch, hidden: minimized(ewmh), obscured: covered
+    // by other windows(no compositor).
+    bool visible = mWinMapped && !mWinNetHidden && !mWinObscured;
+    if (visible == mWinVisible) {
+        return;
+    }
+    mWinVisible = visible;
+    mPendingEvents.push_back(
+        Event {EVENT_TYPE_WIN_VISIBILITY, (void*)(size_t)(visible ? 1 : 0), nullptr});
+}
+
 std::optional<MainThreadImpl::Event> MainThreadImpl::peekEvent() {
     if (mPendingEvents.empty()) {
         return std::nullopt;
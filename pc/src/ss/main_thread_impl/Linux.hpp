@@ -10,6 +10,12 @@ protected:
     enum : EventType {
         EVENT_TYPE_WIN_RESIZE,
         EVENT_TYPE_WIN_CLOSE,
+        /** data0: 1 visible, 0 hidden(minimized or fully obscured). */
+        EVENT_TYPE_WIN_VISIBILITY,
+        /** left button press, data0: x, data1: y, window coordinate(top-left origin). */
+        EVENT_TYPE_WIN_CLICK,
+        /** character key press, data0: ascii character. */
+        EVENT_TYPE_WIN_KEY,
         _EVENT_TYPE_APP,
     };
 
@@ -30,12 +36,25 @@ protected:
 
     void swapBuffers();
 
+    /** software render(no gl), window presented by MIT-SHM image. */
+    bool isSoftware() const {
+        return mSoftware;
+    }
+
+    /** software only, return bgra image data of w x h for this frame, present by `swapBuffers`. */
+    uint8_t* obtainSwImage(int w, int h, int* stride);
+
     void postEvent(const Event& e);
 
     void pollEvent(chrono::milliseconds timeout);
 
     std::optional<Event> peekEvent();
 
+    /** extra fd wait by `pollEvent`, only use for wakeup, -1 to disable. */
+    void setExtraPollFd(int fd) {
+        mExtraPollFd = fd;
+    }
+
     // ----
 
     bool wakeup() {
@@ -134,16 +153,73 @@ protected:
         Window mId;
     };
 
+    /** headless egl objects(EGLDisplay/EGLSurface/EGLContext), release created part. */
+    struct RaiiEgl : xm::NonCopyable {
+        ~RaiiEgl();
+
+        void* lib = nullptr;
+        void* display = nullptr;
+        void* surface = nullptr;
+        void* ctx = nullptr;
+    };
+
+    /** bgra XImage, in shared memory if MIT-SHM available. */
+    struct RaiiSwImage : xm::NonCopyable {
+        RaiiSwImage(Display* display, XVisualInfo* visualInfo, int w, int h, bool tryShm);
+
+        ~RaiiSwImage();
+
+        Display* display;
+        XImage* image = nullptr;
+        XShmSegmentInfo shm = {};
+        bool shared = false;
+    };
+
+    /** create window of visual and map it, no show. */
+    void createWindow();
+
+    /** maximize window. */
+    void showWindow();
+
+    void initGlx();
+
+    /** no gl, use default visual and present by XShmPutImage. */
+    void initSoftware();
+
+    /** read _NET_WM_STATE, return whether contain _NET_WM_STATE_HIDDEN. */
+    bool queryNetWmHidden();
+
+    /** post visibility event if changed. */
+    void updateVisibility();
+
+    /** create opengl 3.3 core context match window visual, return nullptr if fail. */
+    std::unique_ptr<RaiiContext> tryCreateCoreContext();
+
+    /** headless, create egl pbuffer and gl context instead of window. */
+    void initHeadlessEgl();
+
     Atom m_WM_DELETE_WINDOW = {};
     Atom m_NET_WM_STATE = {};
     Atom m_NET_WM_STATE_MAXIMIZED_HORZ = {};
     Atom m_NET_WM_STATE_MAXIMIZED_VERT = {};
+    Atom m_NET_WM_STATE_HIDDEN = {};
     Atom m_NET_WM_NAME = {};
     Atom m_NET_WM_ICON_NAME = {};
     Atom m_UTF8_STRING = {};
 
+    int mExtraPollFd = -1;
+    /** no x display, window and glx(render to egl pbuffer or cpu). */
+    bool mHeadless = false;
+    /** software render, by config or gl not available. */
+    bool mSoftware = false;
+    bool mShmAvailable = false;
     int mDefaultScreen = 0;
     Window mRootWindow = 0;
+    /** window visibility sources, see `updateVisibility`. */
+    bool mWinMapped = true;
+    bool mWinObscured = false;
+    bool mWinNetHidden = false;
+    bool mWinVisible = true;
     std::optional<RaiiFd> mEventFd;
     std::optional<RaiiGlxLoader> mGlxLoader; // long life than Display, otherwise crash.
     std::unique_ptr<Display, DisplayDeleter> mDisplay;
@@ -151,6 +227,10 @@ protected:
     std::optional<RaiiColormap> mColormap;
     std::optional<RaiiWindow> mWin;
     std::unique_ptr<RaiiContext> mCtx;
+    std::optional<RaiiEgl> mEgl;
+    std::optional<RaiiSwImage> mSwImage;
+    /** headless software, image data. */
+    xm::Array<uint8_t> mSwBuffer;
 
     std::mutex mCacheEventLock;
     xm::Array<Event> mCacheEvents;  // guard by mCacheEventLock.
@@ -10,6 +10,12 @@ public:
     enum : EventType {
         EVENT_TYPE_WIN_RESIZE,
         EVENT_TYPE_WIN_CLOSE,
+        /** data0: 1 visible, 0 hidden(minimized or fully occluded). */
+        EVENT_TYPE_WIN_VISIBILITY,
+        /** left button press, data0: x, data1: y, window coordinate(top-left origin). */
+        EVENT_TYPE_WIN_CLICK,
+        /** character key press, data0: ascii character. */
+        EVENT_TYPE_WIN_KEY,
         _EVENT_TYPE_APP,
     };
 
@@ -2,6 +2,10 @@
 
 #import <Cocoa/Cocoa.h>
 
+#include <dlfcn.h>
+
+#include <ss/GlExt.hpp>
+
 //////////////////////////////
 
 using namespace ss::detail;
@@ -25,6 +29,13 @@ static std::deque<MainThreadImpl::Event>* sPendingEvents = nullptr;
         (void*)(size_t)size.width,
         (void*)(size_t)size.height});
 }
+
+- (void)windowDidChangeOcclusionState:(NSNotification*)notification {
+    NSWindow* win = notification.object;
+    bool visible = (win.occlusionState & NSWindowOcclusionStateVisible) != 0;
+    sPendingEvents->push_back(MainThreadImpl::Event {
+        MainThreadImpl::EVENT_TYPE_WIN_VISIBILITY, (void*)(size_t)(visible ? 1 : 0), nullptr});
+}
 @end
 
 //////////////////////////////
@@ -45,17 +56,32 @@ static std::deque<MainThreadImpl::Event>* sPendingEvents = nullptr;
             NSOpenGLPFASamples, 0,
             NSOpenGLPFAColorSize, 24,
             NSOpenGLPFAAlphaSize, 8,
+            // prefer core profile(3.2 or above), then GlRender use vao/vbo.
+            NSOpenGLPFAOpenGLProfile, NSOpenGLProfileVersion3_2Core,
             0,
         };
         // clang-format on
-        NSOpenGLPixelFormat* pf = [NSOpenGLPixelFormat alloc];
-        [pf initWithAttributes:attris];
+        NSOpenGLPixelFormat* pf = nil;
+        if (!ss::Config::Singleton()->glLegacy) {
+            pf = [[NSOpenGLPixelFormat alloc] initWithAttributes:attris];
+            if (!pf) {
+                ss::Log::W("create opengl core profile pixel format fail");
+            }
+        }
+        if (!pf) {
+            // legacy profile, cut profile attributes.
+            attris[sizeof(attris) / sizeof(attris[0]) - 3] = 0;
+            pf = [[NSOpenGLPixelFormat alloc] initWithAttributes:attris];
+        }
         [pf autorelease];
         self = [super initWithFrame:frameRect pixelFormat:pf];
         [self.openGLContext makeCurrentContext];
         GLint swapInt = 0;  // off vsync.
         [self.openGLContext setValues:&swapInt forParameter:NSOpenGLCPSwapInterval];
         gladLoaderLoadGL();
+        ss::GlExt::Load([](const char* name) -> GLADapiproc {
+            return (GLADapiproc)dlsym(RTLD_DEFAULT, name);
+        });
     }
     return self;
 }
@@ -64,6 +90,28 @@ static std::deque<MainThreadImpl::Event>* sPendingEvents = nullptr;
     gladLoaderUnloadGL();
     [super dealloc];
 }
+
+- (void)mouseDown:(NSEvent*)event {
+    NSPoint p = [self convertPoint:event.locationInWindow fromView:nil];
+    // view origin at bottom-left.
+    sPendingEvents->push_back(MainThreadImpl::Event {
+        MainThreadImpl::EVENT_TYPE_WIN_CLICK,
+        (void*)(size_t)p.x,
+        (void*)(size_t)(self.frame.size.height - p.y)});
+}
+
+- (BOOL)acceptsFirstResponder {
+    return YES;
+}
+
+- (void)keyDown:(NSEvent*)event {
+    NSString* chars = event.charactersIgnoringModifiers;
+    unichar c = chars.length == 1 ? [chars characterAtIndex:0] : 0;
+    if (c > 0 && c < 128) {
+        sPendingEvents->push_back(
+            MainThreadImpl::Event {MainThreadImpl::EVENT_TYPE_WIN_KEY, (void*)(size_t)c, nullptr});
+    }
+}
 @end
 
 /////////////////////////////
@@ -110,6 +158,8 @@ static std::deque<MainThreadImpl::Event>* sPendingEvents = nullptr;
         [myView autorelease];
         MyWindowDelegate* myDelegate = [MyWindowDelegate new];
         mWindow.contentView = myView;
+        // receive key down.
+        [mWindow makeFirstResponder:myView];
         mWindow.delegate = myDelegate;
         mWindow.releasedWhenClosed = NO;
         [mWindow makeKeyAndOrderFront:nil];
@@ -2,13 +2,28 @@
 
 #include <ss/_resource.h>
 
+#include <windowsx.h>
+
 #define GLAD_WGL_IMPLEMENTATION
 #include <glad/wgl.h>
 
+#include <ss/GlExt.hpp>
+
+// 'WGL_ARB_create_context_profile', not generate in glad.
+#ifndef WGL_CONTEXT_PROFILE_MASK_ARB
+    #define WGL_CONTEXT_PROFILE_MASK_ARB 0x9126
+#endif
+#ifndef WGL_CONTEXT_CORE_PROFILE_BIT_ARB
+    #define WGL_CONTEXT_CORE_PROFILE_BIT_ARB 0x00000001
+#endif
+
 #if defined(XM_OS_WINDOWS)
 namespace ss::detail {
 MainThreadImpl::MainThreadImpl() {
     mThreadId = ::GetCurrentThreadId();
+    // create message queue now, other threads may post before window created.
+    MSG msg;
+    ::PeekMessage(&msg, NULL, WM_USER, WM_USER, PM_NOREMOVE);
 }
 
 std::string MainThreadImpl::queryUserLanguageName() {
@@ -96,7 +111,28 @@ void MainThreadImpl::initWindowAndGl() {
     int tmpGlMinor = 0;
     (void)::sscanf(tmpGlVersion, "%d.%d", &tmpGlMajor, &tmpGlMinor);
     // tmpGlMajor = 1;
-    if (tmpGlMajor > 2 || (tmpGlMajor == 2 && tmpGlMinor >= 1)) {
+    // prefer 3.3 core context, then GlRender use vao/vbo and immutable texture.
+    if (!Config::Singleton()->glLegacy && GLAD_WGL_ARB_create_context) {
+        static constexpr int coreContextAttribs[] = {
+            WGL_CONTEXT_MAJOR_VERSION_ARB,
+            3,
+            WGL_CONTEXT_MINOR_VERSION_ARB,
+            3,
+            WGL_CONTEXT_PROFILE_MASK_ARB,
+            WGL_CONTEXT_CORE_PROFILE_BIT_ARB,
+            0,
+        };
+        HGLRC _coreHglRc = wglCreateContextAttribsARB(mHdc->handle(), 0, coreContextAttribs);
+        if (_coreHglRc) {
+            mHglrc = std::make_unique<Raii_HGLRC>(_coreHglRc);
+            Log::I("use opengl 3.3 core context");
+        } else {
+            Log::W("create opengl 3.3 core context fail, error: %lu", ::GetLastError());
+        }
+    }
+    if (mHglrc) {
+        // core context created.
+    } else if (tmpGlMajor > 2 || (tmpGlMajor == 2 && tmpGlMinor >= 1)) {
         mHglrc = std::move(tmpHglRc);
     } else {
         SS_THROW(GLAD_WGL_ARB_create_context, "miss 'WGL_ARB_create_context'");
@@ -118,7 +154,19 @@ void MainThreadImpl::initWindowAndGl() {
 
     tmpHglRc = nullptr;
     check_lasterror(wglMakeCurrent(mHdc->handle(), mHglrc->handle()), "wglMakeCurrent");
+    // wgl entry points belong to context, reload for final context.
+    GLADloadfunc load = [](const char* name) -> GLADapiproc {
+        GLADapiproc p = (GLADapiproc)wglGetProcAddress(name);
+        // gl 1.1 entry points only export by opengl32.dll.
+        if (!p) {
+            static HMODULE opengl32 = ::GetModuleHandleA("opengl32.dll");
+            p = (GLADapiproc)::GetProcAddress(opengl32, name);
+        }
+        return p;
+    };
+    gladLoadGL(load);
     Log::I("opengl version: %s", (const char*)glGetString(GL_VERSION));
+    GlExt::Load(load);
 
     // try to disable vsync.
     if (GLAD_WGL_EXT_swap_control) {
@@ -185,6 +233,22 @@ LRESULT MainThreadImpl::onWinProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lPa
                 EVENT_TYPE_WIN_RESIZE,
                 (void*)(size_t)LOWORD(lParam),
                 (void*)(size_t)HIWORD(lParam)});
+            mPendingEvents.push_back(Event {
+                EVENT_TYPE_WIN_VISIBILITY,
+                (void*)(size_t)(wParam == SIZE_MINIMIZED ? 0 : 1),
+                nullptr});
+            break;
+        case WM_LBUTTONDOWN:
+            mPendingEvents.push_back(Event {
+                EVENT_TYPE_WIN_CLICK,
+                (void*)(size_t)GET_X_LPARAM(lParam),
+                (void*)(size_t)GET_Y_LPARAM(lParam)});
+            break;
+        case WM_CHAR:
+            if (wParam < 128) {
+                mPendingEvents.push_back(
+                    Event {EVENT_TYPE_WIN_KEY, (void*)(size_t)wParam, nullptr});
+            }
             break;
         default:
             r = ::DefWindowProcA(hwnd, msg, wParam, lParam);
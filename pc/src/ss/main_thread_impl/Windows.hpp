@@ -10,6 +10,12 @@ protected:
     enum : EventType {
         EVENT_TYPE_WIN_RESIZE = WM_SIZE,
         EVENT_TYPE_WIN_CLOSE = WM_CLOSE,
+        /** data0: 1 visible, 0 hidden(minimized). */
+        EVENT_TYPE_WIN_VISIBILITY = WM_SHOWWINDOW,
+        /** left button press, data0: x, data1: y, client coordinate. */
+        EVENT_TYPE_WIN_CLICK = WM_LBUTTONDOWN,
+        /** character key press, data0: ascii character. */
+        EVENT_TYPE_WIN_KEY = WM_CHAR,
         _EVENT_TYPE_APP = WM_APP,
     };
 
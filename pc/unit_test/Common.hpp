@@ -8,6 +8,7 @@
 #define E_LT EXPECT_LT
 #define E_GE EXPECT_GE
 #define E_GT EXPECT_GT
+#define E_NEAR EXPECT_NEAR
 #define E_THAT EXPECT_THAT
 #define E_FALSE EXPECT_FALSE
 #define E_TRUE EXPECT_TRUE
@@ -0,0 +1,88 @@
+#include <ss/DirtyTiles.hpp>
+
+#include "Common.hpp"
+
+#include <vector>
+
+namespace {
+struct Plane {
+    Plane(uint32_t w, uint32_t h, uint32_t linesize) : w(w), h(h), linesize(linesize) {
+        data.resize((size_t)linesize * h);
+        FOR_I((int)data.size()) {
+            data[i] = (uint8_t)(i * 31 + (i >> 7));
+        }
+    }
+
+    uint32_t w;
+    uint32_t h;
+    uint32_t linesize;
+    std::vector<uint8_t> data;
+};
+}  // namespace
+
+TEST(TileHashTest, same_as_scalar) {
+    Plane p(200, 70, 208);
+    // cover full 16 bytes chunks and tail bytes.
+    for (size_t wb : {1, 15, 16, 17, 64, 100, 200}) {
+        for (size_t h : {1, 7, 64, 70}) {
+            E_EQ(
+                ss::TileHash::Hash(p.data.data(), p.linesize, wb, h),
+                ss::TileHash::HashScalar(p.data.data(), p.linesize, wb, h));
+        }
+    }
+}
+
+TEST(TileHashTest, detect_change) {
+    Plane p(64, 64, 64);
+    uint64_t h0 = ss::TileHash::Hash(p.data.data(), p.linesize, 64, 64);
+    FOR_I(64) {
+        FOR_J(64) {
+            size_t idx = (size_t)i * p.linesize + j;
+            p.data[idx] ^= 1;
+            E_NE(ss::TileHash::Hash(p.data.data(), p.linesize, 64, 64), h0);
+            p.data[idx] ^= 1;
+        }
+    }
+    E_EQ(ss::TileHash::Hash(p.data.data(), p.linesize, 64, 64), h0);
+
+    // swap two rows must change hash.
+    std::swap_ranges(p.data.begin(), p.data.begin() + 64, p.data.begin() + 64);
+    E_NE(ss::TileHash::Hash(p.data.data(), p.linesize, 64, 64), h0);
+}
+
+TEST(DirtyTilesTest, update) {
+    Plane p(200, 130, 224);
+    ss::DirtyTiles tiles;
+
+    // first update, all dirty.
+    E_EQ(tiles.update(p.data.data(), p.linesize, p.w, p.h, 1), 4u * 3u);
+    E_EQ(tiles.cols(), 4u);
+    E_EQ(tiles.rows(), 3u);
+
+    // no change.
+    E_EQ(tiles.update(p.data.data(), p.linesize, p.w, p.h, 1), 0u);
+
+    // change pixel (199, 129), only last tile dirty.
+    p.data[129 * p.linesize + 199] += 1;
+    E_EQ(tiles.update(p.data.data(), p.linesize, p.w, p.h, 1), 1u);
+    FOR_I(3) {
+        FOR_J(4) {
+            E_EQ(tiles.dirty(j, i), i == 2 && j == 3);
+        }
+    }
+
+    // bytes out of width(linesize padding) not affect.
+    p.data[10 * p.linesize + 210] += 1;
+    E_EQ(tiles.update(p.data.data(), p.linesize, p.w, p.h, 1), 0u);
+
+    // reset, all dirty again.
+    tiles.reset();
+    E_EQ(tiles.update(p.data.data(), p.linesize, p.w, p.h, 1), 4u * 3u);
+
+    // 2 bytes per pixel, tile is 128 bytes wide.
+    ss::DirtyTiles tiles2;
+    E_EQ(tiles2.update(p.data.data(), p.linesize, 100, 130, 2), 2u * 3u);
+    p.data[64 * p.linesize + 130] += 1;
+    E_EQ(tiles2.update(p.data.data(), p.linesize, 100, 130, 2), 1u);
+    E_TRUE(tiles2.dirty(1, 1));
+}
@@ -0,0 +1,52 @@
+#include <ss/LatencyHistogram.hpp>
+
+#include "Common.hpp"
+
+TEST(LatencyHistogramTest, bucket_bounds) {
+    using H = ss::LatencyHistogram;
+    for (uint64_t v : {0ull, 1ull, 63ull, 64ull, 65ull, 127ull, 128ull, 1000ull, 123456789ull}) {
+        int b = H::BucketOf(v);
+        E_LE(H::LowestOf(b), v);
+        E_GT(H::LowestOf(b + 1), v);
+    }
+    E_EQ(H::BucketOf((1ull << H::VALUE_BITS) - 1), H::BUCKET_COUNT - 1);
+}
+
+TEST(LatencyHistogramTest, percentile) {
+    ss::LatencyHistogram h;
+    E_EQ(h.percentile(50), 0u);
+    for (uint64_t v = 1; v <= 10000; ++v) {
+        h.add(v);
+    }
+    E_EQ(h.count(), 10000u);
+    E_EQ(h.max(), 10000u);
+    E_EQ(h.percentile(100), 10000u);
+    // relative error < 2 / SUB_COUNT.
+    E_NEAR(h.percentile(50), 5000, 5000 * 2.0 / ss::LatencyHistogram::SUB_COUNT);
+    E_NEAR(h.percentile(99), 9900, 9900 * 2.0 / ss::LatencyHistogram::SUB_COUNT);
+
+    // small values exact.
+    ss::LatencyHistogram small;
+    small.add(std::chrono::microseconds(10));
+    small.add(std::chrono::microseconds(20));
+    E_EQ(small.percentile(50), 10u);
+    E_EQ(small.percentile(95), 20u);
+}
+
+TEST(LatencyHistogramTest, merge_and_reset) {
+    ss::LatencyHistogram a;
+    ss::LatencyHistogram b;
+    a.add(uint64_t(5));
+    b.add(uint64_t(50000));
+    a.merge(b);
+    E_EQ(a.count(), 2u);
+    E_EQ(a.max(), 50000u);
+    E_EQ(a.percentile(0), 5u);
+
+    a.reset();
+    E_EQ(a.count(), 0u);
+    E_EQ(a.max(), 0u);
+    // negative duration clamp to 0.
+    a.add(std::chrono::microseconds(-3));
+    E_EQ(a.percentile(50), 0u);
+}
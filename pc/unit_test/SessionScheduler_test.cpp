@@ -0,0 +1,140 @@
+#include <ss/SessionScheduler.hpp>
+
+#include "Common.hpp"
+
+#include <vector>
+
+namespace {
+/** per session fifo of work items, like decode thread's pending frames. */
+struct Work {
+    std::mutex lock;
+    std::deque<int> items[8];
+    std::vector<int> done[8];
+    std::atomic<int> doneCount = 0;
+
+    void push(int session, int item) {
+        std::lock_guard<std::mutex> l(lock);
+        items[session].push_back(item);
+    }
+
+    bool pop(int session, int* item) {
+        std::lock_guard<std::mutex> l(lock);
+        if (items[session].empty()) {
+            return false;
+        }
+        *item = items[session].front();
+        items[session].pop_front();
+        return true;
+    }
+
+    void waitDone(int count) {
+        while (doneCount < count) {
+            std::this_thread::yield();
+        }
+    }
+};
+}  // namespace
+
+TEST(SessionSchedulerTest, keep_session_order) {
+    Work work;
+    ss::SessionScheduler scheduler(8, 3, [&](int session, int worker) {
+        int item = 0;
+        if (!work.pop(session, &item)) {
+            return false;
+        }
+        // only one worker run session at a time, no lock needed.
+        work.done[session].push_back(item);
+        ++work.doneCount;
+        return true;
+    });
+
+    FOR_I(200) {
+        FOR_J(8) {
+            work.push(j, i);
+            scheduler.notifyRunnable(j);
+        }
+    }
+    work.waitDone(8 * 200);
+    scheduler.stop();
+    scheduler.join();
+
+    FOR_J(8) {
+        ASSERT_EQ(work.done[j].size(), 200u);
+        FOR_I(200) {
+            E_EQ(work.done[j][i], i);
+        }
+    }
+}
+
+TEST(SessionSchedulerTest, steal_session_of_busy_worker) {
+    std::atomic<bool> release = false;
+    std::atomic<int> session0Worker = -1;
+    std::atomic<int> session2Worker = -1;
+    // session 0 and 2 both home on worker 0.
+    ss::SessionScheduler scheduler(3, 2, [&](int session, int worker) {
+        if (session == 0) {
+            session0Worker = worker;
+            while (!release) {
+                std::this_thread::yield();
+            }
+        } else {
+            session2Worker = worker;
+            release = true;
+        }
+        return false;
+    });
+
+    scheduler.notifyRunnable(0);
+    while (session0Worker < 0) {
+        std::this_thread::yield();
+    }
+    scheduler.notifyRunnable(2);
+    while (!release) {
+        std::this_thread::yield();
+    }
+    scheduler.stop();
+    scheduler.join();
+
+    // worker run session 0 blocked until session 2 run, so other worker must run it.
+    E_NE(session2Worker, session0Worker);
+    if (session0Worker == 0) {
+        E_EQ(scheduler.workerStats(1).steals, 1u);
+    }
+}
+
+TEST(SessionSchedulerTest, priority_first) {
+    std::atomic<bool> release = false;
+    std::mutex lock;
+    std::vector<int> order;
+    // one worker, session 0 block it while others queue.
+    ss::SessionScheduler scheduler(4, 1, [&](int session, int worker) {
+        if (session == 0) {
+            while (!release) {
+                std::this_thread::yield();
+            }
+        }
+        std::lock_guard<std::mutex> l(lock);
+        order.push_back(session);
+        return false;
+    });
+
+    scheduler.setPriority(2, 1);
+    scheduler.notifyRunnable(0);
+    while (scheduler.workerStats(0).slices == 0) {
+        std::this_thread::yield();
+    }
+    scheduler.notifyRunnable(1);
+    scheduler.notifyRunnable(3);
+    scheduler.notifyRunnable(2);
+    release = true;
+    while (true) {
+        std::lock_guard<std::mutex> l(lock);
+        if (order.size() == 4) {
+            break;
+        }
+    }
+    scheduler.stop();
+    scheduler.join();
+
+    E_THAT(order, testing::ElementsAre(0, 2, 1, 3));
+}
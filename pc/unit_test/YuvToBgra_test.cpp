@@ -0,0 +1,103 @@
+#include <ss/YuvToBgra.hpp>
+
+#include "Common.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace {
+struct Row {
+    explicit Row(int w) : w(w), y(w), u((w + 1) / 2), v((w + 1) / 2) {
+        FOR_I(w) {
+            y[i] = (uint8_t)(i * 37 + 11);
+        }
+        FOR_I((w + 1) / 2) {
+            u[i] = (uint8_t)(i * 53 + 7);
+            v[i] = (uint8_t)(255 - i * 29);
+        }
+    }
+
+    std::vector<uint32_t> convert(const ss::YuvToBgra::Coeffs& c, ss::YuvToBgra::Kernel kernel) {
+        std::vector<uint32_t> dst(w);
+        int x = kernel(c, y.data(), u.data(), v.data(), dst.data(), 0, w);
+        ss::YuvToBgra::ConvertScalar(c, y.data(), u.data(), v.data(), dst.data(), x, w);
+        return dst;
+    }
+
+    int w;
+    std::vector<uint8_t> y;
+    std::vector<uint8_t> u;
+    std::vector<uint8_t> v;
+};
+
+std::vector<ss::YuvToBgra::Coeffs> all_coeffs() {
+    return {
+        ss::YuvToBgra::MakeCoeffs(0.299f, 0.114f, false),
+        ss::YuvToBgra::MakeCoeffs(0.299f, 0.114f, true),
+        ss::YuvToBgra::MakeCoeffs(0.2126f, 0.0722f, false),
+        ss::YuvToBgra::MakeCoeffs(0.2627f, 0.0593f, false),
+    };
+}
+}  // namespace
+
+TEST(YuvToBgraTest, scalar_accuracy) {
+    ss::YuvToBgra::Coeffs c = ss::YuvToBgra::MakeCoeffs(0.299f, 0.114f, false);
+    uint32_t px = 0;
+
+    // limited range black/white/gray.
+    uint8_t y = 16, u = 128, v = 128;
+    ss::YuvToBgra::ConvertScalar(c, &y, &u, &v, &px, 0, 1);
+    E_EQ(px, 0xff000000u);
+    y = 235;
+    ss::YuvToBgra::ConvertScalar(c, &y, &u, &v, &px, 0, 1);
+    E_EQ(px, 0xffffffffu);
+
+    // compare with float formula, error at most 1.
+    for (int yi = 0; yi < 256; yi += 5) {
+        for (int ci = 0; ci < 256; ci += 15) {
+            y = (uint8_t)yi;
+            u = (uint8_t)ci;
+            v = (uint8_t)(255 - ci);
+            ss::YuvToBgra::ConvertScalar(c, &y, &u, &v, &px, 0, 1);
+            float yf = (yi - 16) * 255.0f / 219.0f;
+            float uf = (u - 128) * 255.0f / 224.0f;
+            float vf = (v - 128) * 255.0f / 224.0f;
+            float expects[3] = {
+                yf + 1.772f * uf,
+                yf - 0.344136f * uf - 0.714136f * vf,
+                yf + 1.402f * vf,
+            };
+            FOR_I(3) {
+                float e = std::min(255.0f, std::max(0.0f, expects[i]));
+                E_LE(std::abs((float)((px >> (i * 8)) & 0xff) - e), 1.0f);
+            }
+        }
+    }
+}
+
+TEST(YuvToBgraTest, simd_same_as_scalar) {
+    std::vector<std::pair<const char*, ss::YuvToBgra::Kernel>> kernels;
+#if defined(SS_YUV_X86)
+    if (ss::YuvToBgra::HasSse41()) {
+        kernels.push_back({"sse4.1", &ss::YuvToBgra::ConvertSse41});
+    }
+    if (ss::YuvToBgra::HasAvx2()) {
+        kernels.push_back({"avx2", &ss::YuvToBgra::ConvertAvx2});
+    }
+#elif defined(SS_YUV_NEON)
+    kernels.push_back({"neon", &ss::YuvToBgra::ConvertNeon});
+#endif
+
+    for (const ss::YuvToBgra::Coeffs& c : all_coeffs()) {
+        // cover full steps and tail pixels, odd width.
+        for (int w : {1, 15, 16, 17, 31, 32, 33, 64, 101, 1920}) {
+            Row row(w);
+            std::vector<uint32_t> expect = row.convert(c, &ss::YuvToBgra::ConvertScalar);
+            for (auto& k : kernels) {
+                std::vector<uint32_t> dst = row.convert(c, k.second);
+                E_TRUE(dst == expect) << k.first << ", w: " << w;
+            }
+        }
+    }
+}